@@ -8,7 +8,7 @@ set CommonIncludeDir=C:\dev\shared\include
 set BuildDir=%CurrProjDir%\build
 set SourceDir=%CurrProjDir%\source
 
-set CompilerOptions=/I%CommonIncludeDir% /MTd /nologo /FC /GR- /Z7 /EHa- /Od /Oi
+set CompilerOptions=/I%CommonIncludeDir% /MTd /nologo /FC /GR- /Z7 /EHa- /Od /Oi /DOPUSONE_INTERNAL=1
 set CompilerWarningOptions=/WX /W4 /wd4201 /wd4100 /wd4189 /wd4505
 set LinkOptions=/LIBPATH:%CommonLibDir% /INCREMENTAL:NO /OPT:REF /SUBSYSTEM:CONSOLE
 set LinkLibs=SDL2main.lib SDL2.lib SDL2_image.lib SDL2_ttf.lib glad.lib opengl32.lib shell32.lib assimp-vc143-mtd.lib
@@ -16,6 +16,12 @@ set LinkLibs=SDL2main.lib SDL2.lib SDL2_image.lib SDL2_ttf.lib glad.lib opengl32
 pushd %BuildDir%
 
 cl %SourceDir%\sdl_opusone.cpp %SourceDir%\opusone.cpp %CompilerOptions% %CompilerWarningOptions% /link %LinkOptions% %LinkLibs%
+cl %SourceDir%\opusone_cooker.cpp %CompilerOptions% %CompilerWarningOptions% /link %LinkOptions% %LinkLibs%
+
+REM NOTE: Cooked models and textures aren't checked in, see build.sh
+pushd %CurrProjDir%
+for /d %%D in (resources\models\*) do for %%F in (%%D\*.gltf) do %BuildDir%\opusone_cooker.exe %%F
+popd
 
 popd
 
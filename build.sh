@@ -0,0 +1,52 @@
+#!/bin/sh
+# NOTE: Linux build, the counterpart of build.bat. Builds the SDL platform layer, the headless benchmark
+# (headless_opusone.cpp, which also needs EGL) and the model cooker (opusone_cooker.cpp), then cooks the models
+# with it. Libraries come from the system, plus glad and anything else that isn't packaged from CommonDir, same
+# as C:\dev\shared on Windows.
+
+set -e
+
+CurrProjDir=${CurrProjDir:-$(cd "$(dirname "$0")" && pwd)}
+CommonDir=${CommonDir:-$HOME/dev/shared}
+
+BuildDir=$CurrProjDir/build
+SourceDir=$CurrProjDir/source
+
+CompilerOptions="-I$CommonDir/include -std=c++17 -g -O2 -fno-exceptions -fno-rtti -pthread -DOPUSONE_INTERNAL=1"
+CompilerWarningOptions="-Wall -Werror -Wno-unused-variable -Wno-unused-but-set-variable -Wno-unused-function -Wno-missing-braces"
+LinkOptions="-L$CommonDir/lib"
+LinkLibs="-lSDL2 -lSDL2_image -lSDL2_ttf -lglad -lassimp -ldl"
+
+mkdir -p "$BuildDir"
+cd "$BuildDir"
+
+# NOTE: "./build.sh hot" builds sdl_opusone_hot, which loads the game from opusone_game.so and reloads it when it
+# changes (OPUSONE_HOT_RELOAD, see opusone_platform_module.cpp). "./build.sh game" then only rebuilds the module.
+# The executable exports the platform functions to it (-rdynamic), -Bsymbolic keeps the module's own copies of
+# inline functions and glad (which has to be built with -fPIC for this) from binding to the executable's.
+# The module is written under a temporary name and renamed, so the running game never sees it half-written.
+BuildGameModule()
+{
+    c++ "$SourceDir/opusone.cpp" $CompilerOptions $CompilerWarningOptions -fPIC -shared -Wl,-Bsymbolic $LinkOptions -lglad -lassimp -o opusone_game.so.tmp
+    mv opusone_game.so.tmp opusone_game.so
+}
+
+case "$1" in
+    hot)
+        BuildGameModule
+        c++ "$SourceDir/sdl_opusone.cpp" $CompilerOptions $CompilerWarningOptions -DOPUSONE_HOT_RELOAD=1 -rdynamic $LinkOptions $LinkLibs -o sdl_opusone_hot
+        ;;
+    game)
+        BuildGameModule
+        ;;
+    *)
+        c++ "$SourceDir/sdl_opusone.cpp" "$SourceDir/opusone.cpp" $CompilerOptions $CompilerWarningOptions $LinkOptions $LinkLibs -o sdl_opusone
+        c++ "$SourceDir/headless_opusone.cpp" "$SourceDir/opusone.cpp" $CompilerOptions $CompilerWarningOptions $LinkOptions $LinkLibs -lEGL -o headless_opusone
+        c++ "$SourceDir/opusone_cooker.cpp" $CompilerOptions $CompilerWarningOptions $LinkOptions $LinkLibs -o opusone_cooker
+        # NOTE: Cooked models and textures aren't checked in, this is what makes them. Up to date ones are skipped.
+        # Texture paths are stored relative to the project, so it runs from there. A model that fails to cook doesn't
+        # fail the build, the cooker says which one and the game imports it at runtime.
+        (cd "$CurrProjDir" && "$BuildDir/opusone_cooker" resources/models/*/*.gltf) ||
+            echo "build.sh: Some assets didn't cook, see the COOKER: lines above"
+        ;;
+esac
@@ -17,8 +17,9 @@ void main()
 {
     vec3 Normal = vec3(0, 0, 1);
 #if 0
-    vec3 NormalTexel = texture(NormalMap, VS_UV).rgb;
-    Normal = Normalize(NormalTexel * 2.0 - 1.0);
+    // NOTE: Cooked normal maps are BC5, X and Y only. Z is rebuilt from those, which works for RGB ones too.
+    vec2 NormalXY = texture(NormalMap, VS_UV).rg * 2.0 - 1.0;
+    Normal = vec3(NormalXY, sqrt(max(1.0 - dot(NormalXY, NormalXY), 0.0)));
 #endif
 
     vec3 DiffuseTexel = texture(DiffuseMap, VS_UV).rgb;
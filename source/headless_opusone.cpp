@@ -0,0 +1,594 @@
+// NOTE: Headless Linux platform layer for benchmarking. Renders offscreen through EGL (surfaceless Mesa, so
+// llvmpipe works on a box without a GPU or a display), feeds the game scripted input with a fixed DeltaTime,
+// runs a fixed number of frames and prints frame time statistics.
+//
+// Usage: headless_opusone [-frames N] [-width W] [-height H] [-dt Seconds] [-script Path] [-csv Path]
+//                          [-record Path | -playback Path] [-software] [-hugepages]
+//
+// -csv writes the per-stage timings of the last FRAME_STATS_COUNT frames (see opusone_frame_stats.h).
+// -record saves the input (scripted or not) as a replay, -playback feeds a replay recorded from launch instead of
+// the script, with the recorded DeltaTime and frame times, and runs until it ends unless -frames is given. That
+// makes two builds run the exact same workload (see opusone_platform_replay.cpp).
+//
+// Input script, one event per line ('#' starts a comment), frames count from 0:
+//   <Frame> down <KeyName>       e.g. "30 down W"
+//   <Frame> up <KeyName>         key names are SDL's (SDL_GetScancodeFromName)
+//   <Frame> mouse <DX> <DY>      relative mouse motion on that frame
+
+#include <cstdlib>
+#include <cstdio>
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <SDL2/SDL.h>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_platform_services.cpp"
+
+enum headless_input_event_type
+{
+    HeadlessInput_KeyDown,
+    HeadlessInput_KeyUp,
+    HeadlessInput_Mouse,
+};
+
+struct headless_input_event
+{
+    u32 Frame;
+    headless_input_event_type Type;
+    SDL_Scancode Scancode;
+    i32 MouseDeltaX;
+    i32 MouseDeltaY;
+};
+
+struct headless_input_script
+{
+    headless_input_event *Events;
+    u32 EventCount;
+    u32 NextEvent;
+};
+
+internal headless_input_script
+LoadInputScript(const char *Path);
+
+internal void
+UpdateScriptedInput(game_input *GameInput, headless_input_script *Script, u32 FrameIndex);
+
+internal b32
+CreateHeadlessGLContext();
+
+internal void
+CreateOffscreenFramebuffer(i32 Width, i32 Height);
+
+internal void
+PrintFrameStats(f32 *FrameTimesMs, u32 FrameCount, u32 LoadingFrameCount);
+
+internal void
+PrintUsage()
+{
+    printf("Usage: headless_opusone [-frames N] [-width W] [-height H] [-dt Seconds] [-script Path] [-csv Path]\n"
+           "                        [-record Path | -playback Path] [-software] [-hugepages]\n");
+}
+
+int
+main(int Argc, char *Argv[])
+{
+    u32 FrameCount = 600;
+    i32 ScreenWidth = 1920;
+    i32 ScreenHeight = 1080;
+    f32 DeltaTime = 1.0f / 60.0f;
+    const char *ScriptPath = 0;
+    const char *CSVPath = 0;
+    const char *RecordPath = 0;
+    const char *PlaybackPath = 0;
+    b32 HasFrameCount = false;
+
+    for (i32 ArgIndex = 1;
+         ArgIndex < Argc;
+         ++ArgIndex)
+    {
+        const char *Arg = Argv[ArgIndex];
+        b32 HasValue = (ArgIndex + 1) < Argc;
+
+        if (CompareStrings(Arg, "-hugepages"))
+        {
+            GlobalUseHugePages = true;
+        }
+        else if (CompareStrings(Arg, "-software"))
+        {
+            // NOTE: Forces Mesa's llvmpipe even if there's a GPU, for numbers that compare across machines
+            setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+        }
+        else if (CompareStrings(Arg, "-frames") && HasValue)
+        {
+            FrameCount = (u32) atoi(Argv[++ArgIndex]);
+            HasFrameCount = true;
+        }
+        else if (CompareStrings(Arg, "-width") && HasValue)
+        {
+            ScreenWidth = atoi(Argv[++ArgIndex]);
+        }
+        else if (CompareStrings(Arg, "-height") && HasValue)
+        {
+            ScreenHeight = atoi(Argv[++ArgIndex]);
+        }
+        else if (CompareStrings(Arg, "-dt") && HasValue)
+        {
+            DeltaTime = (f32) atof(Argv[++ArgIndex]);
+        }
+        else if (CompareStrings(Arg, "-script") && HasValue)
+        {
+            ScriptPath = Argv[++ArgIndex];
+        }
+        else if (CompareStrings(Arg, "-csv") && HasValue)
+        {
+            CSVPath = Argv[++ArgIndex];
+        }
+        else if (CompareStrings(Arg, "-record") && HasValue)
+        {
+            RecordPath = Argv[++ArgIndex];
+        }
+        else if (CompareStrings(Arg, "-playback") && HasValue)
+        {
+            PlaybackPath = Argv[++ArgIndex];
+        }
+        else
+        {
+            printf("PLATFORM: Unknown argument %s\n", Arg);
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (FrameCount == 0 || ScreenWidth <= 0 || ScreenHeight <= 0 || DeltaTime <= 0.0f)
+    {
+        printf("PLATFORM: -frames, -width, -height and -dt have to be positive\n");
+        return 1;
+    }
+
+    // NOTE: Both would share the one replay_state, and a playback's input is already on disk
+    if (RecordPath && PlaybackPath)
+    {
+        printf("PLATFORM: -record and -playback can't be used together\n");
+        PrintUsage();
+        return 1;
+    }
+
+    if (!CreateHeadlessGLContext())
+    {
+        return 1;
+    }
+
+    gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+    printf("PLATFORM: OpenGL loaded\n");
+    printf("PLATFORM: Vendor: %s\n", glGetString(GL_VENDOR));
+    printf("PLATFORM: Renderer: %s\n", glGetString(GL_RENDERER));
+    printf("PLATFORM: Version: %s\n", glGetString(GL_VERSION));
+
+    CreateOffscreenFramebuffer(ScreenWidth, ScreenHeight);
+
+    InitMediaLibraries();
+
+    game_memory GameMemory = CreateGameMemory();
+    GameMemory.GetGLProcAddress = (platform_get_gl_proc_address *) eglGetProcAddress;
+
+    game_input *GameInput = (game_input *) calloc(1, sizeof(game_input));
+    Assert(GameInput);
+
+    GameInput->ScreenWidth = ScreenWidth;
+    GameInput->ScreenHeight = ScreenHeight;
+    GameInput->OriginalScreenWidth = ScreenWidth;
+    GameInput->OriginalScreenHeight = ScreenHeight;
+    GameInput->DeltaTime = DeltaTime;
+    glViewport(0, 0, ScreenWidth, ScreenHeight);
+    printf("PLATFORM: Offscreen resolution: %d x %d\n", ScreenWidth, ScreenHeight);
+
+    headless_input_script Script = {};
+    replay_state Replay = {};
+    if (PlaybackPath)
+    {
+        if (!Replay_BeginPlayback(&Replay, PlaybackPath, GameInput, &GameMemory))
+        {
+            return 1;
+        }
+        if (!HasFrameCount)
+        {
+            FrameCount = 0xFFFFFFFF; // NOTE: Until the replay runs out
+        }
+    }
+    else if (ScriptPath)
+    {
+        Script = LoadInputScript(ScriptPath);
+        printf("PLATFORM: Loaded %u input events from %s\n", Script.EventCount, ScriptPath);
+    }
+
+    if (!PlaybackPath)
+    {
+        printf("PLATFORM: Running %u frames at DT=%0.6f\n", FrameCount, DeltaTime);
+    }
+
+    if (RecordPath && !Replay_BeginRecording(&Replay, RecordPath, GameInput, &GameMemory, false))
+    {
+        return 1;
+    }
+
+    // NOTE: Grows for playbacks that run until the replay ends
+    u32 FrameTimesCapacity = Min(FrameCount, 4096u);
+    f32 *FrameTimesMs = (f32 *) malloc(FrameTimesCapacity * sizeof(f32));
+    Assert(FrameTimesMs);
+
+    u64 PerfCounterFrequency = SDL_GetPerformanceFrequency();
+    frame_stats *FrameStats = GameMemory.FrameStats;
+    u32 FramesRun = 0;
+    u32 LoadingFrameCount = 1; // NOTE: Init, and then every frame that started with assets still streaming in
+    b32 ShouldQuit = false;
+
+    for (u32 FrameIndex = 0;
+         FrameIndex < FrameCount && !ShouldQuit;
+         ++FrameIndex)
+    {
+        u64 FrameStartCounter = SDL_GetPerformanceCounter();
+        FrameStats_BeginFrame(FrameStats, FrameStartCounter);
+        FrameStats_Mark(FrameStats, FrameStage_Update, FrameStartCounter);
+
+        if (Replay.Mode == ReplayMode_Playback)
+        {
+            if (!Replay_PlayFrame(&Replay, GameInput))
+            {
+                break;
+            }
+        }
+        else
+        {
+            UpdateScriptedInput(GameInput, &Script, FrameIndex);
+            if (Replay.Mode == ReplayMode_Recording)
+            {
+                Replay_RecordFrame(&Replay, GameInput);
+            }
+        }
+
+        GameUpdateAndRender(GameInput, &GameMemory, &ShouldQuit);
+
+        // NOTE: There is no swap to pace against, so wait for the GPU here. Frame times include the rendering
+        // instead of just the time to submit it, and show up as the swap stage.
+        FrameStats_Mark(FrameStats, FrameStage_Swap, SDL_GetPerformanceCounter());
+        glFinish();
+
+        u64 FrameEndCounter = SDL_GetPerformanceCounter();
+        FrameStats_EndFrame(FrameStats, FrameEndCounter);
+
+        if (FramesRun == FrameTimesCapacity)
+        {
+            FrameTimesCapacity *= 2;
+            FrameTimesMs = (f32 *) realloc(FrameTimesMs, FrameTimesCapacity * sizeof(f32));
+            Assert(FrameTimesMs);
+        }
+        FrameTimesMs[FramesRun++] = (f32) (1000.0 * (f64) (FrameEndCounter - FrameStartCounter) / (f64) PerfCounterFrequency);
+        if (GameMemory.IsStreamingAssets && LoadingFrameCount == FramesRun)
+        {
+            LoadingFrameCount++;
+        }
+    }
+
+    if (Replay.Mode == ReplayMode_Recording)
+    {
+        Replay_EndRecording(&Replay);
+    }
+    else if (Replay.Mode == ReplayMode_Playback)
+    {
+        Replay_EndPlayback(&Replay);
+    }
+
+    PrintFrameStats(FrameTimesMs, FramesRun, Min(LoadingFrameCount, FramesRun));
+
+    if (CSVPath)
+    {
+        if (WriteFrameStatsCSV(CSVPath, FrameStats))
+        {
+            printf("PLATFORM: Wrote the last %u frame timings to %s\n", FrameStats_GetSampleCount(FrameStats), CSVPath);
+        }
+        else
+        {
+            printf("PLATFORM: Could not write %s\n", CSVPath);
+        }
+    }
+
+    JobSystem_Destroy(GameMemory.JobSystem);
+
+    return 0;
+}
+
+void
+Platform_SetRelativeMouse(b32 Enabled)
+{
+    // NOTE: No cursor to capture, scripted mouse motion is always relative
+}
+
+internal headless_input_script
+LoadInputScript(const char *Path)
+{
+    headless_input_script Result = {};
+
+    FILE *File = OpenFile_(Path, "rb");
+    if (!File)
+    {
+        printf("PLATFORM: Could not open input script %s\n", Path);
+        return Result;
+    }
+
+    u32 EventCapacity = 64;
+    Result.Events = (headless_input_event *) malloc(EventCapacity * sizeof(headless_input_event));
+    Assert(Result.Events);
+
+    char Line[256];
+    u32 LineNumber = 0;
+    u32 LastFrame = 0;
+    while (fgets(Line, sizeof(Line), File))
+    {
+        LineNumber++;
+
+        char *Comment = Line;
+        while (*Comment && *Comment != '#') ++Comment;
+        *Comment = '\0';
+
+        u32 Frame;
+        char Command[32];
+        char Argument[64];
+        i32 ArgumentCount = sscanf(Line, "%u %31s %63[^\r\n]", &Frame, Command, Argument);
+        if (ArgumentCount <= 0)
+        {
+            continue;
+        }
+
+        // NOTE: Key names can have spaces ("Left Shift"), so the argument is the rest of the line minus
+        // trailing whitespace
+        if (ArgumentCount == 3)
+        {
+            char *ArgumentEnd = Argument;
+            while (*ArgumentEnd) ++ArgumentEnd;
+            while (ArgumentEnd > Argument && (ArgumentEnd[-1] == ' ' || ArgumentEnd[-1] == '\t'))
+            {
+                *--ArgumentEnd = '\0';
+            }
+        }
+
+        headless_input_event Event = {};
+        Event.Frame = Frame;
+        b32 IsValid = (ArgumentCount == 3) && (Frame >= LastFrame);
+
+        if (IsValid && CompareStrings(Command, "down"))
+        {
+            Event.Type = HeadlessInput_KeyDown;
+            Event.Scancode = SDL_GetScancodeFromName(Argument);
+            IsValid = (Event.Scancode != SDL_SCANCODE_UNKNOWN);
+        }
+        else if (IsValid && CompareStrings(Command, "up"))
+        {
+            Event.Type = HeadlessInput_KeyUp;
+            Event.Scancode = SDL_GetScancodeFromName(Argument);
+            IsValid = (Event.Scancode != SDL_SCANCODE_UNKNOWN);
+        }
+        else if (IsValid && CompareStrings(Command, "mouse"))
+        {
+            Event.Type = HeadlessInput_Mouse;
+            IsValid = (sscanf(Argument, "%d %d", &Event.MouseDeltaX, &Event.MouseDeltaY) == 2);
+        }
+        else
+        {
+            IsValid = false;
+        }
+
+        if (!IsValid)
+        {
+            // NOTE: Also catches events out of frame order, the script is replayed front to back
+            printf("PLATFORM: %s(%u): Skipping invalid input event\n", Path, LineNumber);
+            continue;
+        }
+
+        if (Result.EventCount == EventCapacity)
+        {
+            EventCapacity *= 2;
+            Result.Events = (headless_input_event *) realloc(Result.Events, EventCapacity * sizeof(headless_input_event));
+            Assert(Result.Events);
+        }
+        Result.Events[Result.EventCount++] = Event;
+        LastFrame = Frame;
+    }
+
+    fclose(File);
+
+    return Result;
+}
+
+// NOTE: Scripted events happen at the start of their frame, on a clock that advances by the fixed DeltaTime
+internal void
+UpdateScriptedInput(game_input *GameInput, headless_input_script *Script, u32 FrameIndex)
+{
+    f64 FrameTime = (f64) FrameIndex * (f64) GameInput->DeltaTime;
+
+    BeginInputFrame(GameInput);
+
+    while (Script->NextEvent < Script->EventCount && Script->Events[Script->NextEvent].Frame <= FrameIndex)
+    {
+        headless_input_event *Event = Script->Events + Script->NextEvent++;
+        switch (Event->Type)
+        {
+            case HeadlessInput_KeyDown:
+            case HeadlessInput_KeyUp:
+            {
+                PushKeyEvent(GameInput, Event->Scancode, (Event->Type == HeadlessInput_KeyDown), FrameTime);
+            } break;
+            case HeadlessInput_Mouse:
+            {
+                PushMouseMotion(GameInput,
+                                GameInput->MouseX + Event->MouseDeltaX, GameInput->MouseY + Event->MouseDeltaY,
+                                Event->MouseDeltaX, Event->MouseDeltaY);
+            } break;
+        }
+    }
+
+    GameInput->FrameTime = FrameTime;
+}
+
+internal b32
+CreateHeadlessGLContext()
+{
+    EGLDisplay Display = EGL_NO_DISPLAY;
+
+    // NOTE: Prefer Mesa's surfaceless platform, it needs neither X nor a DRM device
+    PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (GetPlatformDisplayEXT)
+    {
+        Display = GetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+    }
+    if (Display == EGL_NO_DISPLAY)
+    {
+        Display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint MajorVersion;
+    EGLint MinorVersion;
+    if (Display == EGL_NO_DISPLAY || !eglInitialize(Display, &MajorVersion, &MinorVersion))
+    {
+        printf("PLATFORM: Could not initialize EGL (0x%x)\n", eglGetError());
+        return false;
+    }
+    printf("PLATFORM: EGL %d.%d\n", MajorVersion, MinorVersion);
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        printf("PLATFORM: EGL has no desktop OpenGL\n");
+        return false;
+    }
+
+    EGLint ConfigAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig Config;
+    EGLint ConfigCount = 0;
+    if (!eglChooseConfig(Display, ConfigAttributes, &Config, 1, &ConfigCount) || ConfigCount == 0)
+    {
+        printf("PLATFORM: No suitable EGL config (0x%x)\n", eglGetError());
+        return false;
+    }
+
+    EGLint ContextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext Context = eglCreateContext(Display, Config, EGL_NO_CONTEXT, ContextAttributes);
+    if (Context == EGL_NO_CONTEXT)
+    {
+        printf("PLATFORM: Could not create an OpenGL 3.3 context (0x%x)\n", eglGetError());
+        return false;
+    }
+
+    // NOTE: No surface at all (EGL_KHR_surfaceless_context), the game renders into CreateOffscreenFramebuffer
+    if (!eglMakeCurrent(Display, EGL_NO_SURFACE, EGL_NO_SURFACE, Context))
+    {
+        printf("PLATFORM: Could not make the context current (0x%x)\n", eglGetError());
+        return false;
+    }
+
+    return true;
+}
+
+// NOTE: Stays bound for the whole run. The game never binds framebuffers itself, so everything it draws to
+// "the screen" lands here.
+internal void
+CreateOffscreenFramebuffer(i32 Width, i32 Height)
+{
+    u32 Framebuffer;
+    u32 Renderbuffers[2];
+    glGenFramebuffers(1, &Framebuffer);
+    glGenRenderbuffers(2, Renderbuffers);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, Renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, Width, Height);
+    glBindRenderbuffer(GL_RENDERBUFFER, Renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, Width, Height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, Renderbuffers[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, Renderbuffers[1]);
+
+    GLenum Status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    Assert(Status == GL_FRAMEBUFFER_COMPLETE);
+}
+
+internal int
+CompareF32(const void *A, const void *B)
+{
+    f32 ValueA = *(const f32 *) A;
+    f32 ValueB = *(const f32 *) B;
+    int Result = (ValueA < ValueB) ? -1 : ((ValueA > ValueB) ? 1 : 0);
+    return Result;
+}
+
+// NOTE: Covers the whole run, unlike frame_stats which only keeps the last FRAME_STATS_COUNT frames
+internal void
+PrintFrameStats(f32 *FrameTimesMs, u32 FrameCount, u32 LoadingFrameCount)
+{
+    if (FrameCount == 0)
+    {
+        return;
+    }
+
+    // NOTE: The first frame loads every asset and the ones after it upload textures until the queue drains, report
+    // those on their own so they don't skew the steady state percentiles
+    f64 StreamingMs = 0.0;
+    for (u32 FrameIndex = 1;
+         FrameIndex < LoadingFrameCount;
+         ++FrameIndex)
+    {
+        StreamingMs += FrameTimesMs[FrameIndex];
+    }
+    printf("PLATFORM: First frame (init): %0.3fms\n", FrameTimesMs[0]);
+    printf("PLATFORM: Streaming assets: %u frames, %0.3fms total\n", LoadingFrameCount - 1, StreamingMs);
+
+    f32 *Times = FrameTimesMs + LoadingFrameCount;
+    u32 Count = FrameCount - LoadingFrameCount;
+    if (Count == 0)
+    {
+        return;
+    }
+
+    f64 TotalMs = 0.0;
+    for (u32 FrameIndex = 0;
+         FrameIndex < Count;
+         ++FrameIndex)
+    {
+        TotalMs += Times[FrameIndex];
+    }
+
+    qsort(Times, Count, sizeof(f32), CompareF32);
+
+    f32 MedianMs = GetSortedPercentile(Times, Count, 50.0f);
+    u32 HitchCount = 0;
+    for (u32 FrameIndex = Count;
+         FrameIndex > 0 && Times[FrameIndex - 1] > MedianMs * FRAME_STATS_HITCH_RATIO;
+         --FrameIndex)
+    {
+        HitchCount++;
+    }
+
+    f64 AverageMs = TotalMs / (f64) Count;
+    printf("PLATFORM: %u frames, %0.3fms total, %0.3f FPS average\n", Count, TotalMs, 1000.0 / AverageMs);
+    printf("PLATFORM: Frame ms: min %0.3f | avg %0.3f | p50 %0.3f | p95 %0.3f | p99 %0.3f | max %0.3f | %u hitches\n",
+           Times[0], AverageMs, MedianMs,
+           GetSortedPercentile(Times, Count, 95.0f),
+           GetSortedPercentile(Times, Count, 99.0f),
+           Times[Count - 1], HitchCount);
+}
@@ -9,20 +9,378 @@
 #include "opusone_immtext.h"
 #include "opusone_collision.h"
 #include "opusone_entity.h"
+#include "opusone_cooked_model.h"
+#include "opusone_cooked_texture.h"
+#include "opusone_asset_registry.h"
 
 #include <cstdio>
 #include <glad/glad.h>
 
 #include "opusone_debug_draw.cpp"
+#include "opusone_arena_stats.cpp"
+#include "opusone_frame_stats.cpp"
 
 global_variable f32 AdamHeight = 1.8412f;
 global_variable f32 AdamHalfHeight = AdamHeight * 0.5f;
 
-void
+// NOTE: Entity types that got the same model from the asset registry share its render data too, only the first of
+// them prepares it
+internal entity_type_spec *
+FindEarlierSpecWithModel(entity_type_spec *Specs, u32 EntityType)
+{
+    for (u32 EarlierType = EntityType_None + 1;
+         EarlierType < EntityType;
+         ++EarlierType)
+    {
+        if (Specs[EarlierType].ImportedModel == Specs[EntityType].ImportedModel)
+        {
+            return Specs + EarlierType;
+        }
+    }
+    return 0;
+}
+
+// NOTE: Cooked models (see opusone_cooker.cpp, build.sh runs it) load without Assimp. Importing the source is only
+// there in internal builds, for when a model is being worked on and hasn't been cooked again yet. It takes seconds
+// instead of milliseconds, so it shouldn't go unnoticed.
+internal imported_model *
+LoadModel(memory_arena *AssetArena, const char *Path)
+{
+    char CookedPath[256];
+    FormatString(CookedPath, sizeof(CookedPath), "%s%s", Path, COOKED_MODEL_EXTENSION);
+
+    imported_model *Result = CookedModel_Load(AssetArena, CookedPath, Path);
+    if (!Result)
+    {
+#if OPUSONE_INTERNAL
+        printf("ASSIMP: Importing %s, there is no usable cooked model. Run opusone_cooker on it!\n", Path);
+        Result = Assimp_LoadModel(AssetArena, Path);
+        // TODO: Handle models that can't be loaded at all
+        Assert(Result);
+#else
+        printf("COOKER: There is no usable cooked model for %s, run opusone_cooker on it\n", Path);
+        InvalidCodePath;
+#endif
+    }
+    return Result;
+}
+
+//
+// NOTE: Startup loading is a pipeline on the job system, so it's spread over every core:
+//   1. Model imports, one job per distinct model. A finished import adds the collision cooking of the entity
+//      types that use it.
+//   2. The main thread takes the imports in order, and starts reading and decoding the textures of each as soon
+//      as it's done, one job per file.
+//   3. Everything is uploaded to GL on the main thread (GL only works there), textures once they're decoded.
+// Fonts and shaders are built on the main thread while the imports run. Jobs only push to arenas of their own
+// (nested in the asset and world arenas), the intern table and the arena tag stats are locked.
+//
+#define STARTUP_MODEL_ARENA_SIZE Megabytes(64)
+#define STARTUP_COLLISION_ARENA_SIZE Megabytes(16)
+
+struct startup_collision_cook;
+
+struct startup_model_import
+{
+    const char *Path;
+    u32 AssetEntryIndex;
+    memory_arena Arena;
+    imported_model *Model;
+
+    platform_job_group Group;
+    b32 WasHandedOver; // NOTE: To the asset registry, by the main thread
+
+    // NOTE: Added to CookGroup by the import job once the model is there
+    startup_collision_cook *FirstCook;
+    platform_job_group *CookGroup;
+    platform_job_system *JobSystem;
+    platform_add_job *AddJob;
+};
+
+struct startup_collision_cook
+{
+    imported_model *Model; // NOTE: Set right before the job is added
+    polyhedron_set *PolyhedronSet;
+    memory_arena Arena;
+
+    startup_collision_cook *NextInImport;
+};
+
+struct startup_texture_decode
+{
+    string_id Path;
+    u64 ContentHash;
+    size_t ContentSize;
+    texture_data Texture; // NOTE: Points into CookedFile if there's a cooked texture, into Image otherwise
+    platform_mapped_file CookedFile;
+    platform_image Image;
+
+    platform_job_group Group; // NOTE: One per texture, so each one is uploaded as soon as it's decoded
+};
+
+internal void
+CookCollisionJob(void *Data, memory_arena *ScratchArena)
+{
+    startup_collision_cook *Cook = (startup_collision_cook *) Data;
+    imported_model *Model = Cook->Model;
+    polyhedron_set *PolyhedronSet = Cook->PolyhedronSet;
+
+    PolyhedronSet->PolyhedronCount = Model->MeshCount;
+    PolyhedronSet->Polyhedra = MemoryArena_PushArray(&Cook->Arena, PolyhedronSet->PolyhedronCount, polyhedron);
+
+    imported_mesh *ImportedMeshCursor = Model->Meshes;
+    polyhedron *PolyhedronCursor = PolyhedronSet->Polyhedra;
+    for (u32 MeshIndex = 0;
+         MeshIndex < Model->MeshCount;
+         ++MeshIndex, ++ImportedMeshCursor, ++PolyhedronCursor)
+    {
+        ComputePolyhedronFromVertices(&Cook->Arena, ScratchArena,
+                                      ImportedMeshCursor->VertexPositions, ImportedMeshCursor->VertexCount,
+                                      ImportedMeshCursor->Indices, ImportedMeshCursor->IndexCount,
+                                      PolyhedronCursor);
+    }
+}
+
+internal void
+ImportModelJob(void *Data, memory_arena *ScratchArena)
+{
+    startup_model_import *Import = (startup_model_import *) Data;
+    Import->Model = LoadModel(&Import->Arena, Import->Path);
+
+    for (startup_collision_cook *Cook = Import->FirstCook;
+         Cook;
+         Cook = Cook->NextInImport)
+    {
+        Cook->Model = Import->Model;
+        Import->AddJob(Import->JobSystem, Import->CookGroup, CookCollisionJob, Cook);
+    }
+}
+
+internal void
+DecodeTextureJob(void *Data, memory_arena *ScratchArena)
+{
+    startup_texture_decode *Decode = (startup_texture_decode *) Data;
+    const char *Path = StringID_GetString(Decode->Path);
+
+    // NOTE: Cooked textures stay mapped until they're queued for upload. Their contents are hashed instead of the
+    // source's, the same source always cooks to the same bytes.
+    char CookedPath[256];
+    FormatString(CookedPath, sizeof(CookedPath), "%s%s", Path, COOKED_TEXTURE_EXTENSION);
+    if (CookedTexture_Map(CookedPath, Path, &Decode->CookedFile, &Decode->Texture))
+    {
+        Decode->ContentHash = HashBytes(Decode->CookedFile.Data, Decode->CookedFile.Size);
+        Decode->ContentSize = Decode->CookedFile.Size;
+        return;
+    }
+
+    platform_mapped_file File = Platform_MapFile(Path, MapHint_Sequential);
+    // TODO: Handle missing textures properly
+    Assert(File.Data);
+
+    Decode->ContentHash = HashBytes(File.Data, File.Size);
+    Decode->ContentSize = File.Size;
+    Decode->Image = Platform_LoadImageFromMemory(File.Data, File.Size, Path);
+    Decode->Texture = TextureData_FromImage(&Decode->Image);
+
+    Platform_UnmapFile(&File);
+}
+
+internal startup_model_import *
+FindStartupModelImport(startup_model_import *Imports, u32 ImportCount, u32 AssetEntryIndex)
+{
+    for (u32 ImportIndex = 0;
+         ImportIndex < ImportCount;
+         ++ImportIndex)
+    {
+        if (Imports[ImportIndex].AssetEntryIndex == AssetEntryIndex)
+        {
+            return Imports + ImportIndex;
+        }
+    }
+    return 0;
+}
+
+internal startup_texture_decode *
+FindStartupTextureDecode(stretchy_array<startup_texture_decode *> *Decodes, string_id Path)
+{
+    for (u32 DecodeIndex = 0;
+         DecodeIndex < Decodes->Count;
+         ++DecodeIndex)
+    {
+        if (Decodes->D[DecodeIndex]->Path == Path)
+        {
+            return Decodes->D[DecodeIndex];
+        }
+    }
+    return 0;
+}
+
+// NOTE: Once they're uploaded (or queued, the upload queue copies them)
+internal void
+FreeStartupTextureDecodes(stretchy_array<startup_texture_decode *> *Decodes)
+{
+    for (u32 DecodeIndex = 0;
+         DecodeIndex < Decodes->Count;
+         ++DecodeIndex)
+    {
+        startup_texture_decode *Decode = Decodes->D[DecodeIndex];
+        if (Decode->CookedFile.Data)
+        {
+            Platform_UnmapFile(&Decode->CookedFile);
+        }
+        else
+        {
+            Platform_FreeImage(&Decode->Image);
+        }
+    }
+}
+
+// NOTE: F12 reloads every material texture from disk, e.g. after cooking them again. All the materials release
+// their textures first, so every count reaches zero and the texture is deleted (its upload cancelled if it was
+// still pending), then they're decoded on the job system and acquired again like at startup.
+internal void
+ReloadMaterialTextures(game_state *GameState, game_memory *GameMemory)
+{
+    temporary_memory ReloadMemory = MemoryArena_BeginTemp(&GameState->TransientArena);
+    stretchy_array<startup_texture_decode *> TextureDecodes =
+        StretchyArray<startup_texture_decode *>(&GameState->TransientArena, 64);
+
+    for (u32 EntityType = EntityType_None + 1;
+         EntityType < EntityType_Count;
+         ++EntityType)
+    {
+        entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
+        if (FindEarlierSpecWithModel(GameState->EntityTypeSpecs, EntityType))
+        {
+            continue;
+        }
+
+        imported_model *ImportedModel = Spec->ImportedModel;
+        for (u32 MaterialPerModelIndex = 1;
+             MaterialPerModelIndex < ImportedModel->MaterialCount;
+             ++MaterialPerModelIndex)
+        {
+            imported_material *ImportedMaterial = ImportedModel->Materials + MaterialPerModelIndex;
+            render_data_material *Material = Spec->RenderUnit->Materials + Spec->BaseMaterialID + (MaterialPerModelIndex - 1);
+            for (u32 TexturePathIndex = 0;
+                 TexturePathIndex < TEXTURE_TYPE_COUNT;
+                 ++TexturePathIndex)
+            {
+                if (Material->TextureIDs[TexturePathIndex])
+                {
+                    AssetRegistry_ReleaseTexture(&GameState->Assets, &GameState->TextureUploads, Material->TextureIDs[TexturePathIndex]);
+                    Material->TextureIDs[TexturePathIndex] = 0;
+                }
+
+                string_id Path = ImportedMaterial->TexturePaths[TexturePathIndex];
+                if (!Path || FindStartupTextureDecode(&TextureDecodes, Path))
+                {
+                    continue;
+                }
+
+                startup_texture_decode *Decode = MemoryArena_PushStruct(&GameState->TransientArena, startup_texture_decode);
+                *Decode = {};
+                Decode->Path = Path;
+                StretchyArray_Push(&TextureDecodes, Decode);
+
+                GameMemory->AddJob(GameMemory->JobSystem, &Decode->Group, DecodeTextureJob, Decode);
+            }
+        }
+    }
+
+    for (u32 EntityType = EntityType_None + 1;
+         EntityType < EntityType_Count;
+         ++EntityType)
+    {
+        entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
+        if (FindEarlierSpecWithModel(GameState->EntityTypeSpecs, EntityType))
+        {
+            continue;
+        }
+
+        imported_model *ImportedModel = Spec->ImportedModel;
+        for (u32 MaterialPerModelIndex = 1;
+             MaterialPerModelIndex < ImportedModel->MaterialCount;
+             ++MaterialPerModelIndex)
+        {
+            imported_material *ImportedMaterial = ImportedModel->Materials + MaterialPerModelIndex;
+            render_data_material *Material = Spec->RenderUnit->Materials + Spec->BaseMaterialID + (MaterialPerModelIndex - 1);
+            for (u32 TexturePathIndex = 0;
+                 TexturePathIndex < TEXTURE_TYPE_COUNT;
+                 ++TexturePathIndex)
+            {
+                string_id Path = ImportedMaterial->TexturePaths[TexturePathIndex];
+                if (!Path)
+                {
+                    continue;
+                }
+
+                startup_texture_decode *Decode = FindStartupTextureDecode(&TextureDecodes, Path);
+                Assert(Decode);
+                GameMemory->WaitForJobGroup(GameMemory->JobSystem, &Decode->Group);
+
+                Material->TextureIDs[TexturePathIndex] =
+                    AssetRegistry_AcquireTexture(&GameState->Assets, &GameState->TextureUploads, StringID_GetString(Path),
+                                                 Decode->ContentHash, Decode->ContentSize, &Decode->Texture);
+            }
+        }
+    }
+
+    FreeStartupTextureDecodes(&TextureDecodes);
+    printf("RENDER: Reloaded %u textures\n", TextureDecodes.Count);
+    MemoryArena_EndTemp(ReloadMemory);
+}
+
+// NOTE: Player controls as of the end of a sim step, and presses that happened during it
+internal void
+SampleRequestedPlayerControls(game_input *GameInput, game_requested_controls *RequestedControls,
+                              f64 StepStartTime, f64 StepEndTime)
+{
+    RequestedControls->PlayerForward = Platform_KeyIsDownAt(GameInput, SDL_SCANCODE_W, StepEndTime);
+    RequestedControls->PlayerBackward = Platform_KeyIsDownAt(GameInput, SDL_SCANCODE_S, StepEndTime);
+    RequestedControls->PlayerLeft = Platform_KeyIsDownAt(GameInput, SDL_SCANCODE_A, StepEndTime);
+    RequestedControls->PlayerRight = Platform_KeyIsDownAt(GameInput, SDL_SCANCODE_D, StepEndTime);
+    RequestedControls->PlayerUp = Platform_KeyIsDownAt(GameInput, SDL_SCANCODE_SPACE, StepEndTime);
+    RequestedControls->PlayerDown = Platform_KeyIsDownAt(GameInput, SDL_SCANCODE_LSHIFT, StepEndTime);
+    RequestedControls->PlayerJump = (Platform_KeyPressedInRange(GameInput, SDL_SCANCODE_SPACE, StepStartTime, StepEndTime) ||
+                                     Platform_KeyPressedInRange(GameInput, SDL_SCANCODE_BACKSPACE, StepStartTime, StepEndTime));
+}
+
+internal void
+InitializeQuickDraw(game_state *GameState)
+{
+    ImmText_InitializeQuickDraw(GameState->ContrailOne,
+                                5, 5, 2560, 1440,
+                                Vec3(1), Vec3(),
+                                &GameState->ImmTextRenderUnit, &GameState->RenderArena);
+
+    DD_InitializeQuickDraw(&GameState->DebugDrawRenderUnit);
+}
+
+extern "C" void
 GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameShouldQuit)
 {
     game_state *GameState = (game_state *) GameMemory->Storage;
 
+    //
+    // NOTE: New game code loaded (the first frame counts too). Its globals start out zeroed.
+    //
+    if (GameMemory->ModuleReloaded)
+    {
+        GameMemory->ModuleReloaded = false;
+
+        if (GameMemory->GetGLProcAddress)
+        {
+            gladLoadGLLoader((GLADloadproc) GameMemory->GetGLProcAddress);
+        }
+
+        if (GameMemory->IsInitialized)
+        {
+            GlobalStringTable = GameState->StringTable;
+            InitializeQuickDraw(GameState);
+        }
+    }
+
     //
     // NOTE: First frame/initialization
     //
@@ -30,42 +388,46 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
     {
         GameMemory->IsInitialized = true;
 
-        // TODO: Allocate more than game_state size? Better if I do hot-reloading in the future
+        // NOTE: Storage is only reserved address space. Game state is bootstrapped from the root arena,
+        // so its pages get committed along with it, and every nested arena commits pages as it grows.
         // NOTE: Not sure if nested arenas are a good idea, but I will go with it for now
-        u8 *RootArenaBase = (u8 *) GameMemory->Storage + sizeof(game_state);
-        size_t RootArenaSize = GameMemory->StorageSize - sizeof(game_state);
-        GameState->RootArena = MemoryArena(RootArenaBase, RootArenaSize);
+        memory_arena RootArena = MemoryArenaReserved((u8 *) GameMemory->Storage, GameMemory->StorageSize);
+        game_state *BootstrappedState = MemoryArena_PushStruct(&RootArena, game_state);
+        Assert(BootstrappedState == GameState);
+        GameState->RootArena = RootArena;
+
+        GameState->WorldArena = MemoryArenaNested(&GameState->RootArena, Gigabytes(1));
+        GameState->RenderArena = MemoryArenaNested(&GameState->RootArena, Megabytes(256));
+        GameState->AssetArena = MemoryArenaNested(&GameState->RootArena, Gigabytes(2));
+        GameState->TransientArena = MemoryArenaNested(&GameState->RootArena, Megabytes(512));
+        GameState->StringArena = MemoryArenaNested(&GameState->RootArena, Megabytes(64));
+        GameState->UploadArena = MemoryArenaNested(&GameState->RootArena, Megabytes(512));
+
+        MemoryArena_SetDebugName(&GameState->RootArena, "Root");
+        MemoryArena_SetDebugName(&GameState->WorldArena, "World");
+        MemoryArena_SetDebugName(&GameState->RenderArena, "Render");
+        MemoryArena_SetDebugName(&GameState->AssetArena, "Asset");
+        MemoryArena_SetDebugName(&GameState->TransientArena, "Transient");
+        MemoryArena_SetDebugName(&GameState->StringArena, "String");
+        MemoryArena_SetDebugName(&GameState->UploadArena, "Upload");
+
+        GameState->StringTable = StringTable(&GameState->StringArena, 4096);
+        GlobalStringTable = GameState->StringTable;
+        GameState->Assets = AssetRegistry(&GameState->WorldArena, 64);
+        TextureUploadQueue_Initialize(&GameState->TextureUploads, &GameState->UploadArena);
+
+        Platform_AdviseHugePages(GameState->WorldArena.Base, GameState->WorldArena.Size);
+        Platform_AdviseHugePages(GameState->AssetArena.Base, GameState->AssetArena.Size);
 
-        GameState->WorldArena = MemoryArenaNested(&GameState->RootArena, Megabytes(4));
-        GameState->RenderArena = MemoryArenaNested(&GameState->RootArena, Megabytes(4));
-        GameState->AssetArena = MemoryArenaNested(&GameState->RootArena, Megabytes(16));
-        GameState->TransientArena = MemoryArenaNested(&GameState->RootArena, Megabytes(4));
-
-        GameState->ContrailOne = ImmText_LoadFont(&GameState->AssetArena, "resources/fonts/ContrailOne-Regular.ttf", 36);
-        // GameState->MajorMono = ImmText_LoadFont(&GameState->AssetArena, "resources/fonts/MajorMonoDisplay-Regular.ttf", 72);
-
-        u32 StaticShader = OpenGL_BuildShaderProgram("resources/shaders/StaticMesh.vs", "resources/shaders/Basic.fs");
-        OpenGL_SetUniformInt(StaticShader, "DiffuseMap", 0, true);
-        OpenGL_SetUniformInt(StaticShader, "SpecularMap", 1, false);
-        OpenGL_SetUniformInt(StaticShader, "EmissionMap", 2, false);
-        OpenGL_SetUniformInt(StaticShader, "NormalMap", 3, false);
-        vec3 LightDirection = VecNormalize(Vec3(-1.0f, -1.0f, -1.0f));
-        OpenGL_SetUniformVec3F(StaticShader, "LightDirection", (f32 *) &LightDirection, false);
-        u32 SkinnedShader = OpenGL_BuildShaderProgram("resources/shaders/SkinnedMesh.vs", "resources/shaders/Basic.fs");
-        OpenGL_SetUniformInt(SkinnedShader, "DiffuseMap", 0, true);
-        OpenGL_SetUniformInt(SkinnedShader, "SpecularMap", 1, false);
-        OpenGL_SetUniformInt(SkinnedShader, "EmissionMap", 2, false);
-        OpenGL_SetUniformInt(SkinnedShader, "NormalMap", 3, false);
-        OpenGL_SetUniformVec3F(SkinnedShader, "LightDirection", (f32 *) &LightDirection, false);
-        u32 DebugDrawShader = OpenGL_BuildShaderProgram("resources/shaders/DebugDraw.vs", "resources/shaders/DebugDraw.fs");
-        u32 ImmTextShader = OpenGL_BuildShaderProgram("resources/shaders/ImmText.vs", "resources/shaders/ImmText.fs");
-        OpenGL_SetUniformInt(SkinnedShader, "FontAtlas", 0, true);
+        //
+        // NOTE: Startup pipeline stage 1, kick off the model imports (see startup_model_import)
+        //
+        temporary_memory StartupMemory = MemoryArena_BeginTemp(&GameState->TransientArena);
 
-        GameState->Camera.Position = Vec3(0.0f, 0.1f, 5.0f);
-        GameState->Camera.Yaw = 145.0f;
-        GameState->Camera.Pitch = -30.0f;
-        GameState->Camera.ThirdPersonRadius = 5.0f;
-        GameState->Camera.IsThirdPerson = true;
+        startup_model_import *Imports = MemoryArena_PushArray(&GameState->TransientArena, EntityType_Count, startup_model_import);
+        u32 ImportCount = 0;
+        u32 ModelEntryIndices[EntityType_Count] = {};
+        platform_job_group CookGroup = {};
 
         GameState->EntityTypeSpecs = MemoryArena_PushArray(&GameState->WorldArena, EntityType_Count, entity_type_spec);
         for (u32 EntityType = EntityType_None + 1;
@@ -73,41 +435,22 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
              ++EntityType)
         {
             entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
+            const char *ModelPath = 0;
+            b32 CooksPolyhedra = false;
 
             switch (EntityType)
             {
                 case EntityType_BoxRoom:
                 {
-                    Spec->ImportedModel = Assimp_LoadModel(&GameState->AssetArena, "resources/models/box_room_separate/BoxRoomSeparate.gltf");
-
-                    // TODO: Pull full initialization of a collision geometry based on type and imported model into a function
-                    {
-                        Spec->CollisionType = COLLISION_TYPE_POLYHEDRON_SET;
-                        Spec->CollisionGeometry = MemoryArena_PushStruct(&GameState->WorldArena, collision_geometry);
-                        polyhedron_set *PolyhedronSet = &Spec->CollisionGeometry->PolyhedronSet;
-                        PolyhedronSet->PolyhedronCount = Spec->ImportedModel->MeshCount;
-                        PolyhedronSet->Polyhedra = MemoryArena_PushArray(&GameState->WorldArena, PolyhedronSet->PolyhedronCount, polyhedron);
-                    
-                        imported_mesh *ImportedMeshCursor = Spec->ImportedModel->Meshes;
-                        polyhedron *PolyhedronCursor = PolyhedronSet->Polyhedra;
-                        for (u32 MeshIndex = 0;
-                             MeshIndex < Spec->ImportedModel->MeshCount;
-                             ++MeshIndex, ++ImportedMeshCursor, ++PolyhedronCursor)
-                        {
-                            ComputePolyhedronFromVertices(&GameState->WorldArena, &GameState->TransientArena,
-                                                          ImportedMeshCursor->VertexPositions, ImportedMeshCursor->VertexCount,
-                                                          ImportedMeshCursor->Indices, ImportedMeshCursor->IndexCount,
-                                                          PolyhedronCursor);
-                        }
-                    }
+                    ModelPath = "resources/models/box_room_separate/BoxRoomSeparate.gltf";
+                    CooksPolyhedra = true;
                 } break;
 
                 case EntityType_Player:
                 case EntityType_Enemy:
                 {
-                    // TODO: I think it's asset importer's responsibility to be a little smarter, and not reload same models.
-                    // Will address redundant (e.g. player and enemy has same model, but different in other parts of the spec) loads later.
-                    Spec->ImportedModel = Assimp_LoadModel(&GameState->AssetArena, "resources/models/adam/adam_new.gltf");
+                    // NOTE: Player and enemy share the model (and its render data, see below), only the rest of the spec differs
+                    ModelPath = "resources/models/adam/adam_new.gltf";
 
                     // TODO: This info should come from the importer later
 
@@ -122,7 +465,7 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
 
                 case EntityType_Thing:
                 {
-                    Spec->ImportedModel = Assimp_LoadModel(&GameState->AssetArena, "resources/models/complex_animation_keys/AnimationStudy2c.gltf");
+                    ModelPath = "resources/models/complex_animation_keys/AnimationStudy2c.gltf";
 
                     {
                         Spec->CollisionType = COLLISION_TYPE_NONE;
@@ -132,76 +475,22 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
 
                 case EntityType_Container:
                 {
-                    Spec->ImportedModel = Assimp_LoadModel(&GameState->AssetArena, "resources/models/container/Container.gltf");
-
-                    {
-                        Spec->CollisionType = COLLISION_TYPE_POLYHEDRON_SET;
-                        Spec->CollisionGeometry = MemoryArena_PushStruct(&GameState->WorldArena, collision_geometry);
-                        polyhedron_set *PolyhedronSet = &Spec->CollisionGeometry->PolyhedronSet;
-                        PolyhedronSet->PolyhedronCount = Spec->ImportedModel->MeshCount;
-                        PolyhedronSet->Polyhedra = MemoryArena_PushArray(&GameState->WorldArena, PolyhedronSet->PolyhedronCount, polyhedron);
-                    
-                        imported_mesh *ImportedMeshCursor = Spec->ImportedModel->Meshes;
-                        polyhedron *PolyhedronCursor = PolyhedronSet->Polyhedra;
-                        for (u32 MeshIndex = 0;
-                             MeshIndex < Spec->ImportedModel->MeshCount;
-                             ++MeshIndex, ++ImportedMeshCursor, ++PolyhedronCursor)
-                        {
-                            ComputePolyhedronFromVertices(&GameState->WorldArena, &GameState->TransientArena,
-                                                          ImportedMeshCursor->VertexPositions, ImportedMeshCursor->VertexCount,
-                                                          ImportedMeshCursor->Indices, ImportedMeshCursor->IndexCount,
-                                                          PolyhedronCursor);
-                        }
-                    }
+                    ModelPath = "resources/models/container/Container.gltf";
+                    CooksPolyhedra = true;
                 } break;
 
                 case EntityType_Snowman:
                 {
-                    Spec->ImportedModel = Assimp_LoadModel(&GameState->AssetArena, "resources/models/snowman/Snowman.gltf");
-
-                    {
-                        Spec->CollisionType = COLLISION_TYPE_POLYHEDRON_SET;
-                        Spec->CollisionGeometry = MemoryArena_PushStruct(&GameState->WorldArena, collision_geometry);
-                        polyhedron_set *PolyhedronSet = &Spec->CollisionGeometry->PolyhedronSet;
-                        PolyhedronSet->PolyhedronCount = Spec->ImportedModel->MeshCount;
-                        PolyhedronSet->Polyhedra = MemoryArena_PushArray(&GameState->WorldArena, PolyhedronSet->PolyhedronCount, polyhedron);
-                    
-                        imported_mesh *ImportedMeshCursor = Spec->ImportedModel->Meshes;
-                        polyhedron *PolyhedronCursor = PolyhedronSet->Polyhedra;
-                        for (u32 MeshIndex = 0;
-                             MeshIndex < Spec->ImportedModel->MeshCount;
-                             ++MeshIndex, ++ImportedMeshCursor, ++PolyhedronCursor)
-                        {
-                            ComputePolyhedronFromVertices(&GameState->WorldArena, &GameState->TransientArena,
-                                                          ImportedMeshCursor->VertexPositions, ImportedMeshCursor->VertexCount,
-                                                          ImportedMeshCursor->Indices, ImportedMeshCursor->IndexCount,
-                                                          PolyhedronCursor);
-                        }
-                    }
+                    ModelPath = "resources/models/snowman/Snowman.gltf";
+                    CooksPolyhedra = true;
                 } break;
 
                 case EntityType_ObstacleCourse:
                 {
-                    Spec->ImportedModel = Assimp_LoadModel(&GameState->AssetArena, "resources/models/collisions/Collisions.gltf");
+                    ModelPath = "resources/models/collisions/Collisions.gltf";
 
                     {
-                        // Spec->CollisionType = COLLISION_TYPE_POLYHEDRON_SET;
-                        // Spec->CollisionGeometry = MemoryArena_PushStruct(&GameState->WorldArena, collision_geometry);
-                        // polyhedron_set *PolyhedronSet = &Spec->CollisionGeometry->PolyhedronSet;
-                        // PolyhedronSet->PolyhedronCount = Spec->ImportedModel->MeshCount;
-                        // PolyhedronSet->Polyhedra = MemoryArena_PushArray(&GameState->WorldArena, PolyhedronSet->PolyhedronCount, polyhedron);
-                    
-                        // imported_mesh *ImportedMeshCursor = Spec->ImportedModel->Meshes;
-                        // polyhedron *PolyhedronCursor = PolyhedronSet->Polyhedra;
-                        // for (u32 MeshIndex = 0;
-                        //      MeshIndex < Spec->ImportedModel->MeshCount;
-                        //      ++MeshIndex, ++ImportedMeshCursor, ++PolyhedronCursor)
-                        // {
-                        //     ComputePolyhedronFromVertices(&GameState->WorldArena, &GameState->TransientArena,
-                        //                                   ImportedMeshCursor->VertexPositions, ImportedMeshCursor->VertexCount,
-                        //                                   ImportedMeshCursor->Indices, ImportedMeshCursor->IndexCount,
-                        //                                   PolyhedronCursor);
-                        // }
+                        // CooksPolyhedra = true;
                         Spec->CollisionType = COLLISION_TYPE_TRIANGLE;
                     }
                 } break;
@@ -211,6 +500,135 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
                     InvalidCodePath;
                 } break;
             }
+
+            b32 NeedsLoad;
+            ModelEntryIndices[EntityType] = AssetRegistry_AcquireModelEntry(&GameState->Assets, ModelPath, &NeedsLoad);
+            startup_model_import *Import = FindStartupModelImport(Imports, ImportCount, ModelEntryIndices[EntityType]);
+            if (NeedsLoad)
+            {
+                Import = Imports + ImportCount++;
+                *Import = {};
+                Import->Path = ModelPath;
+                Import->AssetEntryIndex = ModelEntryIndices[EntityType];
+                Import->Arena = MemoryArenaNested(&GameState->AssetArena, STARTUP_MODEL_ARENA_SIZE);
+                MemoryArena_SetDebugName(&Import->Arena, "Asset");
+                Import->CookGroup = &CookGroup;
+                Import->JobSystem = GameMemory->JobSystem;
+                Import->AddJob = GameMemory->AddJob;
+            }
+
+            // TODO: Pull full initialization of a collision geometry based on type and imported model into a function
+            if (CooksPolyhedra)
+            {
+                Spec->CollisionType = COLLISION_TYPE_POLYHEDRON_SET;
+                Spec->CollisionGeometry = MemoryArena_PushStruct(&GameState->WorldArena, collision_geometry);
+
+                startup_collision_cook *Cook = MemoryArena_PushStruct(&GameState->TransientArena, startup_collision_cook);
+                *Cook = {};
+                Cook->PolyhedronSet = &Spec->CollisionGeometry->PolyhedronSet;
+                Cook->Arena = MemoryArenaNested(&GameState->WorldArena, STARTUP_COLLISION_ARENA_SIZE);
+                MemoryArena_SetDebugName(&Cook->Arena, "World");
+
+                if (Import)
+                {
+                    Cook->NextInImport = Import->FirstCook;
+                    Import->FirstCook = Cook;
+                }
+                else
+                {
+                    // NOTE: The registry had the model already
+                    Cook->Model = AssetRegistry_GetModel(&GameState->Assets, ModelEntryIndices[EntityType]);
+                    GameMemory->AddJob(GameMemory->JobSystem, &CookGroup, CookCollisionJob, Cook);
+                }
+            }
+        }
+
+        for (u32 ImportIndex = 0;
+             ImportIndex < ImportCount;
+             ++ImportIndex)
+        {
+            startup_model_import *Import = Imports + ImportIndex;
+            GameMemory->AddJob(GameMemory->JobSystem, &Import->Group, ImportModelJob, Import);
+        }
+
+        GameState->ContrailOne = ImmText_LoadFont(&GameState->AssetArena, "resources/fonts/ContrailOne-Regular.ttf", 36);
+        // GameState->MajorMono = ImmText_LoadFont(&GameState->AssetArena, "resources/fonts/MajorMonoDisplay-Regular.ttf", 72);
+
+        u32 StaticShader = OpenGL_BuildShaderProgram("resources/shaders/StaticMesh.vs", "resources/shaders/Basic.fs");
+        OpenGL_SetUniformInt(StaticShader, "DiffuseMap", 0, true);
+        OpenGL_SetUniformInt(StaticShader, "SpecularMap", 1, false);
+        OpenGL_SetUniformInt(StaticShader, "EmissionMap", 2, false);
+        OpenGL_SetUniformInt(StaticShader, "NormalMap", 3, false);
+        vec3 LightDirection = VecNormalize(Vec3(-1.0f, -1.0f, -1.0f));
+        OpenGL_SetUniformVec3F(StaticShader, "LightDirection", (f32 *) &LightDirection, false);
+        u32 SkinnedShader = OpenGL_BuildShaderProgram("resources/shaders/SkinnedMesh.vs", "resources/shaders/Basic.fs");
+        OpenGL_SetUniformInt(SkinnedShader, "DiffuseMap", 0, true);
+        OpenGL_SetUniformInt(SkinnedShader, "SpecularMap", 1, false);
+        OpenGL_SetUniformInt(SkinnedShader, "EmissionMap", 2, false);
+        OpenGL_SetUniformInt(SkinnedShader, "NormalMap", 3, false);
+        OpenGL_SetUniformVec3F(SkinnedShader, "LightDirection", (f32 *) &LightDirection, false);
+        u32 DebugDrawShader = OpenGL_BuildShaderProgram("resources/shaders/DebugDraw.vs", "resources/shaders/DebugDraw.fs");
+        u32 ImmTextShader = OpenGL_BuildShaderProgram("resources/shaders/ImmText.vs", "resources/shaders/ImmText.fs");
+        OpenGL_SetUniformInt(SkinnedShader, "FontAtlas", 0, true);
+
+        GameState->Camera.Position = Vec3(0.0f, 0.1f, 5.0f);
+        GameState->Camera.Yaw = 145.0f;
+        GameState->Camera.Pitch = -30.0f;
+        GameState->Camera.ThirdPersonRadius = 5.0f;
+        GameState->Camera.IsThirdPerson = true;
+
+        //
+        // NOTE: Startup pipeline stage 2, take the models in order and start decoding each one's textures (once per
+        // path, unless the asset registry has it loaded already) as soon as it's imported
+        //
+        stretchy_array<startup_texture_decode *> TextureDecodes =
+            StretchyArray<startup_texture_decode *>(&GameState->TransientArena, 64);
+
+        for (u32 EntityType = EntityType_None + 1;
+             EntityType < EntityType_Count;
+             ++EntityType)
+        {
+            entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
+
+            startup_model_import *Import = FindStartupModelImport(Imports, ImportCount, ModelEntryIndices[EntityType]);
+            if (Import && !Import->WasHandedOver)
+            {
+                GameMemory->WaitForJobGroup(GameMemory->JobSystem, &Import->Group);
+                AssetRegistry_SetModel(&GameState->Assets, Import->AssetEntryIndex, Import->Model);
+                Import->WasHandedOver = true;
+            }
+
+            Spec->ImportedModel = AssetRegistry_GetModel(&GameState->Assets, ModelEntryIndices[EntityType]);
+            if (FindEarlierSpecWithModel(GameState->EntityTypeSpecs, EntityType))
+            {
+                continue;
+            }
+
+            imported_model *ImportedModel = Spec->ImportedModel;
+            for (u32 MaterialPerModelIndex = 1;
+                 MaterialPerModelIndex < ImportedModel->MaterialCount;
+                 ++MaterialPerModelIndex)
+            {
+                imported_material *ImportedMaterial = ImportedModel->Materials + MaterialPerModelIndex;
+                for (u32 TexturePathIndex = 0;
+                     TexturePathIndex < TEXTURE_TYPE_COUNT;
+                     ++TexturePathIndex)
+                {
+                    string_id Path = ImportedMaterial->TexturePaths[TexturePathIndex];
+                    if (!Path || FindStartupTextureDecode(&TextureDecodes, Path) ||
+                        AssetRegistry_HasTexture(&GameState->Assets, StringID_GetString(Path)))
+                    {
+                        continue;
+                    }
+
+                    startup_texture_decode *Decode = MemoryArena_PushStruct(&GameState->TransientArena, startup_texture_decode);
+                    *Decode = {};
+                    Decode->Path = Path;
+                    StretchyArray_Push(&TextureDecodes, Decode);
+
+                    GameMemory->AddJob(GameMemory->JobSystem, &Decode->Group, DecodeTextureJob, Decode);
+                }
+            }
         }
         
         //
@@ -232,6 +650,10 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
         {
             entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
             imported_model *ImportedModel = Spec->ImportedModel;
+            if (FindEarlierSpecWithModel(GameState->EntityTypeSpecs, EntityType))
+            {
+                continue;
+            }
 
             u32 *MaterialCount;
             u32 *MeshCount;
@@ -306,7 +728,7 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
         }
 
         //
-        // NOTE: Prepare render data from the imported data
+        // NOTE: Startup pipeline stage 3, prepare render data from the imported data and upload it
         //
         for (u32 EntityType = EntityType_None + 1;
              EntityType < EntityType_Count;
@@ -315,6 +737,16 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
             entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
             imported_model *ImportedModel = Spec->ImportedModel;
 
+            entity_type_spec *SpecWithSameModel = FindEarlierSpecWithModel(GameState->EntityTypeSpecs, EntityType);
+            if (SpecWithSameModel)
+            {
+                Spec->RenderUnit = SpecWithSameModel->RenderUnit;
+                Spec->BaseMeshID = SpecWithSameModel->BaseMeshID;
+                Spec->MeshCount = SpecWithSameModel->MeshCount;
+                Spec->BaseMaterialID = SpecWithSameModel->BaseMaterialID;
+                continue;
+            }
+
             render_unit *RenderUnit;
 
             if (ImportedModel->Armature)
@@ -338,17 +770,21 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
                      TexturePathIndex < TEXTURE_TYPE_COUNT;
                      ++TexturePathIndex)
                 {
-                    simple_string Path = ImportedMaterial->TexturePaths[TexturePathIndex];
-                    if (Path.Length > 0)
+                    string_id Path = ImportedMaterial->TexturePaths[TexturePathIndex];
+                    if (Path)
                     {
-                        platform_image LoadImageResult = Platform_LoadImage(Path.D);
+                        // NOTE: No decode means the registry had it loaded before startup
+                        startup_texture_decode *Decode = FindStartupTextureDecode(&TextureDecodes, Path);
+                        if (Decode)
+                        {
+                            GameMemory->WaitForJobGroup(GameMemory->JobSystem, &Decode->Group);
+                        }
 
                         Material->TextureIDs[TexturePathIndex] =
-                            OpenGL_LoadTexture(LoadImageResult.ImageData,
-                                               LoadImageResult.Width, LoadImageResult.Height,
-                                               LoadImageResult.Pitch, LoadImageResult.BytesPerPixel);
-
-                        Platform_FreeImage(&LoadImageResult);
+                            AssetRegistry_AcquireTexture(&GameState->Assets, &GameState->TextureUploads,
+                                                         StringID_GetString(Path),
+                                                         Decode ? Decode->ContentHash : 0, Decode ? Decode->ContentSize : 0,
+                                                         Decode ? &Decode->Texture : 0);
                     }
                 }
             }
@@ -410,17 +846,20 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
             Spec->RenderUnit = RenderUnit;
             Spec->BaseMeshID = RenderUnit->MarkerCount;
             Spec->MeshCount = ImportedModel->MeshCount;
+            Spec->BaseMaterialID = RenderUnit->MaterialCount;
 
             RenderUnit->MaterialCount += ImportedModel->MaterialCount - ((ImportedModel->MaterialCount == 0) ? 0 : 1);
             RenderUnit->MarkerCount += ImportedModel->MeshCount;
         }
 
-        ImmText_InitializeQuickDraw(GameState->ContrailOne,
-                                    5, 5, 2560, 1440,
-                                    Vec3(1), Vec3(),
-                                    &GameState->ImmTextRenderUnit, &GameState->RenderArena);
+        FreeStartupTextureDecodes(&TextureDecodes);
 
-        DD_InitializeQuickDraw(&GameState->DebugDrawRenderUnit);
+        GameMemory->WaitForJobGroup(GameMemory->JobSystem, &CookGroup);
+        MemoryArena_EndTemp(StartupMemory);
+
+        printf("RENDER: %u assets loaded, %u shared\n", GameState->Assets.LoadCount, GameState->Assets.SharedCount);
+
+        InitializeQuickDraw(GameState);
         
         //
         // NOTE: OpenGL init state
@@ -435,6 +874,8 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
         // NOTE: Add entities
         //
         GameState->EntityCount = 0;
+        GameState->FirstFreeEntity = 0;
+        GameState->AnimationStatePool = MemoryPool(&GameState->WorldArena, animation_state, 64);
 
         AddEntity(GameState, EntityType_BoxRoom, Vec3(0), Quat(), Vec3(1));
         AddEntity(GameState, EntityType_BoxRoom, Vec3(20,0,0), Quat(Vec3(0,1,1), ToRadiansF(45)), Vec3(0.5f,1,2));
@@ -492,18 +933,38 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
     {
         if (++GameState->IterationToDebug > COLLISION_ITERATIONS + 1) GameState->IterationToDebug = 0;
     }
+    if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F5))
+    {
+        GameState->ArenaStatsOverlayEnabled = !GameState->ArenaStatsOverlayEnabled;
+    }
+    
+    if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F7))
+    {
+        GameState->FrameStatsOverlayEnabled = !GameState->FrameStatsOverlayEnabled;
+    }
+    if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F12))
+    {
+        ReloadMaterialTextures(GameState, GameMemory);
+    }
     
-    // NOTE: Gameplay keys
+    memory_arena *StatsArenas[] = {
+        &GameState->RootArena,
+        &GameState->WorldArena,
+        &GameState->RenderArena,
+        &GameState->AssetArena,
+        &GameState->TransientArena,
+        &GameState->StringArena,
+        &GameState->UploadArena
+    };
+    if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F6))
+    {
+        b32 Written = ArenaStats_DumpToFile("arena_stats.txt", StatsArenas, ArrayCount(StatsArenas), &GameState->TransientArena);
+        printf("%s\n", Written ? "Arena stats written to arena_stats.txt" : "Could not write arena_stats.txt");
+    }
+    
+    // NOTE: Gameplay keys. Player controls are sampled per sim step, see SampleRequestedPlayerControls
     game_requested_controls *RequestedControls = &GameState->RequestedControls;
 
-    RequestedControls->PlayerForward = Platform_KeyIsDown(GameInput, SDL_SCANCODE_W);
-    RequestedControls->PlayerBackward = Platform_KeyIsDown(GameInput, SDL_SCANCODE_S);
-    RequestedControls->PlayerLeft = Platform_KeyIsDown(GameInput, SDL_SCANCODE_A);
-    RequestedControls->PlayerRight = Platform_KeyIsDown(GameInput, SDL_SCANCODE_D);
-    RequestedControls->PlayerUp = Platform_KeyIsDown(GameInput, SDL_SCANCODE_SPACE);
-    RequestedControls->PlayerDown = Platform_KeyIsDown(GameInput, SDL_SCANCODE_LSHIFT);
-    RequestedControls->PlayerJump = Platform_KeyJustPressed(GameInput, SDL_SCANCODE_SPACE) || Platform_KeyJustPressed(GameInput, SDL_SCANCODE_BACKSPACE);
-    
     RequestedControls->CameraForward = Platform_KeyIsDown(GameInput, SDL_SCANCODE_V);
     RequestedControls->CameraBackward = Platform_KeyIsDown(GameInput, SDL_SCANCODE_C);
     RequestedControls->CameraLeft = Platform_KeyIsDown(GameInput, SDL_SCANCODE_Q);
@@ -548,6 +1009,29 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
     }
         
     entity *Player = GameState->PlayerEntity;
+
+    // NOTE: G spawns an enemy in front of the player, K despawns the one closest to the player. Their slots and
+    // animation states go back to the pools, so spawning and despawning runs in constant memory.
+    if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_G))
+    {
+        if (CanAddEntity(GameState, EntityType_Enemy))
+        {
+            vec3 SpawnP = Player->WorldPosition.P + RotateVecByQuatSlow(Vec3(0, 0, 2.0f), Player->WorldPosition.R);
+            AddEntity(GameState, EntityType_Enemy, SpawnP, Player->WorldPosition.R, Vec3(1));
+        }
+        else
+        {
+            printf("GAME: No room for another enemy\n");
+        }
+    }
+    if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_K))
+    {
+        entity *Enemy = FindClosestEntity(GameState, EntityType_Enemy, Player->WorldPosition.P);
+        if (Enemy)
+        {
+            RemoveEntity(GameState, Enemy);
+        }
+    }
     entity_type_spec *PlayerSpec = GameState->EntityTypeSpecs + EntityType_Player;
 
     if (RequestedControls->CameraIsIndependent)
@@ -566,42 +1050,94 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
             CameraSetOrientation(&GameState->Camera, GameState->CameraYawToResetTo, GameState->CameraPitchToResetTo);
             GameState->CameraWillReset = false;
         }
-        
-        Player->WorldPosition.R = CameraGetYawQuat(&GameState->Camera);
     }
 
-    // NOTE: Entity AI updates
-    // ....
-
-    // NOTE: Process entity movement
-    vec3 PlayerAcceleration = {};
-    if (RequestedControls->PlayerForward) PlayerAcceleration.Z += 1.0f;
-    if (RequestedControls->PlayerBackward) PlayerAcceleration.Z -= 1.0f;
-    if (RequestedControls->PlayerLeft) PlayerAcceleration.X += 1.0f;
-    if (RequestedControls->PlayerRight) PlayerAcceleration.X -= 1.0f;
-    // if (GameState->GravityDisabledTemp)
-    {
-        if (RequestedControls->PlayerDown) PlayerAcceleration.Y -= 1.0f;
-        if (RequestedControls->PlayerUp) PlayerAcceleration.Y += 1.0f;
-    }
-
-    
     vec3 A = Vec3(-5,0.2f,15);
     vec3 B = Vec3(-5,15,15);
     vec3 C = Vec3(-15,0.2f,5);
     DD_DrawTriangle(&GameState->DebugDrawRenderUnit, A, B, C, Vec3(1,0,1));
 
-    EntityIntegrateAndMove(Player, GameState->PlayerEllipsoidDim, PlayerAcceleration, &GameState->PlayerVelocity,
-                           GameState->PlayerSpecAccelerationValue, GameState->PlayerSpecDragValue, GameInput->DeltaTime, IgnoreCollisions,
-                           GameState->Entities);
+    //
+    // NOTE: Fixed step simulation. GameInput->DeltaTime is the measured frame time, gameplay and collision only
+    // ever see SIM_STEP_SECONDS.
+    //
+    GameState->SimAccumulator += GameInput->DeltaTime;
+    u32 SimStepCount = 0;
+    
+    while (GameState->SimAccumulator >= SIM_STEP_SECONDS && SimStepCount < SIM_MAX_STEPS_PER_FRAME)
+    {
+        // NOTE: The sim trails real time by whatever is left in the accumulator, so this is the slice of
+        // real (input) time the step stands for
+        f64 StepStartTime = GameInput->FrameTime - (f64) GameState->SimAccumulator;
+        f64 StepEndTime = StepStartTime + (f64) SIM_STEP_SECONDS;
+        SampleRequestedPlayerControls(GameInput, RequestedControls, StepStartTime, StepEndTime);
+        
+        for (u32 EntityIndex = 0;
+             EntityIndex < GameState->EntityCount;
+             ++EntityIndex)
+        {
+            entity *Entity = GameState->Entities + EntityIndex;
+            Entity->PrevWorldPosition = Entity->WorldPosition;
+        }
+
+        if (!RequestedControls->CameraIsIndependent)
+        {
+            Player->WorldPosition.R = CameraGetYawQuat(&GameState->Camera);
+        }
+
+        // NOTE: Entity AI updates
+        // ....
 
-    CameraSetWorldPosition(&GameState->Camera, Player->WorldPosition.P + Vec3(0, GameState->PlayerEyeHeight,0));
+        // NOTE: Process entity movement
+        vec3 PlayerAcceleration = {};
+        if (RequestedControls->PlayerForward) PlayerAcceleration.Z += 1.0f;
+        if (RequestedControls->PlayerBackward) PlayerAcceleration.Z -= 1.0f;
+        if (RequestedControls->PlayerLeft) PlayerAcceleration.X += 1.0f;
+        if (RequestedControls->PlayerRight) PlayerAcceleration.X -= 1.0f;
+        // if (GameState->GravityDisabledTemp)
+        {
+            if (RequestedControls->PlayerDown) PlayerAcceleration.Y -= 1.0f;
+            if (RequestedControls->PlayerUp) PlayerAcceleration.Y += 1.0f;
+        }
+
+        EntityIntegrateAndMove(Player, GameState->PlayerEllipsoidDim, PlayerAcceleration, &GameState->PlayerVelocity,
+                               GameState->PlayerSpecAccelerationValue, GameState->PlayerSpecDragValue, SIM_STEP_SECONDS, IgnoreCollisions,
+                               GameState->Entities);
+
+        GameState->SimAccumulator -= SIM_STEP_SECONDS;
+        SimStepCount++;
+    }
+
+    if (GameState->SimAccumulator >= SIM_STEP_SECONDS)
+    {
+        // NOTE: Hit the step cap (long hitch, or stopped in the debugger), drop the time we couldn't catch up on
+        GameState->SimAccumulator = 0.0f;
+    }
+    GameState->SimStepsLastFrame = SimStepCount;
+
+    // NOTE: How far real time is into the next sim step. Rendering blends the last two sim states by this much,
+    // so what's on screen lags the simulation by up to one step, but moves smoothly at any frame rate.
+    f32 SimAlpha = GameState->SimAccumulator / SIM_STEP_SECONDS;
+    world_position PlayerRenderPosition = WorldPositionLerp(&Player->PrevWorldPosition, &Player->WorldPosition, SimAlpha);
+
+    CameraSetWorldPosition(&GameState->Camera, PlayerRenderPosition.P + Vec3(0, GameState->PlayerEyeHeight,0));
     
-    DD_DrawEllipsoid(&GameState->DebugDrawRenderUnit, Player->WorldPosition.P + Vec3(0,GameState->PlayerEllipsoidDim.Y,0),
+    DD_DrawEllipsoid(&GameState->DebugDrawRenderUnit, PlayerRenderPosition.P + Vec3(0,GameState->PlayerEllipsoidDim.Y,0),
                      GameState->PlayerEllipsoidDim.X, GameState->PlayerEllipsoidDim.Y,
                      9, 11, Vec3(0,1,0), &GameState->TransientArena);
 
-    ImmText_DrawQuickString(SimpleStringF("Player P = <%0.3f,%0.3f,%0.3f>", Player->WorldPosition.P.X, Player->WorldPosition.P.Y, Player->WorldPosition.P.Z).D);
+    ImmText_DrawQuickStringF("Player P = <%0.3f,%0.3f,%0.3f>", Player->WorldPosition.P.X, Player->WorldPosition.P.Y, Player->WorldPosition.P.Z);
+    ImmText_DrawQuickStringF("Sim steps: %u [alpha=%0.2f]", SimStepCount, SimAlpha);
+
+    if (GameState->ArenaStatsOverlayEnabled)
+    {
+        ArenaStats_DrawOverlay(StatsArenas, ArrayCount(StatsArenas));
+    }
+
+    if (GameState->FrameStatsOverlayEnabled)
+    {
+        FrameStats_DrawOverlay(GameMemory->FrameStats, &GameState->TransientArena);
+    }
 
     if (!GameState->Camera.IsThirdPerson)
     {
@@ -616,7 +1152,7 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
     {
         entity *Entity = GameState->Entities + EntityIndex;
 
-        if (Entity->AnimationState)
+        if (Entity->Type != EntityType_None && Entity->AnimationState)
         {
             f32 DeltaTicks = (f32) (GameInput->DeltaTime * (Entity->AnimationState->Animation->TicksPerSecond));
             Entity->AnimationState->CurrentTicks += DeltaTicks;
@@ -627,13 +1163,51 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
         }
     }
 
+    // NOTE: Skinning transforms for every animated entity are computed on the job system, and picked up by
+    // entity index when the entity is drawn
+    mat4 **EntityBoneTransforms = MemoryArena_PushArrayAndZero(&GameState->TransientArena, GameState->EntityCount, mat4 *);
+    platform_job_group SkinningJobGroup = {};
+    
+    for (u32 EntityIndex = 0;
+         EntityIndex < GameState->EntityCount;
+         ++EntityIndex)
+    {
+        entity *Entity = GameState->Entities + EntityIndex;
+
+        if (Entity->Type != EntityType_None && Entity->AnimationState)
+        {
+            u32 BoneCount = Entity->AnimationState->Armature->BoneCount;
+            EntityBoneTransforms[EntityIndex] = MemoryArena_PushArrayAligned(&GameState->TransientArena,
+                                                                             BoneCount,
+                                                                             mat4, ARENA_ALIGN_SSE);
+
+            skinning_job *Job = MemoryArena_PushStruct(&GameState->TransientArena, skinning_job);
+            Job->AnimationState = Entity->AnimationState;
+            Job->BoneTransforms = EntityBoneTransforms[EntityIndex];
+            GameMemory->AddJob(GameMemory->JobSystem, &SkinningJobGroup, ComputeSkinningTransformsJob, Job);
+        }
+    }
+
     vec3 ViewPosition = CameraGetTruePosition(&GameState->Camera);
-    OpenGL_SetUniformVec3F(GameState->StaticRenderUnit.ShaderID, "ViewPosition", (f32 *) &ViewPosition, true);
-    OpenGL_SetUniformVec3F(GameState->SkinnedRenderUnit.ShaderID, "ViewPosition", (f32 *) &ViewPosition, true);
+    OpenGL_UseShader(GameState->StaticRenderUnit.ShaderID);
+    OpenGL_SetUniformVec3FAt(GameState->StaticRenderUnit.Uniforms.ViewPosition, (f32 *) &ViewPosition);
+    OpenGL_UseShader(GameState->SkinnedRenderUnit.ShaderID);
+    OpenGL_SetUniformVec3FAt(GameState->SkinnedRenderUnit.Uniforms.ViewPosition, (f32 *) &ViewPosition);
+
+    // NOTE: Copying into the PBO happens here so it overlaps the skinning jobs
+    TextureUploadQueue_Pump(&GameState->TextureUploads, TEXTURE_UPLOAD_BYTES_PER_FRAME);
+    GameMemory->IsStreamingAssets = !TextureUploadQueue_IsEmpty(&GameState->TextureUploads);
+
+    GameMemory->WaitForJobGroup(GameMemory->JobSystem, &SkinningJobGroup);
 
     //
     // NOTE: Render
     //
+    if (GameMemory->FrameStats)
+    {
+        FrameStats_Mark(GameMemory->FrameStats, FrameStage_Render, Platform_GetPerformanceCounter());
+    }
+    
     glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -661,10 +1235,10 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
             mat4 ProjectionMat = Mat4GetPerspecitveProjection(70.0f,
                                                               (f32) GameInput->ScreenWidth / (f32) GameInput->ScreenHeight,
                                                               0.1f, 1000.0f);
-            OpenGL_SetUniformMat4F(RenderUnit->ShaderID, "Projection", (f32 *) &ProjectionMat, false);
+            OpenGL_SetUniformMat4FAt(RenderUnit->Uniforms.Projection, (f32 *) &ProjectionMat, 1);
             
             mat4 ViewMat = CameraGetViewMat(&GameState->Camera);
-            OpenGL_SetUniformMat4F(RenderUnit->ShaderID, "View", (f32 *) &ViewMat, false);
+            OpenGL_SetUniformMat4FAt(RenderUnit->Uniforms.View, (f32 *) &ViewMat, 1);
 
             PreviousShaderID = RenderUnit->ShaderID;
         }
@@ -706,7 +1280,7 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
                     }
 
                     for (u32 InstanceSlotIndex = 0;
-                         InstanceSlotIndex < MAX_INSTANCES_PER_MESH;
+                         InstanceSlotIndex < Mesh->InstanceCount;
                          ++InstanceSlotIndex)
                     {
                         entity *Entity = Mesh->EntityInstances[InstanceSlotIndex];
@@ -717,58 +1291,39 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
                                 continue;
                             }
 
-                            mat4 ModelTransform = WorldPositionTransform(&Entity->WorldPosition);
+                            world_position RenderPosition = WorldPositionLerp(&Entity->PrevWorldPosition, &Entity->WorldPosition, SimAlpha);
+                            mat4 ModelTransform = WorldPositionTransform(&RenderPosition);
 
                             if (Entity->AnimationState)
                             {
-                                imported_armature *Armature = Entity->AnimationState->Armature;
                                 u32 BoneCount = Entity->AnimationState->Armature->BoneCount;
-                        
-                                MemoryArena_Freeze(&GameState->RenderArena);
-                                mat4 *BoneTransforms = MemoryArena_PushArray(&GameState->RenderArena,
-                                                                             BoneCount,
-                                                                             mat4);
-                                                                     
-                                ComputeTransformsForAnimation(Entity->AnimationState, BoneTransforms, BoneCount);
-                        
-                                for (u32 BoneIndex = 0;
-                                     BoneIndex < BoneCount;
-                                     ++BoneIndex)
-                                {
-                                    mat4 BoneTransform;
-                            
-                                    if (BoneIndex == 0)
-                                    {
-                                        BoneTransform = Mat4(1.0f);
-                                    }
-                                    else
-                                    {
-                                        BoneTransform = BoneTransforms[BoneIndex] * Armature->Bones[BoneIndex].InverseBindTransform;
-                                    }
-
-                                    simple_string UniformName = SimpleStringF("BoneTransforms[%d]", BoneIndex);
-                                    OpenGL_SetUniformMat4F(RenderUnit->ShaderID, UniformName.D, (f32 *) &BoneTransform, false);
-                                }
-                        
-                                MemoryArena_Unfreeze(&GameState->RenderArena);
+                                mat4 *BoneTransforms = EntityBoneTransforms[Entity - GameState->Entities];
+                                Assert(BoneTransforms);
+
+                                OpenGL_SetUniformMat4FAt(RenderUnit->Uniforms.BoneTransforms, (f32 *) BoneTransforms, BoneCount);
                             }
-                            else
+                            else if (RenderUnit->Uniforms.BoneTransforms != -1)
                             {
                                 // TODO: Handle a skinned model in a rest pose better.
                                 // For now it just clears out all bones in uniforms, or it will keep the values of previous
                                 // skinned models being rendered.
+                                temporary_memory BoneTransformMemory = MemoryArena_BeginTemp(&GameState->TransientArena);
+                                mat4 *BoneTransforms = MemoryArena_PushArrayAligned(&GameState->TransientArena,
+                                                                                    MAX_BONES_PER_MODEL,
+                                                                                    mat4, ARENA_ALIGN_SSE);
                                 for (u32 BoneIndex = 0;
                                      BoneIndex < MAX_BONES_PER_MODEL;
                                      ++BoneIndex)
                                 {
-                                    mat4 BoneTransform = Mat4(1.0f);
-
-                                    simple_string UniformName = SimpleStringF("BoneTransforms[%d]", BoneIndex);
-                                    OpenGL_SetUniformMat4F(RenderUnit->ShaderID, UniformName.D, (f32 *) &BoneTransform, false);
+                                    BoneTransforms[BoneIndex] = Mat4(1.0f);
                                 }
+
+                                OpenGL_SetUniformMat4FAt(RenderUnit->Uniforms.BoneTransforms, (f32 *) BoneTransforms, MAX_BONES_PER_MODEL);
+                                
+                                MemoryArena_EndTemp(BoneTransformMemory);
                             }
                             
-                            OpenGL_SetUniformMat4F(RenderUnit->ShaderID, "Model", (f32 *) &ModelTransform, false);
+                            OpenGL_SetUniformMat4FAt(RenderUnit->Uniforms.Model, (f32 *) &ModelTransform, 1);
                             // TODO: Should I treat indices as unsigned everywhere?
                             // TODO: Instanced draw?
                             glDrawElementsBaseVertex(GL_TRIANGLES,
@@ -868,10 +1423,22 @@ GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameSho
 
     ImmText_ResetQuickDraw();
     MemoryArena_Reset(&GameState->TransientArena);
+
+    for (u32 ArenaIndex = 0;
+         ArenaIndex < ArrayCount(StatsArenas);
+         ++ArenaIndex)
+    {
+        MemoryArena_EndFrameStats(StatsArenas[ArenaIndex]);
+    }
 }
 
 #include "opusone_camera.cpp"
+#if OPUSONE_INTERNAL
 #include "opusone_assimp.cpp"
+#endif
+#include "opusone_cooked_model.cpp"
+#include "opusone_cooked_texture.cpp"
+#include "opusone_asset_registry.cpp"
 #include "opusone_render.cpp"
 #include "opusone_animation.cpp"
 #include "opusone_immtext.cpp"
@@ -2,16 +2,24 @@
 #define OPUSONE_H
 
 #include "opusone_common.h"
+#include "opusone_string_id.h"
 #include "opusone_math.h"
 #include "opusone_linmath.h"
 #include "opusone_camera.h"
 #include "opusone_assimp.h"
+#include "opusone_asset_registry.h"
 #include "opusone_render.h"
 #include "opusone_animation.h"
 #include "opusone_immtext.h"
 #include "opusone_collision.h"
 #include "opusone_entity.h"
 
+// NOTE: Gameplay and collision always advance in steps of this size. Frames run as many steps as the
+// accumulated real time allows, up to the cap; anything beyond the cap is dropped (the game slows down
+// instead of falling further and further behind).
+#define SIM_STEP_SECONDS (1.0f / 120.0f)
+#define SIM_MAX_STEPS_PER_FRAME 8
+
 struct game_requested_controls
 {
     b32 PlayerForward;
@@ -39,9 +47,18 @@ struct game_state
     memory_arena RenderArena;
     memory_arena AssetArena;
     memory_arena TransientArena;
+    memory_arena StringArena;
+    memory_arena UploadArena;
+
+    string_table *StringTable;
+    asset_registry Assets;
+    texture_upload_queue TextureUploads;
 
     game_requested_controls RequestedControls;
 
+    f32 SimAccumulator;
+    u32 SimStepsLastFrame;
+
     camera Camera;
     b32 CameraWillReset;
     f32 CameraYawToResetTo;
@@ -56,6 +73,9 @@ struct game_state
 
     u32 EntityCount;
     entity Entities[100]; // TODO: This should be a bucket array / spatial hash table eventually
+    entity *FirstFreeEntity;
+
+    memory_pool AnimationStatePool;
 
     font_info *ContrailOne;
     font_info *MajorMono;
@@ -78,6 +98,8 @@ struct game_state
     b32 GravityDisabledTemp;
 
     u32 IterationToDebug;
+    b32 ArenaStatsOverlayEnabled;
+    b32 FrameStatsOverlayEnabled;
 };
 
 #endif
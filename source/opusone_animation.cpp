@@ -69,7 +69,7 @@ ComputeTransformsForAnimation(animation_state *AnimationState, mat4 *BoneTransfo
             if (ShouldLog && PrevTimeIndex == 0)
             {
                 printf("[%s]-P-(%d)<%0.3f,%0.3f,%0.3f>:(%d)<%0.3f,%0.3f,%0.3f>[%0.3f]<%0.3f,%0.3f,%0.3f>\n",
-                       Bone->BoneName.D,
+                       StringID_GetString(Bone->BoneName),
                        PrevTimeIndex, PositionA.X, PositionA.Y, PositionA.Z,
                        TimeIndex, PositionB.X, PositionB.Y, PositionB.Z,
                        T, Position.X, Position.Y, Position.Z);
@@ -111,7 +111,7 @@ ComputeTransformsForAnimation(animation_state *AnimationState, mat4 *BoneTransfo
             if (ShouldLog && PrevTimeIndex == 0)
             {
                 printf("[%s]-R-(%d)<%0.3f,%0.3f,%0.3f,%0.3f>:(%d)<%0.3f,%0.3f,%0.3f,%0.3f>[%0.3f]<%0.3f,%0.3f,%0.3f,%0.3f>\n",
-                       Bone->BoneName.D,
+                       StringID_GetString(Bone->BoneName),
                        PrevTimeIndex, RotationA.W, RotationA.X, RotationA.Y, RotationA.Z,
                        TimeIndex, RotationB.W, RotationB.X, RotationB.Y, RotationB.Z,
                        T, Rotation.W, Rotation.X, Rotation.Y, Rotation.Z);
@@ -153,7 +153,7 @@ ComputeTransformsForAnimation(animation_state *AnimationState, mat4 *BoneTransfo
             if (ShouldLog && PrevTimeIndex == 0)
             {
                 printf("[%s]-S-(%d)<%0.3f,%0.3f,%0.3f>:(%d)<%0.3f,%0.3f,%0.3f>[%0.3f]<%0.3f,%0.3f,%0.3f>\n",
-                       Bone->BoneName.D,
+                       StringID_GetString(Bone->BoneName),
                        PrevTimeIndex, ScaleA.X, ScaleA.Y, ScaleA.Z,
                        TimeIndex, ScaleB.X, ScaleB.Y, ScaleB.Z,
                        T, Scale.X, Scale.Y, Scale.Z);
@@ -174,3 +174,27 @@ ComputeTransformsForAnimation(animation_state *AnimationState, mat4 *BoneTransfo
         }
     }
 }
+
+// NOTE: Final transforms for the skinning shader: animated bone transform times the inverse bind pose
+void
+ComputeSkinningTransforms(animation_state *AnimationState, mat4 *BoneTransforms, u32 BoneTransformCount)
+{
+    imported_armature *Armature = AnimationState->Armature;
+
+    ComputeTransformsForAnimation(AnimationState, BoneTransforms, BoneTransformCount);
+
+    BoneTransforms[0] = Mat4(1.0f);
+    for (u32 BoneIndex = 1;
+         BoneIndex < BoneTransformCount;
+         ++BoneIndex)
+    {
+        BoneTransforms[BoneIndex] = BoneTransforms[BoneIndex] * Armature->Bones[BoneIndex].InverseBindTransform;
+    }
+}
+
+void
+ComputeSkinningTransformsJob(void *Data, memory_arena *ScratchArena)
+{
+    skinning_job *Job = (skinning_job *) Data;
+    ComputeSkinningTransforms(Job->AnimationState, Job->BoneTransforms, Job->AnimationState->Armature->BoneCount);
+}
@@ -13,7 +13,20 @@ struct animation_state
     f64 CurrentTicks;
 };
 
+// NOTE: Input for ComputeSkinningTransformsJob, BoneTransforms has Armature->BoneCount entries
+struct skinning_job
+{
+    animation_state *AnimationState;
+    mat4 *BoneTransforms;
+};
+
 void
 ComputeTransformsForAnimation(animation_state *AnimationState, mat4 *BoneTransforms, u32 BoneTransformCount);
 
+void
+ComputeSkinningTransforms(animation_state *AnimationState, mat4 *BoneTransforms, u32 BoneTransformCount);
+
+void
+ComputeSkinningTransformsJob(void *Data, memory_arena *ScratchArena);
+
 #endif
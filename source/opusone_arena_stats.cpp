@@ -0,0 +1,170 @@
+#ifndef OPUSONE_ARENA_STATS_CPP
+#define OPUSONE_ARENA_STATS_CPP
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_immtext.h"
+
+#define ARENA_STATS_TOP_TAG_COUNT 8
+
+internal f32
+ArenaStats_ToMegabytes(size_t Bytes)
+{
+    f32 Result = (f32) ((f64) Bytes / (f64) Megabytes(1));
+    return Result;
+}
+
+#if OPUSONE_INTERNAL
+// NOTE: Tags carry the full __FILE__ path (/FC on MSVC), only the file name and line are interesting
+internal const char *
+ArenaStats_GetTagFileName(const char *Tag)
+{
+    const char *Result = Tag;
+    for (const char *Cursor = Tag; *Cursor; ++Cursor)
+    {
+        if (*Cursor == '/' || *Cursor == '\\')
+        {
+            Result = Cursor + 1;
+        }
+    }
+    return Result;
+}
+
+// NOTE: Picks the tags with the most bytes pushed, biggest first. Returns how many were found.
+internal u32
+ArenaStats_GetTopTags(arena_tag_stats **TopTags, u32 MaxCount)
+{
+    u32 Count = 0;
+
+    for (u32 SlotIndex = 0;
+         SlotIndex < ARENA_TAG_STATS_COUNT;
+         ++SlotIndex)
+    {
+        arena_tag_stats *Stats = GlobalArenaTagStats + SlotIndex;
+        if (!Stats->Tag)
+        {
+            continue;
+        }
+
+        u32 InsertIndex = Count;
+        while (InsertIndex > 0 && TopTags[InsertIndex - 1]->TotalBytes < Stats->TotalBytes)
+        {
+            if (InsertIndex < MaxCount)
+            {
+                TopTags[InsertIndex] = TopTags[InsertIndex - 1];
+            }
+            InsertIndex--;
+        }
+
+        if (InsertIndex < MaxCount)
+        {
+            TopTags[InsertIndex] = Stats;
+            if (Count < MaxCount) Count++;
+        }
+    }
+
+    return Count;
+}
+
+internal simple_string
+ArenaStats_FormatArena(memory_arena *Arena)
+{
+    simple_string Result = SimpleStringF("%-9s %8.2f/%8.2f MB peak %8.2f frame %8.2f commit %8.2f | %llu (+%llu)",
+                                         Arena->DebugName ? Arena->DebugName : "?",
+                                         ArenaStats_ToMegabytes(Arena->Used),
+                                         ArenaStats_ToMegabytes(Arena->Size),
+                                         ArenaStats_ToMegabytes(Arena->PeakUsed),
+                                         ArenaStats_ToMegabytes(Arena->LastFramePeakUsed),
+                                         ArenaStats_ToMegabytes(Arena->CommittedSize),
+                                         (unsigned long long) Arena->PushCount, (unsigned long long) Arena->LastFramePushCount);
+    return Result;
+}
+
+internal simple_string
+ArenaStats_FormatTag(arena_tag_stats *Stats)
+{
+    simple_string Result = SimpleStringF("  %-9s %8.2f MB %8llu pushes  %s",
+                                         Stats->ArenaName ? Stats->ArenaName : "?",
+                                         ArenaStats_ToMegabytes(Stats->TotalBytes),
+                                         (unsigned long long) Stats->PushCount,
+                                         ArenaStats_GetTagFileName(Stats->Tag));
+    return Result;
+}
+#endif
+
+void
+ArenaStats_DrawOverlay(memory_arena **Arenas, u32 ArenaCount)
+{
+#if OPUSONE_INTERNAL
+    for (u32 ArenaIndex = 0;
+         ArenaIndex < ArenaCount;
+         ++ArenaIndex)
+    {
+        ImmText_DrawQuickString(ArenaStats_FormatArena(Arenas[ArenaIndex]).D);
+    }
+
+    arena_tag_stats *TopTags[ARENA_STATS_TOP_TAG_COUNT];
+    u32 TopTagCount = ArenaStats_GetTopTags(TopTags, ARENA_STATS_TOP_TAG_COUNT);
+    for (u32 TagIndex = 0;
+         TagIndex < TopTagCount;
+         ++TagIndex)
+    {
+        ImmText_DrawQuickString(ArenaStats_FormatTag(TopTags[TagIndex]).D);
+    }
+#else
+    ImmText_DrawQuickString("Arena stats are only collected in OPUSONE_INTERNAL builds");
+#endif
+}
+
+// NOTE: Writes the arena summary and every recorded tag to a text file. The text is built in ScratchArena.
+b32
+ArenaStats_DumpToFile(const char *Path, memory_arena **Arenas, u32 ArenaCount, memory_arena *ScratchArena)
+{
+    b32 Result = false;
+
+#if OPUSONE_INTERNAL
+    temporary_memory DumpMemory = MemoryArena_BeginTemp(ScratchArena);
+
+    // NOTE: One extra line for the tag of the buffer push itself, which may be new
+    u32 LineCount = ArenaCount + GlobalArenaTagStatsUsed + 1;
+    char *Buffer = (char *) MemoryArena_PushBytes(ScratchArena, (size_t) LineCount * SIMPLE_STRING_SIZE);
+    size_t BufferUsed = 0;
+
+    for (u32 SlotIndex = 0;
+         SlotIndex < (ArenaCount + ARENA_TAG_STATS_COUNT);
+         ++SlotIndex)
+    {
+        simple_string Line;
+        if (SlotIndex < ArenaCount)
+        {
+            Line = ArenaStats_FormatArena(Arenas[SlotIndex]);
+        }
+        else
+        {
+            arena_tag_stats *Stats = GlobalArenaTagStats + (SlotIndex - ArenaCount);
+            if (!Stats->Tag)
+            {
+                continue;
+            }
+            Line = ArenaStats_FormatTag(Stats);
+        }
+
+        Assert(BufferUsed + Line.Length + 1 <= (size_t) LineCount * SIMPLE_STRING_SIZE);
+        for (u32 CharIndex = 0;
+             CharIndex < Line.Length;
+             ++CharIndex)
+        {
+            Buffer[BufferUsed++] = Line.D[CharIndex];
+        }
+        Buffer[BufferUsed++] = '\n';
+    }
+
+    Result = Platform_WriteFile(Path, Buffer, BufferUsed);
+
+    MemoryArena_EndTemp(DumpMemory);
+#endif
+
+    return Result;
+}
+
+#endif
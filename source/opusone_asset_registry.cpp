@@ -0,0 +1,239 @@
+#include "opusone_asset_registry.h"
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_string_id.h"
+#include "opusone_assimp.h"
+#include "opusone_render.h"
+
+#include <glad/glad.h>
+
+asset_registry
+AssetRegistry(memory_arena *Arena, u32 ExpectedCount)
+{
+    asset_registry Result = {};
+
+    Result.Entries = StretchyArray<asset_entry>(Arena, ExpectedCount);
+    Result.EntryIndicesByPath = HashMap<string_id, u32>(Arena, ExpectedCount);
+    Result.TextureIndicesByContentHash = HashMap<u64, u32>(Arena, ExpectedCount);
+
+    return Result;
+}
+
+// NOTE: Backslashes become slashes, and empty, "." and "dir/.." segments are dropped, so the different ways the
+// importer and the game spell a path end up as one key. Doesn't look at the file system, links stay separate.
+internal string_id
+AssetRegistry_CanonicalPath_(const char *Path)
+{
+    char Canonical[256];
+    u32 SegmentStarts[64];
+    u32 SegmentCount = 0;
+    u32 Length = 0;
+
+    b32 IsAbsolute = (Path[0] == '/' || Path[0] == '\\');
+    if (IsAbsolute)
+    {
+        Canonical[Length++] = '/';
+    }
+
+    const char *Cursor = Path;
+    while (*Cursor)
+    {
+        while (*Cursor == '/' || *Cursor == '\\')
+        {
+            Cursor++;
+        }
+
+        const char *Segment = Cursor;
+        while (*Cursor && *Cursor != '/' && *Cursor != '\\')
+        {
+            Cursor++;
+        }
+        u32 SegmentLength = (u32) (Cursor - Segment);
+
+        if (SegmentLength == 0 || (SegmentLength == 1 && Segment[0] == '.'))
+        {
+            continue;
+        }
+
+        if (SegmentLength == 2 && Segment[0] == '.' && Segment[1] == '.')
+        {
+            b32 PreviousIsParent = false;
+            if (SegmentCount > 0)
+            {
+                u32 PreviousStart = SegmentStarts[SegmentCount - 1];
+                const char *Previous = Canonical + PreviousStart + ((Canonical[PreviousStart] == '/') ? 1 : 0);
+                PreviousIsParent = (Previous + 2 == Canonical + Length && Previous[0] == '.' && Previous[1] == '.');
+            }
+
+            if (SegmentCount > 0 && !PreviousIsParent)
+            {
+                Length = SegmentStarts[--SegmentCount];
+                continue;
+            }
+            if (IsAbsolute)
+            {
+                // NOTE: Nothing above the root
+                continue;
+            }
+        }
+
+        // NOTE: Segments start at their leading slash (if any), so dropping one takes the slash along
+        Assert(SegmentCount < ArrayCount(SegmentStarts));
+        Assert(Length + 1 + SegmentLength < sizeof(Canonical));
+        SegmentStarts[SegmentCount++] = Length;
+        if (Length > 0 && Canonical[Length - 1] != '/')
+        {
+            Canonical[Length++] = '/';
+        }
+        MemoryCopy(Canonical + Length, Segment, SegmentLength);
+        Length += SegmentLength;
+    }
+
+    Canonical[Length] = '\0';
+
+    string_id Result = StringID(Canonical);
+    return Result;
+}
+
+internal asset_entry *
+AssetRegistry_FindEntry_(asset_registry *Registry, string_id CanonicalPath)
+{
+    u32 *EntryIndex = HashMap_Find(&Registry->EntryIndicesByPath, CanonicalPath);
+    asset_entry *Result = EntryIndex ? (Registry->Entries.D + *EntryIndex) : 0;
+    return Result;
+}
+
+internal u32
+AssetRegistry_AddEntry_(asset_registry *Registry, asset_type Type, string_id CanonicalPath)
+{
+    asset_entry Entry = {};
+    Entry.Type = Type;
+    Entry.Path = CanonicalPath;
+
+    u32 EntryIndex = Registry->Entries.Count;
+    StretchyArray_Push(&Registry->Entries, Entry);
+    HashMap_Set(&Registry->EntryIndicesByPath, CanonicalPath, EntryIndex);
+    return EntryIndex;
+}
+
+u32
+AssetRegistry_AcquireModelEntry(asset_registry *Registry, const char *Path, b32 *Out_NeedsLoad)
+{
+    string_id CanonicalPath = AssetRegistry_CanonicalPath_(Path);
+    u32 *Found = HashMap_Find(&Registry->EntryIndicesByPath, CanonicalPath);
+
+    u32 EntryIndex;
+    if (Found)
+    {
+        EntryIndex = *Found;
+        Assert(Registry->Entries.D[EntryIndex].Type == ASSET_TYPE_MODEL);
+        Registry->SharedCount++;
+        *Out_NeedsLoad = false;
+    }
+    else
+    {
+        EntryIndex = AssetRegistry_AddEntry_(Registry, ASSET_TYPE_MODEL, CanonicalPath);
+        Registry->LoadCount++;
+        *Out_NeedsLoad = true;
+    }
+
+    Registry->Entries.D[EntryIndex].RefCount++;
+    return EntryIndex;
+}
+
+void
+AssetRegistry_SetModel(asset_registry *Registry, u32 EntryIndex, imported_model *Model)
+{
+    asset_entry *Entry = Registry->Entries.D + EntryIndex;
+    Assert(Entry->Type == ASSET_TYPE_MODEL && !Entry->Model);
+    Entry->Model = Model;
+}
+
+imported_model *
+AssetRegistry_GetModel(asset_registry *Registry, u32 EntryIndex)
+{
+    asset_entry *Entry = Registry->Entries.D + EntryIndex;
+    Assert(Entry->Type == ASSET_TYPE_MODEL && Entry->Model);
+    return Entry->Model;
+}
+
+b32
+AssetRegistry_HasTexture(asset_registry *Registry, const char *Path)
+{
+    asset_entry *Entry = AssetRegistry_FindEntry_(Registry, AssetRegistry_CanonicalPath_(Path));
+    b32 Result = (Entry && Entry->TextureID);
+    return Result;
+}
+
+u32
+AssetRegistry_AcquireTexture(asset_registry *Registry, texture_upload_queue *Uploads, const char *Path,
+                             u64 ContentHash, size_t ContentSize, texture_data *Texture)
+{
+    string_id CanonicalPath = AssetRegistry_CanonicalPath_(Path);
+    asset_entry *Entry = AssetRegistry_FindEntry_(Registry, CanonicalPath);
+
+    if (!Entry || !Entry->TextureID)
+    {
+        Assert(Texture);
+
+        u32 *SameContentIndex = HashMap_Find(&Registry->TextureIndicesByContentHash, ContentHash);
+        asset_entry *SameContent = SameContentIndex ? (Registry->Entries.D + *SameContentIndex) : 0;
+        if (SameContent && SameContent->TextureID && SameContent->ContentSize == ContentSize)
+        {
+            // NOTE: Another path to a file that's already loaded, this path shares its entry from now on
+            HashMap_Set(&Registry->EntryIndicesByPath, CanonicalPath, *SameContentIndex);
+            Entry = SameContent;
+        }
+        else
+        {
+            if (!Entry)
+            {
+                u32 EntryIndex = AssetRegistry_AddEntry_(Registry, ASSET_TYPE_TEXTURE, CanonicalPath);
+                Entry = Registry->Entries.D + EntryIndex;
+            }
+            Assert(Entry->Type == ASSET_TYPE_TEXTURE);
+
+            Entry->TextureID = TextureUploadQueue_Push(Uploads, Texture);
+            Entry->ContentHash = ContentHash;
+            Entry->ContentSize = ContentSize;
+            HashMap_Set(&Registry->TextureIndicesByContentHash, ContentHash, (u32) (Entry - Registry->Entries.D));
+            Registry->LoadCount++;
+
+            Entry->RefCount++;
+            return Entry->TextureID;
+        }
+    }
+
+    Assert(Entry->Type == ASSET_TYPE_TEXTURE);
+    Registry->SharedCount++;
+    Entry->RefCount++;
+    return Entry->TextureID;
+}
+
+void
+AssetRegistry_ReleaseTexture(asset_registry *Registry, texture_upload_queue *Uploads, u32 TextureID)
+{
+    Assert(TextureID);
+
+    for (u32 EntryIndex = 0;
+         EntryIndex < Registry->Entries.Count;
+         ++EntryIndex)
+    {
+        asset_entry *Entry = Registry->Entries.D + EntryIndex;
+        if (Entry->Type == ASSET_TYPE_TEXTURE && Entry->TextureID == TextureID)
+        {
+            Assert(Entry->RefCount > 0);
+            if (--Entry->RefCount == 0)
+            {
+                // NOTE: The entry and its path mappings stay, acquiring it again reloads it
+                TextureUploadQueue_Cancel(Uploads, Entry->TextureID);
+                glDeleteTextures(1, &Entry->TextureID);
+                Entry->TextureID = 0;
+            }
+            return;
+        }
+    }
+
+    InvalidCodePath;
+}
@@ -0,0 +1,80 @@
+#ifndef OPUSONE_ASSET_REGISTRY_H
+#define OPUSONE_ASSET_REGISTRY_H
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_containers.h"
+#include "opusone_string_id.h"
+#include "opusone_assimp.h"
+#include "opusone_render.h"
+
+// NOTE: Every model and texture the game loads goes through here, so one that's used more than once is loaded once
+// and shared, with a reference count per asset.
+//
+// Assets are keyed by their canonical path (see AssetRegistry_CanonicalPath_). Textures are also keyed by a hash
+// of their file contents, so the same image copied into two model directories is decoded and uploaded once.
+// Models aren't, a gltf's contents reference its .bin and textures by relative path, so equal contents in
+// different directories aren't the same model.
+enum asset_type
+{
+    ASSET_TYPE_NONE,
+    ASSET_TYPE_MODEL,
+    ASSET_TYPE_TEXTURE
+};
+
+struct asset_entry
+{
+    asset_type Type;
+    string_id Path; // NOTE: Canonical path it was first loaded from, others can map to it by content
+    u32 RefCount; // NOTE: Models are never released (see AssetRegistry_AcquireModelEntry), theirs only counts users
+
+    imported_model *Model; // NOTE: 0 while a deferred load is running, see AssetRegistry_AcquireModelEntry
+
+    u32 TextureID; // NOTE: 0 while the texture isn't loaded (never was, or all references were released)
+    u64 ContentHash;
+    size_t ContentSize;
+};
+
+struct asset_registry
+{
+    stretchy_array<asset_entry> Entries;
+    hash_map<string_id, u32> EntryIndicesByPath;
+    hash_map<u64, u32> TextureIndicesByContentHash;
+
+    u32 LoadCount;
+    u32 SharedCount; // NOTE: Acquires that got an asset that was already loaded
+};
+
+asset_registry
+AssetRegistry(memory_arena *Arena, u32 ExpectedCount);
+
+// NOTE: Models are loaded on the job system (the registry itself is main thread only). The first acquire of a path
+// sets Out_NeedsLoad, the caller loads the model and hands it over with SetModel before anything gets the entry's
+// model. Models live in the asset arena, which can't free them, so they stay loaded for the whole run and have no
+// release.
+// TODO: Release them once assets get their own allocator.
+u32
+AssetRegistry_AcquireModelEntry(asset_registry *Registry, const char *Path, b32 *Out_NeedsLoad);
+
+void
+AssetRegistry_SetModel(asset_registry *Registry, u32 EntryIndex, imported_model *Model);
+
+imported_model *
+AssetRegistry_GetModel(asset_registry *Registry, u32 EntryIndex);
+
+// NOTE: Textures are read and decoded on the job system (see the startup pipeline in GameUpdateAndRender) and
+// acquired with the result, this queues its upload unless the path or the file contents are loaded already (the
+// ID is valid right away, see texture_upload_queue). Check HasTexture first to skip decoding the paths that are
+// loaded, for those Texture is ignored and can be 0.
+b32
+AssetRegistry_HasTexture(asset_registry *Registry, const char *Path);
+
+u32
+AssetRegistry_AcquireTexture(asset_registry *Registry, texture_upload_queue *Uploads, const char *Path,
+                             u64 ContentHash, size_t ContentSize, texture_data *Texture);
+
+// NOTE: Takes the upload queue to cancel the upload if it's still pending
+void
+AssetRegistry_ReleaseTexture(asset_registry *Registry, texture_upload_queue *Uploads, u32 TextureID);
+
+#endif
@@ -7,6 +7,8 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <cstdio>
+
 internal inline vec2
 Assimp_ConvertVec2F(aiVector3D AssimpVec)
 {
@@ -85,10 +87,18 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                                               aiProcess_FlipUVs |
                                               aiProcess_RemoveRedundantMaterials);
 
-    // TODO: Handle these errors
-    Assert(AssimpScene);
-    Assert(!(AssimpScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE));
-    Assert(AssimpScene->mRootNode);
+    // NOTE: Models Assimp can't import (or that have nothing to draw) fail, the rest of the asserts below are
+    // about our own bookkeeping
+    if (!AssimpScene || (AssimpScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !AssimpScene->mRootNode ||
+        AssimpScene->mNumMeshes == 0)
+    {
+        printf("ASSIMP: Could not import %s: %s\n", Path, AssimpScene ? "incomplete or empty scene" : aiGetErrorString());
+        if (AssimpScene)
+        {
+            aiReleaseImport(AssimpScene);
+        }
+        return 0;
+    }
 
     imported_model *Model = MemoryArena_PushStruct(AssetArena, imported_model);
 
@@ -138,7 +148,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                         // TODO: Even if paths longer 128 chars are uncommon, this is definitely something
                         // to make more robust in shipping code
                         Assert(TexturePath.Length != (TexturePath.BufferSize - 1));
-                        Material->TexturePaths[TextureType] = TexturePath;
+                        Material->TexturePaths[TextureType] = StringID(TexturePath.D);
                     }
                 }
             }
@@ -155,12 +165,18 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
     {
         // TODO: See if this needs to handle more bones
         u32 MaxBoneCount = MAX_BONES_PER_MODEL;
-        Assert(BoneCount < MaxBoneCount);
+        if (BoneCount >= MaxBoneCount)
+        {
+            printf("ASSIMP: Could not import %s: %u bones, at most %u are supported\n", Path, BoneCount, MaxBoneCount - 1);
+            aiReleaseImport(AssimpScene);
+            return 0;
+        }
 
         Model->Armature = MemoryArena_PushStruct(AssetArena, imported_armature);
         Model->Armature->BoneCount = BoneCount + 1;
         // TODO: Should I keep bones in a graph instead of converting to a flat list at this point?
         Model->Armature->Bones = MemoryArena_PushArray(AssetArena, Model->Armature->BoneCount, imported_bone);
+        Model->Armature->BoneIDsByName = HashMap<string_id, u32>(AssetArena, Model->Armature->BoneCount);
         imported_bone ZeroBone {};
         for (u32 BoneIndex = 0;
              BoneIndex < Model->Armature->BoneCount;
@@ -169,7 +185,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
             Model->Armature->Bones[BoneIndex] = ZeroBone;
         }
 
-        MemoryArena_Freeze(AssetArena);
+        temporary_memory BoneQueueMemory = MemoryArena_BeginTemp(AssetArena);
         
         aiNode **NodeQueue = MemoryArena_PushArray(AssetArena, MaxBoneCount, aiNode *);
         u32 *ParentIDHelperQueue = MemoryArena_PushArray(AssetArena, MaxBoneCount, u32);
@@ -193,11 +209,12 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
 
             if (CurrentBoneIndex == 0)
             {
-                CurrentBone->BoneName = SimpleString("DummyBone");
+                CurrentBone->BoneName = StringID("DummyBone");
             }
             else
             {
-                CurrentBone->BoneName = SimpleString(CurrentNode->mName.C_Str());
+                CurrentBone->BoneName = StringID(CurrentNode->mName.C_Str());
+                HashMap_Set(&Model->Armature->BoneIDsByName, CurrentBone->BoneName, CurrentBoneIndex);
             }
 
             CurrentBone->ID = CurrentBoneIndex;
@@ -218,7 +235,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
         }
         Assert(CurrentBoneIndex == Model->Armature->BoneCount);
 
-        MemoryArena_Unfreeze(AssetArena);
+        MemoryArena_EndTemp(BoneQueueMemory);
     }
     
     //
@@ -226,7 +243,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
     //
     Model->MeshCount = AssimpScene->mNumMeshes;
     Model->Meshes = MemoryArena_PushArray(AssetArena, Model->MeshCount, imported_mesh);
-    Assert(Model->MeshCount > 0); // TODO: Handle mesh count 0 for shipping code -> just abort loading the model
+    Assert(Model->MeshCount > 0);
     for (u32 MeshIndex = 0;
          MeshIndex < Model->MeshCount;
          ++MeshIndex)
@@ -241,22 +258,19 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
         // NOTE: Vertex data
         //
         Mesh->VertexCount = AssimpMesh->mNumVertices;
-        Mesh->VertexPositions = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vec3);
-        Mesh->VertexTangents = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vec3);
-        Mesh->VertexBitangents = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vec3);
-        Mesh->VertexNormals = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vec3);
-        for (u32 VertexIndex = 0;
-             VertexIndex < Mesh->VertexCount;
-             ++VertexIndex)
-        {
-            Mesh->VertexPositions[VertexIndex] = Assimp_ConvertVec3F(AssimpMesh->mVertices[VertexIndex]);
-            Mesh->VertexTangents[VertexIndex] = Assimp_ConvertVec3F(AssimpMesh->mTangents[VertexIndex]);
-            Mesh->VertexBitangents[VertexIndex] = Assimp_ConvertVec3F(AssimpMesh->mBitangents[VertexIndex]);
-            Mesh->VertexNormals[VertexIndex] = Assimp_ConvertVec3F(AssimpMesh->mNormals[VertexIndex]);
-        }
+        Mesh->VertexPositions = MemoryArena_PushArrayAligned(AssetArena, Mesh->VertexCount, vec3, ARENA_ALIGN_AVX);
+        Mesh->VertexTangents = MemoryArena_PushArrayAligned(AssetArena, Mesh->VertexCount, vec3, ARENA_ALIGN_AVX);
+        Mesh->VertexBitangents = MemoryArena_PushArrayAligned(AssetArena, Mesh->VertexCount, vec3, ARENA_ALIGN_AVX);
+        Mesh->VertexNormals = MemoryArena_PushArrayAligned(AssetArena, Mesh->VertexCount, vec3, ARENA_ALIGN_AVX);
+        // NOTE: aiVector3D is 3 packed floats (no ASSIMP_DOUBLE_PRECISION), so the streams are copied in bulk
+        static_assert(sizeof(aiVector3D) == sizeof(vec3), "aiVector3D layout doesn't match vec3");
+        MemoryCopyArray(Mesh->VertexPositions, AssimpMesh->mVertices, Mesh->VertexCount, vec3);
+        MemoryCopyArray(Mesh->VertexTangents, AssimpMesh->mTangents, Mesh->VertexCount, vec3);
+        MemoryCopyArray(Mesh->VertexBitangents, AssimpMesh->mBitangents, Mesh->VertexCount, vec3);
+        MemoryCopyArray(Mesh->VertexNormals, AssimpMesh->mNormals, Mesh->VertexCount, vec3);
         if (AssimpMesh->mTextureCoords[0])
         {
-            Mesh->VertexUVs = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vec2);
+            Mesh->VertexUVs = MemoryArena_PushArrayAligned(AssetArena, Mesh->VertexCount, vec2, ARENA_ALIGN_AVX);
             for (u32 VertexIndex = 0;
                  VertexIndex < Mesh->VertexCount;
                  ++VertexIndex)
@@ -266,13 +280,9 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
         }
         if (AssimpMesh->mColors[0])
         {
-            Mesh->VertexColors = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vec4);
-            for (u32 VertexIndex = 0;
-                 VertexIndex < Mesh->VertexCount;
-                 ++VertexIndex)
-            {
-                Mesh->VertexColors[VertexIndex] = Assimp_ConvertColor4F(AssimpMesh->mColors[0][VertexIndex]);
-            }
+            Mesh->VertexColors = MemoryArena_PushArrayAligned(AssetArena, Mesh->VertexCount, vec4, ARENA_ALIGN_AVX);
+            static_assert(sizeof(aiColor4D) == sizeof(vec4), "aiColor4D layout doesn't match vec4");
+            MemoryCopyArray(Mesh->VertexColors, AssimpMesh->mColors[0], Mesh->VertexCount, vec4);
         }
 
         //
@@ -307,17 +317,8 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
         //
         if (Model->Armature)
         {
-            Mesh->VertexBoneIDs = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vert_bone_ids);
-            Mesh->VertexBoneWeights = MemoryArena_PushArray(AssetArena, Mesh->VertexCount, vert_bone_weights);
-            vert_bone_ids ZeroBoneIDs {};
-            vert_bone_weights ZeroBoneWeights {};
-            for (u32 VertexIndex = 0;
-                 VertexIndex < Mesh->VertexCount;
-                 ++VertexIndex)
-            {
-                Mesh->VertexBoneIDs[VertexIndex] = ZeroBoneIDs;
-                Mesh->VertexBoneWeights[VertexIndex] = ZeroBoneWeights;
-            }
+            Mesh->VertexBoneIDs = MemoryArena_PushArrayAndZero(AssetArena, Mesh->VertexCount, vert_bone_ids);
+            Mesh->VertexBoneWeights = MemoryArena_PushArrayAndZero(AssetArena, Mesh->VertexCount, vert_bone_weights);
             
             for (u32 AssimpBoneIndex = 0;
                  AssimpBoneIndex < AssimpMesh->mNumBones;
@@ -326,20 +327,9 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                 aiBone *AssimpBone = AssimpMesh->mBones[AssimpBoneIndex];
 
                 // NOTE: Find the bone with the corresponding name among the bones that are already saved in Model->Armature
-                u32 BoneID = 0;
-                b32 BoneFound = false;
-                for (u32 SearchBoneIndex = 0;
-                     SearchBoneIndex < Model->Armature->BoneCount;
-                     ++SearchBoneIndex)
-                {
-                    if (CompareStrings(Model->Armature->Bones[SearchBoneIndex].BoneName.D, AssimpBone->mName.C_Str()))
-                    {
-                        BoneID = SearchBoneIndex;
-                        BoneFound = true;
-                        break;
-                    }
-                }
-                Assert(BoneFound);
+                u32 *FoundBoneID = HashMap_Find(&Model->Armature->BoneIDsByName, StringID_Find(AssimpBone->mName.C_Str()));
+                Assert(FoundBoneID);
+                u32 BoneID = *FoundBoneID;
 
                 Model->Armature->Bones[BoneID].InverseBindTransform = Assimp_ConvertMat4F(AssimpBone->mOffsetMatrix);
 
@@ -393,7 +383,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                 Animation->Channels = MemoryArena_PushArray(AssetArena, Animation->ChannelCount, imported_animation_channel);
                 Animation->TicksDuration = AssimpAnimation->mDuration;
                 Animation->TicksPerSecond = AssimpAnimation->mTicksPerSecond;
-                Animation->AnimationName = SimpleString(AssimpAnimation->mName.C_Str());
+                Animation->AnimationName = StringID(AssimpAnimation->mName.C_Str());
 
                 imported_animation_channel ZeroChannel {};
                 Animation->Channels[0] = ZeroChannel;
@@ -404,17 +394,8 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                 {
                     aiNodeAnim *AssimpChannel = AssimpAnimation->mChannels[ChannelIndex-1];
 
-                    u32 BoneID = 0;
-                    for (u32 BoneSearchIndex = 1;
-                         BoneSearchIndex < Model->Armature->BoneCount;
-                         ++BoneSearchIndex)
-                    {
-                        if (CompareStrings(Model->Armature->Bones[BoneSearchIndex].BoneName.D, AssimpChannel->mNodeName.C_Str()))
-                        {
-                            BoneID = BoneSearchIndex;
-                            break;
-                        }
-                    }
+                    u32 *FoundBoneID = HashMap_Find(&Model->Armature->BoneIDsByName, StringID_Find(AssimpChannel->mNodeName.C_Str()));
+                    u32 BoneID = FoundBoneID ? *FoundBoneID : 0;
                     Assert(BoneID > 0);
 
                     imported_animation_channel *Channel = Animation->Channels + BoneID;
@@ -422,7 +403,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                     Channel->BoneID = BoneID;
                     
                     Channel->PositionKeyCount = AssimpChannel->mNumPositionKeys;
-                    Channel->PositionKeys = MemoryArena_PushArray(AssetArena, Channel->PositionKeyCount, vec3);
+                    Channel->PositionKeys = MemoryArena_PushArrayAligned(AssetArena, Channel->PositionKeyCount, vec3, ARENA_ALIGN_SSE);
                     Channel->PositionKeyTimes = MemoryArena_PushArray(AssetArena, Channel->PositionKeyCount, f64);
                     for (u32 PositionKeyIndex = 0;
                          PositionKeyIndex < Channel->PositionKeyCount;
@@ -452,7 +433,7 @@ Assimp_LoadModel(memory_arena *AssetArena, const char *Path)
                     }
 
                     Channel->ScaleKeyCount = AssimpChannel->mNumScalingKeys;
-                    Channel->ScaleKeys = MemoryArena_PushArray(AssetArena, Channel->ScaleKeyCount, vec3);
+                    Channel->ScaleKeys = MemoryArena_PushArrayAligned(AssetArena, Channel->ScaleKeyCount, vec3, ARENA_ALIGN_SSE);
                     Channel->ScaleKeyTimes = MemoryArena_PushArray(AssetArena, Channel->ScaleKeyCount, f64);
                     for (u32 ScaleKeyIndex = 0;
                          ScaleKeyIndex < Channel->ScaleKeyCount;
@@ -3,6 +3,8 @@
 
 #include "opusone_common.h"
 #include "opusone_linmath.h"
+#include "opusone_containers.h"
+#include "opusone_string_id.h"
 
 enum texture_type
 {
@@ -15,7 +17,7 @@ enum texture_type
 
 struct imported_material
 {
-    simple_string TexturePaths[TEXTURE_TYPE_COUNT];
+    string_id TexturePaths[TEXTURE_TYPE_COUNT];
 };
 
 #define MAX_BONES_PER_MODEL 128
@@ -28,8 +30,7 @@ struct imported_bone
     u32 ChildrenIDs[MAX_BONE_CHILDREN];
     u32 ChildrenCount;
 
-    // TODO: Hash table to find bones instead of this?
-    simple_string BoneName;
+    string_id BoneName;
     // TODO: Save this in decomposed state?
     mat4 TransformToParent;
     // TODO: This is in mesh space, but I apply transforms to all objects in Blender,
@@ -71,6 +72,9 @@ struct imported_armature
 {
     u32 BoneCount;
     imported_bone *Bones;
+
+    // NOTE: The dummy bone 0 isn't in the map
+    hash_map<string_id, u32> BoneIDsByName;
 };
 
 struct imported_animation_channel
@@ -105,7 +109,7 @@ struct imported_animation
     f64 TicksDuration;
     f64 TicksPerSecond;
     
-    simple_string AnimationName;
+    string_id AnimationName;
 };
 
 struct imported_model
@@ -120,6 +124,7 @@ struct imported_model
     imported_animation *Animations;
 };
 
+// NOTE: Returns 0 if Assimp can't import the model, what's pushed to AssetArena by then is the caller's to pop
 imported_model *
 Assimp_LoadModel(memory_arena *AssetArena, const char *Path);
 
@@ -3,8 +3,75 @@
 #include "opusone.h"
 #include "opusone_common.h"
 #include "opusone_linmath.h"
+#include "opusone_containers.h"
 #include "opusone_debug_draw.cpp"
 
+// NOTE: AreVecEqual is an absolute FLT_EPSILON compare. Bucketing vectors into FLT_EPSILON sized cells means that
+// everything equal to a vector is in its cell or in one of the 26 neighbours, and that two vectors in the same cell
+// are always equal to each other. So a set of unique vectors needs at most one index per cell.
+struct vec3_cell
+{
+    i64 X, Y, Z;
+};
+
+inline b32
+operator==(vec3_cell A, vec3_cell B)
+{
+    return (A.X == B.X && A.Y == B.Y && A.Z == B.Z);
+}
+
+inline u32
+HashKey(vec3_cell Key)
+{
+    u32 Result = HashU64((u64) Key.X ^ ((u64) HashU64((u64) Key.Y) << 32) ^ (u64) HashU64((u64) Key.Z * 31));
+    return Result;
+}
+
+internal vec3_cell
+GetVec3Cell(vec3 Vector)
+{
+    vec3_cell Result;
+    Result.X = (i64) floor((f64) Vector.X / (f64) FLT_EPSILON);
+    Result.Y = (i64) floor((f64) Vector.Y / (f64) FLT_EPSILON);
+    Result.Z = (i64) floor((f64) Vector.Z / (f64) FLT_EPSILON);
+    return Result;
+}
+
+// NOTE: Finds the first vector (lowest index) in UniqueVectors that is AreVecEqual to Vector
+internal b32
+FindEqualVec3(hash_map<vec3_cell, u32> *Cells, vec3 *UniqueVectors, vec3 Vector, u32 *Out_Index)
+{
+    vec3_cell Cell = GetVec3Cell(Vector);
+    b32 Found = false;
+    
+    for (i64 OffsetZ = -1; OffsetZ <= 1; ++OffsetZ)
+    {
+        for (i64 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+        {
+            for (i64 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+            {
+                vec3_cell TestCell = { Cell.X + OffsetX, Cell.Y + OffsetY, Cell.Z + OffsetZ };
+                u32 *Index = HashMap_Find(Cells, TestCell);
+                if (Index && (!Found || *Index < *Out_Index) && AreVecEqual(UniqueVectors[*Index], Vector))
+                {
+                    *Out_Index = *Index;
+                    Found = true;
+                }
+            }
+        }
+    }
+
+    return Found;
+}
+
+internal void
+AddUniqueVec3(hash_map<vec3_cell, u32> *Cells, vec3 Vector, u32 Index)
+{
+    b32 WasAdded;
+    *HashMap_FindOrAdd(Cells, GetVec3Cell(Vector), &WasAdded) = Index;
+    Assert(WasAdded);
+}
+
 b32
 ValidateEdgesUnique(memory_arena *TransientArena, edge *Edges, u32 EdgeCount)
 {
@@ -45,7 +112,7 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
     Assert(ImportedIndexCount % 3 == 0);
     Assert(Out_Polyhedron);
 
-    MemoryArena_Freeze(TransientArena);
+    temporary_memory ScratchMemory = MemoryArena_BeginTemp(TransientArena);
     
     polyhedron *Polyhedron = Out_Polyhedron;
     *Polyhedron = {};
@@ -53,35 +120,26 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
     //
     // NOTE: 1. Deduplicate vertices and save into polyhedron vertex storage.
     //
-    Polyhedron->Vertices = MemoryArena_PushArray(Arena, ImportedVertexCount, vec3);
+    Polyhedron->Vertices = MemoryArena_PushArrayAligned(Arena, ImportedVertexCount, vec3, ARENA_ALIGN_AVX);
     u32 PolyhedronVertexCount = 0;
 
     // NOTE: Store the indices of polyhedron vertices in the original order (and duplication) to be able to use ImportedIndices.
     u32 *PolyhedronVertexIndices = MemoryArena_PushArray(TransientArena, ImportedVertexCount, u32);
 
+    hash_map<vec3_cell, u32> VertexCells = HashMap<vec3_cell, u32>(TransientArena, ImportedVertexCount);
+
     for (u32 ImportedVertexIndex = 0;
          ImportedVertexIndex < ImportedVertexCount;
          ++ImportedVertexIndex)
     {
         vec3 *ImportedVertex = ImportedVertices + ImportedVertexIndex;
 
-        b32 DuplicateFound = false;
-        for (u32 PolyhedronVertexIndex = 0;
-             PolyhedronVertexIndex < PolyhedronVertexCount;
-             ++PolyhedronVertexIndex)
-        {
-            vec3 *PolyhedronVertex = Polyhedron->Vertices + PolyhedronVertexIndex;
-            
-            if (AreVecEqual(*ImportedVertex, *PolyhedronVertex))
-            {
-                PolyhedronVertexIndices[ImportedVertexIndex] = PolyhedronVertexIndex;
-                DuplicateFound = true;
-                break;
-            }
-        }
+        b32 DuplicateFound = FindEqualVec3(&VertexCells, Polyhedron->Vertices, *ImportedVertex,
+                                           PolyhedronVertexIndices + ImportedVertexIndex);
 
         if (!DuplicateFound)
         {
+            AddUniqueVec3(&VertexCells, *ImportedVertex, PolyhedronVertexCount);
             Polyhedron->Vertices[PolyhedronVertexCount] = *ImportedVertex;
             PolyhedronVertexIndices[ImportedVertexIndex] = PolyhedronVertexCount;
             ++PolyhedronVertexCount;
@@ -110,10 +168,12 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
         temp_edge *Next;
     };
 
-    vec3 *UniqueNormals = MemoryArena_PushArray(TransientArena, TriangleCount, vec3);
+    vec3 *UniqueNormals = MemoryArena_PushArrayAligned(TransientArena, TriangleCount, vec3, ARENA_ALIGN_AVX);
     temp_edge *TempEdgeHeads = MemoryArena_PushArray(TransientArena, TriangleCount, temp_edge);
     i32 *EdgePerNormalCounts = MemoryArena_PushArray(TransientArena, TriangleCount, i32);
 
+    hash_map<vec3_cell, u32> NormalCells = HashMap<vec3_cell, u32>(TransientArena, TriangleCount);
+
     u32 UniqueNormalCount = 0;
     for (u32 TriangleIndex = 0;
          TriangleIndex < TriangleCount;
@@ -139,14 +199,9 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
                                        { TriCPolyhedronIndex, TriAPolyhedronIndex } };
             
         u32 SearchTriangleIndex;
-        for (SearchTriangleIndex = 0;
-             SearchTriangleIndex < UniqueNormalCount;
-             ++SearchTriangleIndex)
+        if (!FindEqualVec3(&NormalCells, UniqueNormals, Normal, &SearchTriangleIndex))
         {
-            if (AreVecEqual(UniqueNormals[SearchTriangleIndex], Normal))
-            {
-                break;
-            }
+            SearchTriangleIndex = UniqueNormalCount;
         }
 
         b32 NewEdgeList = false;
@@ -157,6 +212,7 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
             *TempEdgeHead = {};
             EdgePerNormalCounts[SearchTriangleIndex] = 0;
             UniqueNormals[SearchTriangleIndex] = Normal;
+            AddUniqueVec3(&NormalCells, Normal, SearchTriangleIndex);
             ++UniqueNormalCount;
             
             NewEdgeList = true;
@@ -221,7 +277,7 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
     // NOTE: 3. Copy (polyhedron) unique edges into polyhedron storage.
     // Save pointers to the polyhedron edge storage in the temp edges, to preserve the link between polygons and edges.
     //
-    Polyhedron->Edges = MemoryArena_PushArray(Arena, TriangleCount * 3, edge);
+    Polyhedron->Edges = MemoryArena_PushArrayAligned(Arena, TriangleCount * 3, edge, ARENA_ALIGN_AVX);
 
     u32 PolyhedronEdgeCount = 0;
     for (u32 UniqueNormalIndex = 0;
@@ -346,7 +402,7 @@ ComputePolyhedronFromVertices(memory_arena *Arena, memory_arena *TransientArena,
         MemoryArena_ResizePreviousPushArray(Arena, Face->VertexCount, u32);
     }
 
-    MemoryArena_Unfreeze(TransientArena);
+    MemoryArena_EndTemp(ScratchMemory);
 }
 
 polyhedron_set *
@@ -365,22 +421,12 @@ CopyPolyhedronSet(memory_arena *Arena, polyhedron_set *Original)
         polyhedron *CopiedPolyhedron = Copy->Polyhedra + PolyhedronIndex;
         
         CopiedPolyhedron->VertexCount = OriginalPolyhedron->VertexCount;
-        CopiedPolyhedron->Vertices = MemoryArena_PushArray(Arena, CopiedPolyhedron->VertexCount, vec3);
-        for(u32 VertexIndex = 0;
-            VertexIndex < CopiedPolyhedron->VertexCount;
-            ++VertexIndex)
-        {
-            CopiedPolyhedron->Vertices[VertexIndex] = OriginalPolyhedron->Vertices[VertexIndex];
-        }
+        CopiedPolyhedron->Vertices = MemoryArena_PushArrayAligned(Arena, CopiedPolyhedron->VertexCount, vec3, ARENA_ALIGN_AVX);
+        MemoryCopyArray(CopiedPolyhedron->Vertices, OriginalPolyhedron->Vertices, CopiedPolyhedron->VertexCount, vec3);
         
         CopiedPolyhedron->EdgeCount = OriginalPolyhedron->EdgeCount;
-        CopiedPolyhedron->Edges = MemoryArena_PushArray(Arena, CopiedPolyhedron->EdgeCount, edge);
-        for(u32 EdgeIndex = 0;
-            EdgeIndex < CopiedPolyhedron->EdgeCount;
-            ++EdgeIndex)
-        {
-            CopiedPolyhedron->Edges[EdgeIndex] = OriginalPolyhedron->Edges[EdgeIndex];
-        }
+        CopiedPolyhedron->Edges = MemoryArena_PushArrayAligned(Arena, CopiedPolyhedron->EdgeCount, edge, ARENA_ALIGN_AVX);
+        MemoryCopyArray(CopiedPolyhedron->Edges, OriginalPolyhedron->Edges, CopiedPolyhedron->EdgeCount, edge);
         
         CopiedPolyhedron->FaceCount = OriginalPolyhedron->FaceCount;
         CopiedPolyhedron->Faces = MemoryArena_PushArray(Arena, CopiedPolyhedron->FaceCount, polygon);
@@ -394,20 +440,10 @@ CopyPolyhedronSet(memory_arena *Arena, polyhedron_set *Original)
             CopiedFace->Plane = OriginalFace->Plane;
             CopiedFace->EdgeCount = OriginalFace->EdgeCount;
             CopiedFace->EdgeIndices = MemoryArena_PushArray(Arena, CopiedFace->EdgeCount, u32);
-            for (u32 EdgeIndexIndex = 0;
-                 EdgeIndexIndex < CopiedFace->EdgeCount;
-                 ++EdgeIndexIndex)
-            {
-                CopiedFace->EdgeIndices[EdgeIndexIndex] = OriginalFace->EdgeIndices[EdgeIndexIndex];
-            }
+            MemoryCopyArray(CopiedFace->EdgeIndices, OriginalFace->EdgeIndices, CopiedFace->EdgeCount, u32);
             CopiedFace->VertexCount = OriginalFace->VertexCount;
             CopiedFace->VertexIndices = MemoryArena_PushArray(Arena, CopiedFace->VertexCount, u32);
-            for (u32 VertexIndexIndex = 0;
-                 VertexIndexIndex < CopiedFace->VertexCount;
-                 ++VertexIndexIndex)
-            {
-                CopiedFace->VertexIndices[VertexIndexIndex] = OriginalFace->VertexIndices[VertexIndexIndex];
-            }
+            MemoryCopyArray(CopiedFace->VertexIndices, OriginalFace->VertexIndices, CopiedFace->VertexCount, u32);
         }
     }
 
@@ -992,7 +1028,7 @@ CheckCollisionsForEntity(game_state *GameState, entity *Entity, vec3 EntityTrans
          ++EntityIndex)
     {
         entity *TestEntity = GameState->Entities + EntityIndex;
-        if (TestEntity != Entity)
+        if (TestEntity != Entity && TestEntity->Type != EntityType_None)
         {
             entity_type_spec *TestSpec = GameState->EntityTypeSpecs + TestEntity->Type;
 
@@ -1005,6 +1041,7 @@ CheckCollisionsForEntity(game_state *GameState, entity *Entity, vec3 EntityTrans
 
                 case COLLISION_TYPE_POLYHEDRON_SET:
                 {
+                    temporary_memory PolyhedronSetMemory = MemoryArena_BeginTemp(&GameState->TransientArena);
                     polyhedron_set *PolyhedronSet = CopyAndTransformPolyhedronSet(&GameState->TransientArena,
                                                                                   &TestSpec->CollisionGeometry->PolyhedronSet,
                                                                                   TestEntity->WorldPosition.P,
@@ -1054,6 +1091,8 @@ CheckCollisionsForEntity(game_state *GameState, entity *Entity, vec3 EntityTrans
                             }
                         }
                     }
+
+                    MemoryArena_EndTemp(PolyhedronSetMemory);
                 } break;
                 
                 case COLLISION_TYPE_AABB:
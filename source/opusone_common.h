@@ -2,6 +2,7 @@
 #define OPUSONE_COMMON_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 typedef int8_t   i8;
 typedef int16_t  i16;
@@ -22,11 +23,23 @@ typedef i32      b32;
 #define local_persist static
 #define internal static
 
+// NOTE: Internal builds carry the debug-only instrumentation (arena telemetry etc.). build.bat defines this.
+#ifndef OPUSONE_INTERNAL
+#define OPUSONE_INTERNAL 0
+#endif
+
 #define Assert(Expression) if (!(Expression)) { *(int *) 0 = 0; }
 #define InvalidCodePath Assert(!"Invalid Code Path")
 #define Noop { volatile int X = 0; }
+#if defined(_MSC_VER)
 void __debugbreak(); // usually in <intrin.h>
 #define Breakpoint __debugbreak()
+#else
+#define Breakpoint __builtin_trap()
+#endif
+
+#define Stringify_(X) #X
+#define Stringify(X) Stringify_(X)
 
 #define ArrayCount(Array) (sizeof((Array)) / (sizeof((Array)[0])))
 
@@ -116,25 +129,276 @@ SimpleString(const char *String, u32 StartIndex, u32 Count)
     return Result;
 }
 
-#include <cstdio>
 #include <cstdarg>
 
+//
+// NOTE: printf-style formatting without the CRT (no locale, no _s variants, no stdio).
+// Supports %d %i %u %x %X %c %s %f %p %%, the '-' and '0' flags, width, precision (floats and strings),
+// and the l/ll/z length modifiers. Floats are rounded to the precision (default 6) in f64.
+//
+struct format_dest
+{
+    char *At;
+    char *End; // NOTE: Last writable char, one is always kept for the terminator
+    size_t Length; // NOTE: Full length of the output, even past the end of the buffer
+};
+
+inline void
+FormatPutChar_(format_dest *Dest, char C)
+{
+    if (Dest->At < Dest->End)
+    {
+        *Dest->At++ = C;
+    }
+    Dest->Length++;
+}
+
+inline void
+FormatPutPadded_(format_dest *Dest, const char *Chars, size_t Count, i32 Width, b32 LeftAlign, char PadChar)
+{
+    i32 Padding = Width - (i32) Count;
+
+    if (!LeftAlign && PadChar == '0' && Count > 0 && (Chars[0] == '-' || Chars[0] == '+'))
+    {
+        // NOTE: Zero padding goes after the sign
+        FormatPutChar_(Dest, *Chars++);
+        Count--;
+    }
+    
+    if (!LeftAlign)
+    {
+        for (i32 PadIndex = 0; PadIndex < Padding; ++PadIndex) FormatPutChar_(Dest, PadChar);
+    }
+    for (size_t CharIndex = 0; CharIndex < Count; ++CharIndex) FormatPutChar_(Dest, Chars[CharIndex]);
+    if (LeftAlign)
+    {
+        for (i32 PadIndex = 0; PadIndex < Padding; ++PadIndex) FormatPutChar_(Dest, ' ');
+    }
+}
+
+// NOTE: Writes digits backwards from the end of Scratch and returns where they start
+inline char *
+FormatU64_(u64 Value, u32 Base, b32 UpperCase, char *ScratchEnd)
+{
+    const char *Digits = UpperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *At = ScratchEnd;
+    do
+    {
+        *--At = Digits[Value % Base];
+        Value /= Base;
+    } while (Value);
+    return At;
+}
+
+inline size_t
+FormatF64_(f64 Value, u32 Precision, char *Scratch, size_t ScratchSize)
+{
+    char *At = Scratch;
+    char *End = Scratch + ScratchSize;
+    
+    if (Value != Value)
+    {
+        *At++ = 'n'; *At++ = 'a'; *At++ = 'n';
+        return At - Scratch;
+    }
+    
+    if (Value < 0 || (Value == 0 && 1.0 / Value < 0))
+    {
+        *At++ = '-';
+        Value = -Value;
+    }
+
+    if (Value > 1.8e19)
+    {
+        // NOTE: Doesn't fit the u64 integer part. Out of range for anything on a HUD, so don't bother with %e.
+        *At++ = 'i'; *At++ = 'n'; *At++ = 'f';
+        return At - Scratch;
+    }
+
+    Precision = Min(Precision, 9u);
+    u64 Scale = 1;
+    for (u32 Digit = 0; Digit < Precision; ++Digit) Scale *= 10;
+    
+    u64 IntegerPart = (u64) Value;
+    u64 FractionPart = (u64) ((Value - (f64) IntegerPart) * (f64) Scale + 0.5);
+    if (FractionPart >= Scale)
+    {
+        IntegerPart++;
+        FractionPart -= Scale;
+    }
+
+    char Digits[24];
+    char *DigitsEnd = Digits + sizeof(Digits);
+    for (char *Digit = FormatU64_(IntegerPart, 10, false, DigitsEnd); Digit < DigitsEnd && At < End; ++Digit)
+    {
+        *At++ = *Digit;
+    }
+
+    if (Precision > 0 && At < End)
+    {
+        *At++ = '.';
+        char *FractionDigits = FormatU64_(FractionPart, 10, false, DigitsEnd);
+        for (u32 Zero = (u32) (DigitsEnd - FractionDigits); Zero < Precision && At < End; ++Zero)
+        {
+            *At++ = '0';
+        }
+        for (char *Digit = FractionDigits; Digit < DigitsEnd && At < End; ++Digit)
+        {
+            *At++ = *Digit;
+        }
+    }
+
+    return At - Scratch;
+}
+
+// NOTE: Always terminates Buffer (when BufferSize > 0). Returns the length the full output would have had,
+// so a result >= BufferSize means it was truncated.
+inline size_t
+FormatStringList(char *Buffer, size_t BufferSize, const char *Format, va_list VarArgs)
+{
+    format_dest Dest = {};
+    Dest.At = Buffer;
+    Dest.End = BufferSize ? (Buffer + BufferSize - 1) : Buffer;
+
+    const char *F = Format;
+    while (*F)
+    {
+        if (*F != '%')
+        {
+            FormatPutChar_(&Dest, *F++);
+            continue;
+        }
+        F++;
+
+        b32 LeftAlign = false;
+        char PadChar = ' ';
+        for (;; ++F)
+        {
+            if (*F == '-') LeftAlign = true;
+            else if (*F == '0') PadChar = '0';
+            else break;
+        }
+
+        i32 Width = 0;
+        while (*F >= '0' && *F <= '9') Width = Width * 10 + (*F++ - '0');
+
+        i32 Precision = -1;
+        if (*F == '.')
+        {
+            F++;
+            Precision = 0;
+            while (*F >= '0' && *F <= '9') Precision = Precision * 10 + (*F++ - '0');
+        }
+
+        u32 LongCount = 0;
+        while (*F == 'l' || *F == 'z')
+        {
+            LongCount += (*F == 'z') ? 2 : 1;
+            F++;
+        }
+
+        char Scratch[64];
+        char *ScratchEnd = Scratch + sizeof(Scratch);
+        
+        switch (*F)
+        {
+            case 'd':
+            case 'i':
+            {
+                i64 Value = (LongCount >= 2) ? va_arg(VarArgs, i64) : (LongCount == 1) ? va_arg(VarArgs, long) : va_arg(VarArgs, i32);
+                u64 Magnitude = (Value < 0) ? (0 - (u64) Value) : (u64) Value;
+                char *Digits = FormatU64_(Magnitude, 10, false, ScratchEnd);
+                if (Value < 0) *--Digits = '-';
+                FormatPutPadded_(&Dest, Digits, ScratchEnd - Digits, Width, LeftAlign, PadChar);
+            } break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            {
+                u64 Value = (LongCount >= 2) ? va_arg(VarArgs, u64) : (LongCount == 1) ? va_arg(VarArgs, unsigned long) : va_arg(VarArgs, u32);
+                char *Digits = FormatU64_(Value, (*F == 'u') ? 10 : 16, (*F == 'X'), ScratchEnd);
+                FormatPutPadded_(&Dest, Digits, ScratchEnd - Digits, Width, LeftAlign, PadChar);
+            } break;
+
+            case 'p':
+            {
+                u64 Value = (u64) (size_t) va_arg(VarArgs, void *);
+                char *Digits = FormatU64_(Value, 16, false, ScratchEnd);
+                *--Digits = 'x';
+                *--Digits = '0';
+                FormatPutPadded_(&Dest, Digits, ScratchEnd - Digits, Width, LeftAlign, ' ');
+            } break;
+
+            case 'f':
+            {
+                // NOTE: floats are promoted to double through varargs
+                f64 Value = va_arg(VarArgs, f64);
+                size_t Count = FormatF64_(Value, (Precision < 0) ? 6 : (u32) Precision, Scratch, sizeof(Scratch));
+                FormatPutPadded_(&Dest, Scratch, Count, Width, LeftAlign, PadChar);
+            } break;
+
+            case 'c':
+            {
+                char C = (char) va_arg(VarArgs, i32);
+                FormatPutPadded_(&Dest, &C, 1, Width, LeftAlign, ' ');
+            } break;
+
+            case 's':
+            {
+                const char *String = va_arg(VarArgs, const char *);
+                if (!String) String = "(null)";
+                size_t Count = 0;
+                while (String[Count] && (Precision < 0 || Count < (size_t) Precision)) Count++;
+                FormatPutPadded_(&Dest, String, Count, Width, LeftAlign, ' ');
+            } break;
+
+            case '%':
+            {
+                FormatPutChar_(&Dest, '%');
+            } break;
+
+            default:
+            {
+                // NOTE: Unsupported specifier, don't know what to pull out of the varargs, so stop here
+                InvalidCodePath;
+                F--;
+            } break;
+        }
+        F++;
+    }
+
+    if (BufferSize)
+    {
+        *Dest.At = '\0';
+    }
+
+    return Dest.Length;
+}
+
+inline size_t
+FormatString(char *Buffer, size_t BufferSize, const char *Format, ...)
+{
+    va_list VarArgs;
+    va_start(VarArgs, Format);
+    size_t Result = FormatStringList(Buffer, BufferSize, Format, VarArgs);
+    va_end(VarArgs);
+
+    return Result;
+}
+
+// NOTE: Truncates to SIMPLE_STRING_SIZE - 1 chars. Use MemoryArena_PushStringF for anything that can be longer.
 inline simple_string
 SimpleStringF(const char *Format, ...)
 {
-    char TempBuf[SIMPLE_STRING_SIZE];
+    simple_string Result = {};
 
-    // TODO: Don't use stdio and stdargs for this
     va_list VarArgs;
     va_start(VarArgs, Format);
-    i32 SprintfResult = vsprintf_s(TempBuf, SIMPLE_STRING_SIZE - 1, Format, VarArgs);
+    size_t Length = FormatStringList(Result.D, Result.BufferSize, Format, VarArgs);
     va_end(VarArgs);
-    
-    Assert(SprintfResult > 0);
-    Assert(SprintfResult < SIMPLE_STRING_SIZE - 1);
-    TempBuf[SprintfResult] = '\0';
 
-    simple_string Result = SimpleString(TempBuf);
+    Result.Length = (u32) Min(Length, (size_t) (Result.BufferSize - 1));
     return Result;
 }
 
@@ -223,7 +487,7 @@ CatStrings(const char *A, const char *B)
     simple_string Result {};
 
     u32 StringIndex = 0;
-    for (StringIndex;
+    for (;
          StringIndex < (Result.BufferSize - 1);
          ++StringIndex)
     {
@@ -272,14 +536,260 @@ CompareStrings(const char *A, const char *B)
     return (B[Index] == '\0');
 }
 
+//
+// NOTE: Bulk memory primitives
+//
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MEMORY_SIMD_WIDTH 32
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MEMORY_SIMD_WIDTH 16
+#else
+#define MEMORY_SIMD_WIDTH 0
+#endif
+
+// NOTE: Blocks this big won't be read back soon enough to be worth keeping in cache, so they are written with
+// non-temporal (streaming) stores that bypass it.
+#define MEMORY_NON_TEMPORAL_THRESHOLD Kilobytes(512)
+
+inline void
+MemoryFill(void *Dest, u8 Value, size_t Size)
+{
+    u8 *DestByte = (u8 *) Dest;
+
+#if MEMORY_SIMD_WIDTH
+    // NOTE: Scalar head up to the first vector-aligned address, so all the wide stores are aligned
+    while (Size && ((size_t) DestByte & (MEMORY_SIMD_WIDTH - 1)))
+    {
+        *DestByte++ = Value;
+        Size--;
+    }
+
+    size_t WideCount = Size / MEMORY_SIMD_WIDTH;
+    b32 NonTemporal = (Size >= MEMORY_NON_TEMPORAL_THRESHOLD);
+    
+#if MEMORY_SIMD_WIDTH == 32
+    __m256i Wide = _mm256_set1_epi8((char) Value);
+    for (size_t WideIndex = 0; WideIndex < WideCount; ++WideIndex)
+    {
+        if (NonTemporal) _mm256_stream_si256((__m256i *) DestByte, Wide);
+        else _mm256_store_si256((__m256i *) DestByte, Wide);
+        DestByte += MEMORY_SIMD_WIDTH;
+    }
+#else
+    __m128i Wide = _mm_set1_epi8((char) Value);
+    for (size_t WideIndex = 0; WideIndex < WideCount; ++WideIndex)
+    {
+        if (NonTemporal) _mm_stream_si128((__m128i *) DestByte, Wide);
+        else _mm_store_si128((__m128i *) DestByte, Wide);
+        DestByte += MEMORY_SIMD_WIDTH;
+    }
+#endif
+
+    if (NonTemporal)
+    {
+        // NOTE: Streaming stores are weakly ordered, fence so they're visible before anything written after
+        _mm_sfence();
+    }
+    
+    Size -= WideCount * MEMORY_SIMD_WIDTH;
+#endif
+
+    while (Size--)
+    {
+        *DestByte++ = Value;
+    }
+}
+
+inline void
+MemoryZero(void *Dest, size_t Size)
+{
+    MemoryFill(Dest, 0, Size);
+}
+
+// NOTE: Ranges must not overlap
+inline void
+MemoryCopy(void *Dest, const void *Source, size_t Size)
+{
+    u8 *DestByte = (u8 *) Dest;
+    const u8 *SourceByte = (const u8 *) Source;
+
+#if MEMORY_SIMD_WIDTH
+    // NOTE: Align the destination, the source is read unaligned
+    while (Size && ((size_t) DestByte & (MEMORY_SIMD_WIDTH - 1)))
+    {
+        *DestByte++ = *SourceByte++;
+        Size--;
+    }
+
+    size_t WideCount = Size / MEMORY_SIMD_WIDTH;
+    b32 NonTemporal = (Size >= MEMORY_NON_TEMPORAL_THRESHOLD);
+
+#if MEMORY_SIMD_WIDTH == 32
+    for (size_t WideIndex = 0; WideIndex < WideCount; ++WideIndex)
+    {
+        __m256i Wide = _mm256_loadu_si256((const __m256i *) SourceByte);
+        if (NonTemporal) _mm256_stream_si256((__m256i *) DestByte, Wide);
+        else _mm256_store_si256((__m256i *) DestByte, Wide);
+        DestByte += MEMORY_SIMD_WIDTH;
+        SourceByte += MEMORY_SIMD_WIDTH;
+    }
+#else
+    for (size_t WideIndex = 0; WideIndex < WideCount; ++WideIndex)
+    {
+        __m128i Wide = _mm_loadu_si128((const __m128i *) SourceByte);
+        if (NonTemporal) _mm_stream_si128((__m128i *) DestByte, Wide);
+        else _mm_store_si128((__m128i *) DestByte, Wide);
+        DestByte += MEMORY_SIMD_WIDTH;
+        SourceByte += MEMORY_SIMD_WIDTH;
+    }
+#endif
+
+    if (NonTemporal)
+    {
+        _mm_sfence();
+    }
+
+    Size -= WideCount * MEMORY_SIMD_WIDTH;
+#endif
+
+    while (Size--)
+    {
+        *DestByte++ = *SourceByte++;
+    }
+}
+
+#define MemoryCopyArray(Dest, Source, Count, type) MemoryCopy(Dest, Source, (Count) * sizeof(type))
+
+// NOTE: Implemented by the platform layer. Arenas created with MemoryArenaReserved only own address space,
+// and commit pages through this as they grow.
+void
+Platform_CommitMemory(void *Address, size_t Size);
+
+#define ARENA_COMMIT_GRANULARITY Kilobytes(64)
+
 struct memory_arena
 {
     size_t Size;
     u8 *Base;
     size_t Used;
     size_t PrevUsed;
-    size_t FrozenUsed;
-    size_t FrozenPrevUsed;
+    u32 TempCount;
+
+    b32 CommitOnDemand;
+    size_t CommittedSize;
+
+#if OPUSONE_INTERNAL
+    const char *DebugName;
+    size_t PeakUsed;
+    size_t FramePeakUsed;
+    size_t LastFramePeakUsed;
+    u64 PushCount;
+    u64 FramePushCount;
+    u64 LastFramePushCount;
+#endif
+};
+
+#if OPUSONE_INTERNAL
+#include <SDL2/SDL_atomic.h>
+
+// NOTE: Every push is tagged with the call site of the push macro, so the stats can tell which code is allocating.
+// Pushes done inside helpers (e.g. ImmText_DrawString) are attributed to the helper.
+#define ARENA_CALL_SITE (__FILE__ "(" Stringify(__LINE__) ")")
+
+struct arena_tag_stats
+{
+    const char *Tag;
+    const char *ArenaName;
+    u64 PushCount;
+    u64 TotalBytes;
+};
+
+#define ARENA_TAG_STATS_COUNT 512
+global_variable arena_tag_stats GlobalArenaTagStats[ARENA_TAG_STATS_COUNT];
+global_variable u32 GlobalArenaTagStatsUsed;
+global_variable SDL_SpinLock GlobalArenaTagStatsLock; // NOTE: Startup jobs push to named (nested) arenas too
+
+inline void
+MemoryArena_RecordTag_(memory_arena *Arena, const char *Tag, size_t Size)
+{
+    // NOTE: Unnamed arenas (the job system's per-worker scratch arenas) aren't tagged, they'd only add noise
+    if (!Tag || !Arena->DebugName)
+    {
+        return;
+    }
+
+    SDL_AtomicLock(&GlobalArenaTagStatsLock);
+    
+    // NOTE: Tags and arena names are string literals, so pointer identity is enough for the key
+    size_t Hash = (((size_t) Tag) >> 3) * 31 + (((size_t) Arena->DebugName) >> 3);
+    u32 SlotIndex = (u32) (Hash % ARENA_TAG_STATS_COUNT);
+    for (u32 ProbeIndex = 0;
+         ProbeIndex < ARENA_TAG_STATS_COUNT;
+         ++ProbeIndex)
+    {
+        arena_tag_stats *Stats = GlobalArenaTagStats + SlotIndex;
+
+        if (!Stats->Tag)
+        {
+            Stats->Tag = Tag;
+            Stats->ArenaName = Arena->DebugName;
+            GlobalArenaTagStatsUsed++;
+        }
+        
+        if (Stats->Tag == Tag && Stats->ArenaName == Arena->DebugName)
+        {
+            Stats->PushCount++;
+            Stats->TotalBytes += Size;
+            break;
+        }
+        
+        SlotIndex = (SlotIndex + 1) % ARENA_TAG_STATS_COUNT;
+    }
+
+    // NOTE: If the table is full the record is dropped, stats are best effort
+    SDL_AtomicUnlock(&GlobalArenaTagStatsLock);
+}
+
+inline void
+MemoryArena_RecordUsage_(memory_arena *Arena)
+{
+    Arena->PeakUsed = Max(Arena->PeakUsed, Arena->Used);
+    Arena->FramePeakUsed = Max(Arena->FramePeakUsed, Arena->Used);
+}
+#else
+#define ARENA_CALL_SITE 0
+#endif
+
+inline void
+MemoryArena_SetDebugName(memory_arena *Arena, const char *Name)
+{
+#if OPUSONE_INTERNAL
+    Arena->DebugName = Name;
+#endif
+}
+
+// NOTE: Rolls the per-frame counters over. Call once per frame, after the transient arena was reset.
+inline void
+MemoryArena_EndFrameStats(memory_arena *Arena)
+{
+#if OPUSONE_INTERNAL
+    Arena->LastFramePeakUsed = Arena->FramePeakUsed;
+    Arena->FramePeakUsed = Arena->Used;
+    Arena->LastFramePushCount = Arena->FramePushCount;
+    Arena->FramePushCount = 0;
+#endif
+}
+
+// NOTE: A marker into an arena. Everything pushed after MemoryArena_BeginTemp is released by the matching
+// MemoryArena_EndTemp. Markers can be nested arbitrarily, but have to be released in reverse order.
+struct temporary_memory
+{
+    memory_arena *Arena;
+    size_t Used;
+    size_t PrevUsed;
+    u32 Depth;
 };
 
 inline memory_arena
@@ -289,79 +799,352 @@ MemoryArena(u8 *Base, size_t Size)
     
     Arena.Size = Size;
     Arena.Base = Base;
+    Arena.CommittedSize = Size;
+
+    return Arena;
+}
+
+inline memory_arena
+MemoryArenaReserved(u8 *Base, size_t Size)
+{
+    memory_arena Arena = MemoryArena(Base, Size);
+    
+    Arena.CommitOnDemand = true;
+    Arena.CommittedSize = 0;
 
     return Arena;
 }
 
+// NOTE: Explicit alignments for SIMD loads (SSE/AVX) and for keeping hot data on its own cache line
+#define ARENA_ALIGN_SSE 16
+#define ARENA_ALIGN_AVX 32
+#define ARENA_ALIGN_CACHE_LINE 64
+
+inline size_t
+MemoryArena_GetAlignmentPadding(memory_arena *Arena, size_t Alignment)
+{
+    Assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0);
+    
+    size_t AlignmentMask = Alignment - 1;
+    size_t Address = (size_t) (Arena->Base + Arena->Used);
+    size_t Padding = (Address & AlignmentMask) ? (Alignment - (Address & AlignmentMask)) : 0;
+    return Padding;
+}
+
+inline void
+MemoryArena_Commit_(memory_arena *Arena, size_t UsedToCommit)
+{
+    Assert(Arena->CommitOnDemand);
+    
+    size_t NewCommittedSize = ((UsedToCommit + ARENA_COMMIT_GRANULARITY - 1) / ARENA_COMMIT_GRANULARITY) * ARENA_COMMIT_GRANULARITY;
+    NewCommittedSize = Min(NewCommittedSize, Arena->Size);
+    
+    Platform_CommitMemory(Arena->Base + Arena->CommittedSize, NewCommittedSize - Arena->CommittedSize);
+    Arena->CommittedSize = NewCommittedSize;
+}
+
+// NOTE: Moves Used without committing anything. Only for carving out address space for nested reserved arenas.
 inline void *
-MemoryArena_PushSize_(memory_arena *Arena, size_t Size)
+MemoryArena_ReserveSize_(memory_arena *Arena, size_t Size, size_t Alignment, const char *Tag)
 {
-    Assert((Arena->Used + Size) <= Arena->Size);
-    void *Result = Arena->Base + Arena->Used;
-    Arena->PrevUsed = Arena->Used;
-    Arena->Used += Size;
+    size_t Padding = MemoryArena_GetAlignmentPadding(Arena, Alignment);
+    Assert((Arena->Used + Padding + Size) <= Arena->Size);
+    
+    // NOTE: PrevUsed points at the aligned start, not at the padding, so resizing the previous push keeps the alignment
+    Arena->PrevUsed = Arena->Used + Padding;
+    Arena->Used = Arena->PrevUsed + Size;
+    void *Result = Arena->Base + Arena->PrevUsed;
+
+#if OPUSONE_INTERNAL
+    Arena->PushCount++;
+    Arena->FramePushCount++;
+    MemoryArena_RecordUsage_(Arena);
+    MemoryArena_RecordTag_(Arena, Tag, Size);
+#endif
+    
     return Result;
 }
 
 inline void *
-MemoryArena_PushSizeAndZero_(memory_arena *Arena, size_t Size)
+MemoryArena_PushSize_(memory_arena *Arena, size_t Size, size_t Alignment, const char *Tag)
 {
-    void *Base = MemoryArena_PushSize_(Arena, Size);
+    void *Result = MemoryArena_ReserveSize_(Arena, Size, Alignment, Tag);
 
-    u8 *Cursor = (u8 *) Base;
-    for (size_t ByteIndex = 0;
-         ByteIndex < Size;
-         ++ByteIndex)
+    if (Arena->Used > Arena->CommittedSize)
     {
-        *Cursor++ = 0;
+        MemoryArena_Commit_(Arena, Arena->Used);
     }
     
+    return Result;
+}
+
+inline void *
+MemoryArena_PushSizeAndZero_(memory_arena *Arena, size_t Size, size_t Alignment, const char *Tag)
+{
+    void *Base = MemoryArena_PushSize_(Arena, Size, Alignment, Tag);
+
+    MemoryZero(Base, Size);
+    
     return Base;
 }
 
 inline void
 MemoryArena_ResizePreviousPushArray_(memory_arena *Arena, size_t Size)
 {
+    // NOTE: The previous push already starts at its aligned offset, so only the end moves
+    Assert((Arena->PrevUsed + Size) <= Arena->Size);
     Arena->Used = Arena->PrevUsed + Size;
+    
+    if (Arena->Used > Arena->CommittedSize)
+    {
+        MemoryArena_Commit_(Arena, Arena->Used);
+    }
+
+#if OPUSONE_INTERNAL
+    MemoryArena_RecordUsage_(Arena);
+#endif
 }
 
-#define MemoryArena_PushStruct(Arena, type) (type *) MemoryArena_PushSize_(Arena, sizeof(type))
-#define MemoryArena_PushArray(Arena, Count, type) (type *) MemoryArena_PushSize_(Arena, Count * sizeof(type))
-#define MemoryArena_PushBytes(Arena, ByteCount) (u8 *) MemoryArena_PushSize_(Arena, ByteCount)
-#define MemoryArena_PushArrayAndZero(Arena, Count, type) (type *) MemoryArena_PushSizeAndZero_(Arena, Count * sizeof(type))
-#define MemoryArena_ResizePreviousPushArray(Arena, Count, type) MemoryArena_ResizePreviousPushArray_(Arena, Count * sizeof(type))
+#define MemoryArena_PushStruct(Arena, type) (type *) MemoryArena_PushSize_(Arena, sizeof(type), alignof(type), ARENA_CALL_SITE)
+#define MemoryArena_PushArray(Arena, Count, type) (type *) MemoryArena_PushSize_(Arena, (Count) * sizeof(type), alignof(type), ARENA_CALL_SITE)
+#define MemoryArena_PushBytes(Arena, ByteCount) (u8 *) MemoryArena_PushSize_(Arena, ByteCount, 1, ARENA_CALL_SITE)
+#define MemoryArena_PushArrayAndZero(Arena, Count, type) (type *) MemoryArena_PushSizeAndZero_(Arena, (Count) * sizeof(type), alignof(type), ARENA_CALL_SITE)
+#define MemoryArena_ResizePreviousPushArray(Arena, Count, type) MemoryArena_ResizePreviousPushArray_(Arena, (Count) * sizeof(type))
+
+#define MemoryArena_PushStructAligned(Arena, type, Alignment) (type *) MemoryArena_PushSize_(Arena, sizeof(type), Max(Alignment, alignof(type)), ARENA_CALL_SITE)
+#define MemoryArena_PushArrayAligned(Arena, Count, type, Alignment) (type *) MemoryArena_PushSize_(Arena, (Count) * sizeof(type), Max(Alignment, alignof(type)), ARENA_CALL_SITE)
+#define MemoryArena_PushBytesAligned(Arena, ByteCount, Alignment) (u8 *) MemoryArena_PushSize_(Arena, ByteCount, Alignment, ARENA_CALL_SITE)
+#define MemoryArena_PushArrayAndZeroAligned(Arena, Count, type, Alignment) (type *) MemoryArena_PushSizeAndZero_(Arena, (Count) * sizeof(type), Max(Alignment, alignof(type)), ARENA_CALL_SITE)
 
 inline memory_arena
 MemoryArenaNested(memory_arena *Arena, size_t Size)
 {
-    memory_arena NewArena = MemoryArena(MemoryArena_PushBytes(Arena, Size), Size);
+    memory_arena NewArena;
+    
+    if (Arena->CommitOnDemand)
+    {
+        // NOTE: Only hand out the address range, the nested arena commits its own pages as it grows
+        u8 *Base = (u8 *) MemoryArena_ReserveSize_(Arena, Size, ARENA_ALIGN_CACHE_LINE, ARENA_CALL_SITE);
+        NewArena = MemoryArenaReserved(Base, Size);
+    }
+    else
+    {
+        NewArena = MemoryArena(MemoryArena_PushBytesAligned(Arena, Size, ARENA_ALIGN_CACHE_LINE), Size);
+    }
+    
     return NewArena;
 }
 
+inline temporary_memory
+MemoryArena_BeginTemp(memory_arena *Arena)
+{
+    temporary_memory Result = {};
+
+    Result.Arena = Arena;
+    Result.Used = Arena->Used;
+    Result.PrevUsed = Arena->PrevUsed;
+    Result.Depth = Arena->TempCount++;
+
+    return Result;
+}
+
 inline void
-MemoryArena_Freeze(memory_arena *Arena)
+MemoryArena_EndTemp(temporary_memory TempMemory)
 {
-    Assert(Arena->FrozenUsed == 0);
-    Arena->FrozenUsed = Arena->Used;
-    Arena->FrozenPrevUsed = Arena->PrevUsed;
+    memory_arena *Arena = TempMemory.Arena;
+    
+    // NOTE: Catch markers released out of order (an inner scope outliving the outer one),
+    // or an arena that was reset/rewound below the marker while the scope was still open.
+    Assert(Arena->TempCount > 0);
+    Assert(TempMemory.Depth == (Arena->TempCount - 1));
+    Assert(Arena->Used >= TempMemory.Used);
+    
+    Arena->Used = TempMemory.Used;
+    Arena->PrevUsed = TempMemory.PrevUsed;
+    Arena->TempCount--;
 }
 
+// NOTE: Closes the scope but keeps everything pushed in it
 inline void
-MemoryArena_Unfreeze(memory_arena *Arena)
+MemoryArena_KeepTemp(temporary_memory TempMemory)
 {
-    Arena->Used = Arena->FrozenUsed;
-    Arena->PrevUsed = Arena->FrozenPrevUsed;
-    Arena->FrozenUsed = 0;
-    Arena->FrozenPrevUsed = 0;
+    memory_arena *Arena = TempMemory.Arena;
+    Assert(Arena->TempCount > 0);
+    Assert(TempMemory.Depth == (Arena->TempCount - 1));
+    Arena->TempCount--;
+}
+
+inline void
+MemoryArena_CheckTempCleared(memory_arena *Arena)
+{
+    Assert(Arena->TempCount == 0);
 }
 
 inline void
 MemoryArena_Reset(memory_arena *Arena)
 {
+    MemoryArena_CheckTempCleared(Arena);
+    
     Arena->Used = 0;
     Arena->PrevUsed = 0;
-    Arena->FrozenUsed = 0;
-    Arena->FrozenPrevUsed = 0;
+}
+
+//
+// NOTE: Pools of fixed-size blocks carved out of an arena, for per-entity data that comes and goes.
+// Free blocks are linked through their own first bytes, so alloc and free are O(1) and memory is reused
+// instead of growing the arena. In internal builds freed blocks are poisoned, and alloc/free check the poison
+// to catch writes through stale pointers and double frees.
+//
+#define MEMORY_POOL_POISON 0xDD
+
+struct memory_pool_free_block
+{
+    memory_pool_free_block *Next;
+};
+
+struct memory_pool
+{
+    memory_arena *Arena;
+    size_t BlockSize;
+    size_t BlockAlignment;
+    u32 BlocksPerChunk;
+
+    memory_pool_free_block *FirstFree;
+    u32 UsedCount;
+    u32 TotalCount;
+};
+
+inline memory_pool
+MemoryPool_(memory_arena *Arena, size_t BlockSize, size_t BlockAlignment, u32 BlocksPerChunk)
+{
+    Assert(BlocksPerChunk > 0);
+    
+    memory_pool Pool = {};
+
+    Pool.Arena = Arena;
+    Pool.BlockAlignment = Max(BlockAlignment, alignof(memory_pool_free_block));
+    Pool.BlockSize = Max(BlockSize, sizeof(memory_pool_free_block));
+    Pool.BlockSize = (Pool.BlockSize + Pool.BlockAlignment - 1) & ~(Pool.BlockAlignment - 1);
+    Pool.BlocksPerChunk = BlocksPerChunk;
+
+    return Pool;
+}
+
+#if OPUSONE_INTERNAL
+inline b32
+MemoryPool_IsPoisoned_(memory_pool *Pool, void *Block)
+{
+    u8 *Byte = (u8 *) Block + sizeof(memory_pool_free_block);
+    u8 *End = (u8 *) Block + Pool->BlockSize;
+    while (Byte < End)
+    {
+        if (*Byte++ != MEMORY_POOL_POISON)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+inline void
+MemoryPool_PushFreeBlock_(memory_pool *Pool, void *Block)
+{
+#if OPUSONE_INTERNAL
+    MemoryFill(Block, MEMORY_POOL_POISON, Pool->BlockSize);
+#endif
+
+    memory_pool_free_block *FreeBlock = (memory_pool_free_block *) Block;
+    FreeBlock->Next = Pool->FirstFree;
+    Pool->FirstFree = FreeBlock;
+}
+
+inline void
+MemoryPool_Free(memory_pool *Pool, void *Block)
+{
+    if (!Block)
+    {
+        return;
+    }
+
+    Assert(Pool->UsedCount > 0);
+    
+#if OPUSONE_INTERNAL
+    // NOTE: A block that is already fully poisoned is almost certainly being freed twice
+    Assert(Pool->BlockSize == sizeof(memory_pool_free_block) || !MemoryPool_IsPoisoned_(Pool, Block));
+#endif
+
+    MemoryPool_PushFreeBlock_(Pool, Block);
+    Pool->UsedCount--;
+}
+
+// NOTE: Blocks come back zeroed
+inline void *
+MemoryPool_Alloc_(memory_pool *Pool)
+{
+    if (!Pool->FirstFree)
+    {
+        u8 *Chunk = MemoryArena_PushBytesAligned(Pool->Arena, Pool->BlockSize * Pool->BlocksPerChunk, Pool->BlockAlignment);
+        Pool->TotalCount += Pool->BlocksPerChunk;
+        
+        // NOTE: Backwards, so blocks are handed out in address order
+        for (u32 BlockIndex = Pool->BlocksPerChunk;
+             BlockIndex > 0;
+             --BlockIndex)
+        {
+            MemoryPool_PushFreeBlock_(Pool, Chunk + (BlockIndex - 1) * Pool->BlockSize);
+        }
+    }
+
+    memory_pool_free_block *Block = Pool->FirstFree;
+    Pool->FirstFree = Block->Next;
+    Pool->UsedCount++;
+
+#if OPUSONE_INTERNAL
+    // NOTE: Anything but poison here means something wrote to the block after it was freed
+    Assert(MemoryPool_IsPoisoned_(Pool, Block));
+#endif
+    
+    MemoryZero(Block, Pool->BlockSize);
+    
+    return Block;
+}
+
+#define MemoryPool(Arena, type, BlocksPerChunk) MemoryPool_(Arena, sizeof(type), alignof(type), BlocksPerChunk)
+#define MemoryPool_Alloc(Pool, type) (type *) MemoryPool_Alloc_(Pool)
+
+// NOTE: Formats straight into the arena, with no length limit. Returns the null-terminated string.
+inline char *
+MemoryArena_PushStringFList_(memory_arena *Arena, const char *Format, va_list VarArgs)
+{
+    // NOTE: Guess a size first, most strings fit. Then trim (or grow and format again) to the real length.
+    size_t GuessSize = 128;
+    
+    va_list RetryVarArgs;
+    va_copy(RetryVarArgs, VarArgs);
+    
+    char *Result = (char *) MemoryArena_PushBytes(Arena, GuessSize);
+    size_t Length = FormatStringList(Result, GuessSize, Format, VarArgs);
+    MemoryArena_ResizePreviousPushArray(Arena, Length + 1, char);
+    
+    if (Length >= GuessSize)
+    {
+        FormatStringList(Result, Length + 1, Format, RetryVarArgs);
+    }
+    va_end(RetryVarArgs);
+
+    return Result;
+}
+
+inline char *
+MemoryArena_PushStringF(memory_arena *Arena, const char *Format, ...)
+{
+    va_list VarArgs;
+    va_start(VarArgs, Format);
+    char *Result = MemoryArena_PushStringFList_(Arena, Format, VarArgs);
+    va_end(VarArgs);
+
+    return Result;
 }
 
 #endif
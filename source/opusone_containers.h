@@ -0,0 +1,274 @@
+#ifndef OPUSONE_CONTAINERS_H
+#define OPUSONE_CONTAINERS_H
+
+#include "opusone_common.h"
+
+// NOTE: Containers that allocate out of a memory_arena. Growing never frees the old block (arenas can't), it's
+// just left behind, so size them up front when the count is known and let them grow only as a fallback.
+
+//
+// NOTE: Hashing
+//
+inline u32
+HashU64(u64 Value)
+{
+    // NOTE: MurmurHash3 finalizer
+    Value ^= Value >> 33;
+    Value *= 0xff51afd7ed558ccdULL;
+    Value ^= Value >> 33;
+    Value *= 0xc4ceb9fe1a85ec53ULL;
+    Value ^= Value >> 33;
+    return (u32) Value;
+}
+
+inline u32
+HashString(const char *String)
+{
+    // NOTE: FNV-1a
+    u32 Hash = 2166136261u;
+    while (*String)
+    {
+        Hash ^= (u8) *String++;
+        Hash *= 16777619u;
+    }
+    return Hash;
+}
+
+// NOTE: 64-bit hash of a block of bytes, meant for content hashes of whole files (8 bytes per step)
+inline u64
+HashBytes(void *Data, size_t Size)
+{
+    u8 *Bytes = (u8 *) Data;
+    u64 Hash = 0x9E3779B97F4A7C15ULL ^ (Size * 0xff51afd7ed558ccdULL);
+
+    size_t WordCount = Size / sizeof(u64);
+    for (size_t WordIndex = 0;
+         WordIndex < WordCount;
+         ++WordIndex)
+    {
+        // NOTE: Assembled byte by byte so it's an unaligned little endian load, compilers turn this into one
+        u8 *W = Bytes + WordIndex * sizeof(u64);
+        u64 Word = ((u64) W[0] | ((u64) W[1] << 8) | ((u64) W[2] << 16) | ((u64) W[3] << 24) |
+                    ((u64) W[4] << 32) | ((u64) W[5] << 40) | ((u64) W[6] << 48) | ((u64) W[7] << 56));
+        Hash = (Hash ^ (Word * 0xc4ceb9fe1a85ec53ULL)) * 0x100000001B3ULL;
+        Hash ^= Hash >> 29;
+    }
+
+    for (size_t ByteIndex = WordCount * sizeof(u64);
+         ByteIndex < Size;
+         ++ByteIndex)
+    {
+        Hash = (Hash ^ Bytes[ByteIndex]) * 0x100000001B3ULL;
+    }
+
+    Hash ^= Hash >> 33;
+    Hash *= 0xff51afd7ed558ccdULL;
+    Hash ^= Hash >> 33;
+    return Hash;
+}
+
+inline u32 HashKey(u32 Key) { return HashU64(Key); }
+inline u32 HashKey(u64 Key) { return HashU64(Key); }
+inline u32 HashKey(void *Key) { return HashU64((u64) (size_t) Key); }
+inline u32 HashKey(const char *Key) { return HashString(Key); }
+
+template <typename key_type>
+inline b32 KeysAreEqual(const key_type &A, const key_type &B) { return (A == B); }
+inline b32 KeysAreEqual(const char *A, const char *B) { return CompareStrings(A, B); }
+
+//
+// NOTE: Stretchy array
+//
+template <typename type>
+struct stretchy_array
+{
+    memory_arena *Arena;
+    type *D;
+    u32 Count;
+    u32 Capacity;
+};
+
+template <typename type>
+inline stretchy_array<type>
+StretchyArray(memory_arena *Arena, u32 InitialCapacity)
+{
+    stretchy_array<type> Result = {};
+
+    Result.Arena = Arena;
+    Result.Capacity = Max(InitialCapacity, 1u);
+    Result.D = MemoryArena_PushArray(Arena, Result.Capacity, type);
+
+    return Result;
+}
+
+template <typename type>
+inline void
+StretchyArray_Reserve(stretchy_array<type> *Array, u32 NewCapacity)
+{
+    if (NewCapacity <= Array->Capacity)
+    {
+        return;
+    }
+
+    memory_arena *Arena = Array->Arena;
+    if ((u8 *) Array->D == (Arena->Base + Arena->PrevUsed))
+    {
+        // NOTE: Still the last push in the arena, can grow in place
+        MemoryArena_ResizePreviousPushArray(Arena, NewCapacity, type);
+    }
+    else
+    {
+        type *NewD = MemoryArena_PushArray(Arena, NewCapacity, type);
+        MemoryCopyArray(NewD, Array->D, Array->Count, type);
+        Array->D = NewD;
+    }
+
+    Array->Capacity = NewCapacity;
+}
+
+template <typename type>
+inline type *
+StretchyArray_Push(stretchy_array<type> *Array, type Value)
+{
+    if (Array->Count == Array->Capacity)
+    {
+        StretchyArray_Reserve(Array, Array->Capacity * 2);
+    }
+
+    type *Result = Array->D + Array->Count++;
+    *Result = Value;
+    return Result;
+}
+
+//
+// NOTE: Open addressing (linear probing) hash map. No removal, which is all the import/cook code needs.
+// Key types need a HashKey and a KeysAreEqual overload. String keys aren't copied, they have to outlive the map.
+//
+template <typename key_type, typename value_type>
+struct hash_map_slot
+{
+    key_type Key;
+    value_type Value;
+    b32 IsOccupied;
+};
+
+template <typename key_type, typename value_type>
+struct hash_map
+{
+    memory_arena *Arena;
+    hash_map_slot<key_type, value_type> *Slots;
+    u32 Count;
+    u32 Capacity; // NOTE: Always a power of 2
+};
+
+template <typename key_type, typename value_type>
+inline hash_map<key_type, value_type>
+HashMap(memory_arena *Arena, u32 ExpectedCount)
+{
+    hash_map<key_type, value_type> Result = {};
+
+    // NOTE: Keep the load factor at or below 1/2 for the expected count
+    u32 Capacity = 16;
+    while (Capacity < ExpectedCount * 2)
+    {
+        Capacity *= 2;
+    }
+
+    typedef hash_map_slot<key_type, value_type> slot;
+    Result.Arena = Arena;
+    Result.Capacity = Capacity;
+    Result.Slots = MemoryArena_PushArrayAndZero(Arena, Capacity, slot);
+
+    return Result;
+}
+
+template <typename key_type, typename value_type>
+inline hash_map_slot<key_type, value_type> *
+HashMap_FindSlot_(hash_map<key_type, value_type> *Map, key_type Key)
+{
+    u32 Mask = Map->Capacity - 1;
+    u32 SlotIndex = HashKey(Key) & Mask;
+
+    // NOTE: The map is never full (see HashMap_FindOrAdd), so this always ends on the key or an empty slot
+    for (;;)
+    {
+        hash_map_slot<key_type, value_type> *Slot = Map->Slots + SlotIndex;
+        if (!Slot->IsOccupied || KeysAreEqual(Slot->Key, Key))
+        {
+            return Slot;
+        }
+        SlotIndex = (SlotIndex + 1) & Mask;
+    }
+}
+
+template <typename key_type, typename value_type>
+inline value_type *
+HashMap_Find(hash_map<key_type, value_type> *Map, key_type Key)
+{
+    hash_map_slot<key_type, value_type> *Slot = HashMap_FindSlot_(Map, Key);
+    value_type *Result = Slot->IsOccupied ? &Slot->Value : 0;
+    return Result;
+}
+
+template <typename key_type, typename value_type>
+inline void
+HashMap_Grow_(hash_map<key_type, value_type> *Map)
+{
+    typedef hash_map_slot<key_type, value_type> slot;
+    slot *OldSlots = Map->Slots;
+    u32 OldCapacity = Map->Capacity;
+
+    Map->Capacity *= 2;
+    Map->Slots = MemoryArena_PushArrayAndZero(Map->Arena, Map->Capacity, slot);
+
+    for (u32 SlotIndex = 0;
+         SlotIndex < OldCapacity;
+         ++SlotIndex)
+    {
+        slot *OldSlot = OldSlots + SlotIndex;
+        if (OldSlot->IsOccupied)
+        {
+            *HashMap_FindSlot_(Map, OldSlot->Key) = *OldSlot;
+        }
+    }
+}
+
+// NOTE: Returns the value for Key, adding it (zeroed) if it isn't in the map yet. WasAdded is optional.
+template <typename key_type, typename value_type>
+inline value_type *
+HashMap_FindOrAdd(hash_map<key_type, value_type> *Map, key_type Key, b32 *WasAdded)
+{
+    hash_map_slot<key_type, value_type> *Slot = HashMap_FindSlot_(Map, Key);
+    b32 Added = !Slot->IsOccupied;
+
+    if (Added)
+    {
+        // NOTE: Grow at 3/4 load to keep the probe sequences short
+        if ((Map->Count + 1) * 4 > Map->Capacity * 3)
+        {
+            HashMap_Grow_(Map);
+            Slot = HashMap_FindSlot_(Map, Key);
+        }
+
+        *Slot = {};
+        Slot->Key = Key;
+        Slot->IsOccupied = true;
+        Map->Count++;
+    }
+
+    if (WasAdded)
+    {
+        *WasAdded = Added;
+    }
+
+    return &Slot->Value;
+}
+
+template <typename key_type, typename value_type>
+inline void
+HashMap_Set(hash_map<key_type, value_type> *Map, key_type Key, value_type Value)
+{
+    *HashMap_FindOrAdd(Map, Key, 0) = Value;
+}
+
+#endif
@@ -0,0 +1,577 @@
+#include "opusone_cooked_model.h"
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_assimp.h"
+#include "opusone_string_id.h"
+
+#include <cstddef>
+#include <cstdio>
+
+static_assert(sizeof(void *) == sizeof(u64), "Cooked models store pointers as u64 file offsets");
+static_assert(sizeof(string_id) == sizeof(u32), "Cooked models store string_ids as u32 file offsets");
+
+// NOTE: Blob and fixup tables are built in address space reserved from the temp arena, only what's used gets committed
+#define COOKED_MODEL_MAX_SIZE Gigabytes(1)
+#define COOKED_MODEL_MAX_FIXUP_SIZE Megabytes(64)
+
+internal u32
+CookedModel_GetLayoutCheck_()
+{
+    size_t Sizes[] = {
+        sizeof(imported_model), sizeof(imported_mesh), sizeof(imported_material), sizeof(imported_armature),
+        sizeof(imported_bone), sizeof(imported_animation), sizeof(imported_animation_channel),
+        sizeof(vert_bone_ids), sizeof(vert_bone_weights), sizeof(vec3), sizeof(vec4), sizeof(quat), sizeof(mat4)
+    };
+
+    u32 Result = 2166136261u;
+    for (u32 SizeIndex = 0;
+         SizeIndex < ArrayCount(Sizes);
+         ++SizeIndex)
+    {
+        Result = (Result ^ (u32) Sizes[SizeIndex]) * 16777619u;
+    }
+    return Result;
+}
+
+//
+// NOTE: Source write time (both)
+//
+internal b32
+CookedModel_MatchText_(const char *Text, const char *Prefix, size_t Length)
+{
+    for (size_t CharIndex = 0;
+         CharIndex < Length;
+         ++CharIndex)
+    {
+        if (Text[CharIndex] != Prefix[CharIndex])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+b32
+CookedModel_GetSourceWriteTime(const char *SourcePath, u64 *Out_WriteTime)
+{
+    if (!Platform_GetFileWriteTime(SourcePath, Out_WriteTime))
+    {
+        return false;
+    }
+
+    platform_mapped_file MappedFile = Platform_MapFile(SourcePath, MapHint_Sequential);
+    if (!MappedFile.Data)
+    {
+        return false;
+    }
+
+    // NOTE: Referenced files are relative to the .gltf
+    size_t DirectoryLength = 0;
+    for (size_t CharIndex = 0;
+         SourcePath[CharIndex] != '\0';
+         ++CharIndex)
+    {
+        if (SourcePath[CharIndex] == '/' || SourcePath[CharIndex] == '\\')
+        {
+            DirectoryLength = CharIndex + 1;
+        }
+    }
+
+    // NOTE: Not parsing the JSON, every "uri": "<Path>" counts. That's the buffers, and the images too, which only
+    // cook again for nothing when a texture changes. Embedded data: URIs are part of the .gltf already.
+    const char Key[] = "\"uri\"";
+    size_t KeyLength = sizeof(Key) - 1;
+    char *Text = (char *) MappedFile.Data;
+    size_t TextSize = MappedFile.Size;
+    b32 Result = true;
+    for (size_t At = 0;
+         At + KeyLength <= TextSize;
+         ++At)
+    {
+        if (!CookedModel_MatchText_(Text + At, Key, KeyLength))
+        {
+            continue;
+        }
+
+        At += KeyLength;
+        while (At < TextSize && (Text[At] == ' ' || Text[At] == ':' || Text[At] == '\t' || Text[At] == '\r' || Text[At] == '\n'))
+        {
+            ++At;
+        }
+        if (At >= TextSize || Text[At] != '"')
+        {
+            continue;
+        }
+
+        size_t UriStart = ++At;
+        while (At < TextSize && Text[At] != '"')
+        {
+            ++At;
+        }
+        size_t UriLength = At - UriStart;
+        if (UriLength >= 5 && CookedModel_MatchText_(Text + UriStart, "data:", 5))
+        {
+            continue;
+        }
+
+        char ReferencedPath[512];
+        if (DirectoryLength + UriLength + 1 > sizeof(ReferencedPath))
+        {
+            Result = false;
+            break;
+        }
+        MemoryCopy(ReferencedPath, SourcePath, DirectoryLength);
+        MemoryCopy(ReferencedPath + DirectoryLength, Text + UriStart, UriLength);
+        ReferencedPath[DirectoryLength + UriLength] = '\0';
+
+        // NOTE: A missing buffer is for the importer to complain about, it doesn't make the cooked model any staler
+        u64 ReferencedWriteTime;
+        if (Platform_GetFileWriteTime(ReferencedPath, &ReferencedWriteTime) && ReferencedWriteTime > *Out_WriteTime)
+        {
+            *Out_WriteTime = ReferencedWriteTime;
+        }
+    }
+
+    Platform_UnmapFile(&MappedFile);
+    return Result;
+}
+
+//
+// NOTE: Writing (opusone_cooker)
+//
+struct cooked_model_writer
+{
+    memory_arena Blob;
+    stretchy_array<u64> PointerFixups;
+    stretchy_array<u64> StringFixups;
+};
+
+internal u64
+CookWriter_Push_(cooked_model_writer *Writer, const void *Source, size_t Size, size_t Alignment)
+{
+    u8 *Dest = MemoryArena_PushBytesAligned(&Writer->Blob, Size, Alignment);
+    MemoryCopy(Dest, Source, Size);
+    u64 Result = (u64) (Dest - Writer->Blob.Base);
+    return Result;
+}
+
+// NOTE: Copies the array a pointer field points at into the blob and turns the field into a fixup. The struct
+// has to be in the blob already.
+internal u64
+CookWriter_PushArrayField_(cooked_model_writer *Writer, u64 StructOffset, size_t FieldOffset, size_t Size, size_t Alignment)
+{
+    u64 FieldFileOffset = StructOffset + FieldOffset;
+    void **Field = (void **) (Writer->Blob.Base + FieldFileOffset);
+
+    u64 Result = 0;
+    if (*Field)
+    {
+        Result = CookWriter_Push_(Writer, *Field, Size, Alignment);
+        StretchyArray_Push(&Writer->PointerFixups, FieldFileOffset);
+    }
+
+    *(u64 *) Field = Result;
+    return Result;
+}
+
+internal void
+CookWriter_SetStringField_(cooked_model_writer *Writer, u64 StructOffset, size_t FieldOffset)
+{
+    u64 FieldFileOffset = StructOffset + FieldOffset;
+    string_id ID = *(string_id *) (Writer->Blob.Base + FieldFileOffset);
+    if (ID == 0)
+    {
+        return;
+    }
+
+    const char *String = StringID_GetString(ID);
+    size_t Length = 0;
+    while (String[Length] != '\0')
+    {
+        ++Length;
+    }
+
+    u64 StringOffset = CookWriter_Push_(Writer, String, Length + 1, 1);
+    Assert(StringOffset <= 0xFFFFFFFF);
+    *(u32 *) (Writer->Blob.Base + FieldFileOffset) = (u32) StringOffset;
+    StretchyArray_Push(&Writer->StringFixups, FieldFileOffset);
+}
+
+#define CookWriter_PushArrayField(Writer, StructOffset, struct_type, Field, Count, element_type, Alignment) \
+    CookWriter_PushArrayField_(Writer, StructOffset, offsetof(struct_type, Field), (Count) * sizeof(element_type), \
+                               Max((size_t) (Alignment), alignof(element_type)))
+#define CookWriter_SetStringField(Writer, StructOffset, struct_type, Field) \
+    CookWriter_SetStringField_(Writer, StructOffset, offsetof(struct_type, Field))
+
+internal void
+CookWriter_PushMesh_(cooked_model_writer *Writer, u64 MeshOffset)
+{
+    imported_mesh *Mesh = (imported_mesh *) (Writer->Blob.Base + MeshOffset);
+    u32 VertexCount = Mesh->VertexCount;
+    u32 IndexCount = Mesh->IndexCount;
+
+    // NOTE: Same alignments as Assimp_LoadModel
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexPositions, VertexCount, vec3, ARENA_ALIGN_AVX);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexTangents, VertexCount, vec3, ARENA_ALIGN_AVX);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexBitangents, VertexCount, vec3, ARENA_ALIGN_AVX);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexNormals, VertexCount, vec3, ARENA_ALIGN_AVX);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexColors, VertexCount, vec4, ARENA_ALIGN_AVX);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexUVs, VertexCount, vec2, ARENA_ALIGN_AVX);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexBoneIDs, VertexCount, vert_bone_ids, 1);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, VertexBoneWeights, VertexCount, vert_bone_weights, 1);
+    CookWriter_PushArrayField(Writer, MeshOffset, imported_mesh, Indices, IndexCount, i32, 1);
+}
+
+internal void
+CookWriter_PushAnimation_(cooked_model_writer *Writer, u64 AnimationOffset)
+{
+    CookWriter_SetStringField(Writer, AnimationOffset, imported_animation, AnimationName);
+
+    u32 ChannelCount = ((imported_animation *) (Writer->Blob.Base + AnimationOffset))->ChannelCount;
+    u64 ChannelsOffset = CookWriter_PushArrayField(Writer, AnimationOffset, imported_animation, Channels,
+                                                   ChannelCount, imported_animation_channel, 1);
+    for (u32 ChannelIndex = 0;
+         ChannelIndex < ChannelCount;
+         ++ChannelIndex)
+    {
+        u64 ChannelOffset = ChannelsOffset + ChannelIndex * sizeof(imported_animation_channel);
+        imported_animation_channel Channel = *(imported_animation_channel *) (Writer->Blob.Base + ChannelOffset);
+
+        CookWriter_PushArrayField(Writer, ChannelOffset, imported_animation_channel, PositionKeys, Channel.PositionKeyCount, vec3, ARENA_ALIGN_SSE);
+        CookWriter_PushArrayField(Writer, ChannelOffset, imported_animation_channel, PositionKeyTimes, Channel.PositionKeyCount, f64, 1);
+        CookWriter_PushArrayField(Writer, ChannelOffset, imported_animation_channel, RotationKeys, Channel.RotationKeyCount, quat, 1);
+        CookWriter_PushArrayField(Writer, ChannelOffset, imported_animation_channel, RotationKeyTimes, Channel.RotationKeyCount, f64, 1);
+        CookWriter_PushArrayField(Writer, ChannelOffset, imported_animation_channel, ScaleKeys, Channel.ScaleKeyCount, vec3, ARENA_ALIGN_SSE);
+        CookWriter_PushArrayField(Writer, ChannelOffset, imported_animation_channel, ScaleKeyTimes, Channel.ScaleKeyCount, f64, 1);
+    }
+}
+
+b32
+CookedModel_Write(const char *Path, imported_model *Model, u64 SourceWriteTime, memory_arena *TempArena)
+{
+    temporary_memory WriteMemory = MemoryArena_BeginTemp(TempArena);
+
+    cooked_model_writer Writer = {};
+    Writer.Blob = MemoryArenaNested(TempArena, COOKED_MODEL_MAX_SIZE);
+    memory_arena FixupArena = MemoryArenaNested(TempArena, COOKED_MODEL_MAX_FIXUP_SIZE);
+    Writer.PointerFixups = StretchyArray<u64>(&FixupArena, 256);
+    Writer.StringFixups = StretchyArray<u64>(&FixupArena, 64);
+
+    // NOTE: The header goes first, so a file offset of 0 can mean null
+    cooked_model_header *Header = MemoryArena_PushStruct(&Writer.Blob, cooked_model_header);
+    *Header = {};
+
+    u64 ModelOffset = CookWriter_Push_(&Writer, Model, sizeof(imported_model), alignof(imported_model));
+
+    u64 MeshesOffset = CookWriter_PushArrayField(&Writer, ModelOffset, imported_model, Meshes, Model->MeshCount, imported_mesh, 1);
+    for (u32 MeshIndex = 0;
+         MeshIndex < Model->MeshCount;
+         ++MeshIndex)
+    {
+        CookWriter_PushMesh_(&Writer, MeshesOffset + MeshIndex * sizeof(imported_mesh));
+    }
+
+    u64 MaterialsOffset = CookWriter_PushArrayField(&Writer, ModelOffset, imported_model, Materials, Model->MaterialCount, imported_material, 1);
+    for (u32 MaterialIndex = 0;
+         MaterialIndex < Model->MaterialCount;
+         ++MaterialIndex)
+    {
+        u64 MaterialOffset = MaterialsOffset + MaterialIndex * sizeof(imported_material);
+        for (u32 TextureType = 0;
+             TextureType < TEXTURE_TYPE_COUNT;
+             ++TextureType)
+        {
+            CookWriter_SetStringField_(&Writer, MaterialOffset, offsetof(imported_material, TexturePaths) + TextureType * sizeof(string_id));
+        }
+    }
+
+    u64 ArmatureOffset = CookWriter_PushArrayField(&Writer, ModelOffset, imported_model, Armature, 1, imported_armature, 1);
+    if (ArmatureOffset)
+    {
+        imported_armature *Armature = (imported_armature *) (Writer.Blob.Base + ArmatureOffset);
+        // NOTE: Rebuilt on load
+        Armature->BoneIDsByName = {};
+
+        u64 BonesOffset = CookWriter_PushArrayField(&Writer, ArmatureOffset, imported_armature, Bones, Armature->BoneCount, imported_bone, 1);
+        for (u32 BoneIndex = 0;
+             BoneIndex < Model->Armature->BoneCount;
+             ++BoneIndex)
+        {
+            CookWriter_SetStringField(&Writer, BonesOffset + BoneIndex * sizeof(imported_bone), imported_bone, BoneName);
+        }
+    }
+
+    u64 AnimationsOffset = CookWriter_PushArrayField(&Writer, ModelOffset, imported_model, Animations, Model->AnimationCount, imported_animation, 1);
+    for (u32 AnimationIndex = 0;
+         AnimationIndex < Model->AnimationCount;
+         ++AnimationIndex)
+    {
+        CookWriter_PushAnimation_(&Writer, AnimationsOffset + AnimationIndex * sizeof(imported_animation));
+    }
+
+    u64 PointerFixupsOffset = CookWriter_Push_(&Writer, Writer.PointerFixups.D, Writer.PointerFixups.Count * sizeof(u64), alignof(u64));
+    u64 StringFixupsOffset = CookWriter_Push_(&Writer, Writer.StringFixups.D, Writer.StringFixups.Count * sizeof(u64), alignof(u64));
+
+    Header->Magic = COOKED_MODEL_MAGIC;
+    Header->Version = COOKED_MODEL_VERSION;
+    Header->LayoutCheck = CookedModel_GetLayoutCheck_();
+    Header->PointerFixupCount = Writer.PointerFixups.Count;
+    Header->StringFixupCount = Writer.StringFixups.Count;
+    Header->FileSize = Writer.Blob.Used;
+    Header->SourceWriteTime = SourceWriteTime;
+    Header->PointerFixupsOffset = PointerFixupsOffset;
+    Header->StringFixupsOffset = StringFixupsOffset;
+    Header->ModelOffset = ModelOffset;
+
+    b32 Result = Platform_WriteFile(Path, Writer.Blob.Base, Writer.Blob.Used);
+
+    MemoryArena_EndTemp(WriteMemory);
+    return Result;
+}
+
+//
+// NOTE: Loading (game)
+//
+// NOTE: Also checks the offset is aligned for what's read there
+internal b32
+CookedModel_IsRangeInFile_(u64 Offset, u64 Size, u64 Alignment, u64 FileSize)
+{
+    b32 Result = (Offset <= FileSize) && (Size <= (FileSize - Offset)) && ((Offset % Alignment) == 0);
+    return Result;
+}
+
+// NOTE: After the pointer fixups every pointer field is null or points into the file, checks the array it points at
+// (Count elements) fits in the file too. Pointer fields that weren't in the fixup table fail here as well.
+internal b32
+CookedModel_IsArrayInFile_(u8 *Data, u64 DataSize, void *Pointer, u64 Count, size_t ElementSize, size_t Alignment)
+{
+    if (!Pointer)
+    {
+        return true;
+    }
+
+    u8 *Bytes = (u8 *) Pointer;
+    if (Bytes < Data || Bytes >= Data + DataSize || Count > DataSize / ElementSize)
+    {
+        return false;
+    }
+
+    b32 Result = CookedModel_IsRangeInFile_((u64) (Bytes - Data), Count * ElementSize, Alignment, DataSize);
+    return Result;
+}
+
+#define CookedModel_IsArrayInFile(Data, DataSize, Pointer, Count) \
+    CookedModel_IsArrayInFile_(Data, DataSize, Pointer, Count, sizeof(*(Pointer)), alignof(decltype(*(Pointer))))
+
+// NOTE: Walks the patched model the way the writer laid it out and checks every count against what's really in the
+// file, so a count that was tampered with or cut short can't send the game reading past the model. Also the counts
+// that index fixed size arrays (bone transforms, bone children).
+internal b32
+CookedModel_Validate_(u8 *Data, u64 DataSize, imported_model *Model)
+{
+    if (!CookedModel_IsArrayInFile(Data, DataSize, Model->Meshes, Model->MeshCount) ||
+        !CookedModel_IsArrayInFile(Data, DataSize, Model->Materials, Model->MaterialCount) ||
+        !CookedModel_IsArrayInFile(Data, DataSize, Model->Armature, 1) ||
+        !CookedModel_IsArrayInFile(Data, DataSize, Model->Animations, Model->AnimationCount))
+    {
+        return false;
+    }
+
+    for (u32 MeshIndex = 0;
+         Model->Meshes && MeshIndex < Model->MeshCount;
+         ++MeshIndex)
+    {
+        imported_mesh *Mesh = Model->Meshes + MeshIndex;
+        u32 VertexCount = Mesh->VertexCount;
+        if (!CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexPositions, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexTangents, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexBitangents, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexNormals, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexColors, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexUVs, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexBoneIDs, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->VertexBoneWeights, VertexCount) ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Mesh->Indices, Mesh->IndexCount))
+        {
+            return false;
+        }
+    }
+
+    if (Model->Armature)
+    {
+        imported_armature *Armature = Model->Armature;
+        if (Armature->BoneCount > MAX_BONES_PER_MODEL ||
+            !CookedModel_IsArrayInFile(Data, DataSize, Armature->Bones, Armature->BoneCount))
+        {
+            return false;
+        }
+
+        for (u32 BoneIndex = 0;
+             Armature->Bones && BoneIndex < Armature->BoneCount;
+             ++BoneIndex)
+        {
+            if (Armature->Bones[BoneIndex].ChildrenCount > MAX_BONE_CHILDREN)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (u32 AnimationIndex = 0;
+         Model->Animations && AnimationIndex < Model->AnimationCount;
+         ++AnimationIndex)
+    {
+        imported_animation *Animation = Model->Animations + AnimationIndex;
+        if (!CookedModel_IsArrayInFile(Data, DataSize, Animation->Channels, Animation->ChannelCount))
+        {
+            return false;
+        }
+
+        for (u32 ChannelIndex = 0;
+             Animation->Channels && ChannelIndex < Animation->ChannelCount;
+             ++ChannelIndex)
+        {
+            imported_animation_channel *Channel = Animation->Channels + ChannelIndex;
+            if (!CookedModel_IsArrayInFile(Data, DataSize, Channel->PositionKeys, Channel->PositionKeyCount) ||
+                !CookedModel_IsArrayInFile(Data, DataSize, Channel->PositionKeyTimes, Channel->PositionKeyCount) ||
+                !CookedModel_IsArrayInFile(Data, DataSize, Channel->RotationKeys, Channel->RotationKeyCount) ||
+                !CookedModel_IsArrayInFile(Data, DataSize, Channel->RotationKeyTimes, Channel->RotationKeyCount) ||
+                !CookedModel_IsArrayInFile(Data, DataSize, Channel->ScaleKeys, Channel->ScaleKeyCount) ||
+                !CookedModel_IsArrayInFile(Data, DataSize, Channel->ScaleKeyTimes, Channel->ScaleKeyCount))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// NOTE: Patches the fixups in place. Every offset is checked against the file, and then every array against its
+// count, a broken file fails instead of scribbling over or reading past the asset arena.
+internal imported_model *
+CookedModel_Fixup_(u8 *Data, u64 DataSize)
+{
+    if (DataSize < sizeof(cooked_model_header))
+    {
+        return 0;
+    }
+
+    cooked_model_header *Header = (cooked_model_header *) Data;
+    if (Header->Magic != COOKED_MODEL_MAGIC || Header->Version != COOKED_MODEL_VERSION ||
+        Header->LayoutCheck != CookedModel_GetLayoutCheck_() || Header->FileSize != DataSize ||
+        !CookedModel_IsRangeInFile_(Header->PointerFixupsOffset, (u64) Header->PointerFixupCount * sizeof(u64), alignof(u64), DataSize) ||
+        !CookedModel_IsRangeInFile_(Header->StringFixupsOffset, (u64) Header->StringFixupCount * sizeof(u64), alignof(u64), DataSize) ||
+        !CookedModel_IsRangeInFile_(Header->ModelOffset, sizeof(imported_model), alignof(imported_model), DataSize))
+    {
+        return 0;
+    }
+
+    u64 *PointerFixups = (u64 *) (Data + Header->PointerFixupsOffset);
+    for (u32 FixupIndex = 0;
+         FixupIndex < Header->PointerFixupCount;
+         ++FixupIndex)
+    {
+        u64 FieldOffset = PointerFixups[FixupIndex];
+        if (!CookedModel_IsRangeInFile_(FieldOffset, sizeof(u64), alignof(u64), DataSize))
+        {
+            return 0;
+        }
+
+        u64 *Field = (u64 *) (Data + FieldOffset);
+        if (*Field >= DataSize)
+        {
+            return 0;
+        }
+        *Field = (u64) (size_t) (Data + *Field);
+    }
+
+    u64 *StringFixups = (u64 *) (Data + Header->StringFixupsOffset);
+    for (u32 FixupIndex = 0;
+         FixupIndex < Header->StringFixupCount;
+         ++FixupIndex)
+    {
+        u64 FieldOffset = StringFixups[FixupIndex];
+        if (!CookedModel_IsRangeInFile_(FieldOffset, sizeof(u32), alignof(u32), DataSize))
+        {
+            return 0;
+        }
+
+        // NOTE: The string has to end inside the file
+        u32 *Field = (u32 *) (Data + FieldOffset);
+        u64 StringEnd = *Field;
+        while (StringEnd < DataSize && Data[StringEnd] != '\0')
+        {
+            ++StringEnd;
+        }
+        if (StringEnd >= DataSize)
+        {
+            return 0;
+        }
+        *Field = StringID((const char *) (Data + *Field));
+    }
+
+    imported_model *Result = (imported_model *) (Data + Header->ModelOffset);
+    if (!CookedModel_Validate_(Data, DataSize, Result))
+    {
+        return 0;
+    }
+    return Result;
+}
+
+imported_model *
+CookedModel_Load(memory_arena *AssetArena, const char *Path, const char *SourcePath)
+{
+    platform_mapped_file MappedFile = Platform_MapFile(Path, MapHint_Sequential);
+    if (!MappedFile.Data)
+    {
+        return 0;
+    }
+
+    if (MappedFile.Size < sizeof(cooked_model_header))
+    {
+        printf("COOKER: %s is broken or from another version\n", Path);
+        Platform_UnmapFile(&MappedFile);
+        return 0;
+    }
+
+    cooked_model_header *MappedHeader = (cooked_model_header *) MappedFile.Data;
+    u64 SourceWriteTime;
+    if (CookedModel_GetSourceWriteTime(SourcePath, &SourceWriteTime) && SourceWriteTime != MappedHeader->SourceWriteTime)
+    {
+        printf("COOKER: %s is stale, cook %s again\n", Path, SourcePath);
+        Platform_UnmapFile(&MappedFile);
+        return 0;
+    }
+
+    // NOTE: Copied out of the mapping so the model lives in Storage like everything else (snapshots, reloads)
+    temporary_memory LoadMemory = MemoryArena_BeginTemp(AssetArena);
+    u8 *Data = MemoryArena_PushBytesAligned(AssetArena, MappedFile.Size, ARENA_ALIGN_CACHE_LINE);
+    MemoryCopy(Data, MappedFile.Data, MappedFile.Size);
+    u64 DataSize = MappedFile.Size;
+    Platform_UnmapFile(&MappedFile);
+
+    imported_model *Result = CookedModel_Fixup_(Data, DataSize);
+    if (!Result)
+    {
+        printf("COOKER: %s is broken or from another version\n", Path);
+        MemoryArena_EndTemp(LoadMemory);
+        return 0;
+    }
+    MemoryArena_KeepTemp(LoadMemory);
+
+    if (Result->Armature)
+    {
+        imported_armature *Armature = Result->Armature;
+        Armature->BoneIDsByName = HashMap<string_id, u32>(AssetArena, Armature->BoneCount);
+        for (u32 BoneIndex = 1;
+             BoneIndex < Armature->BoneCount;
+             ++BoneIndex)
+        {
+            HashMap_Set(&Armature->BoneIDsByName, Armature->Bones[BoneIndex].BoneName, BoneIndex);
+        }
+    }
+
+    return Result;
+}
@@ -0,0 +1,50 @@
+#ifndef OPUSONE_COOKED_MODEL_H
+#define OPUSONE_COOKED_MODEL_H
+
+#include "opusone_common.h"
+#include "opusone_assimp.h"
+
+// NOTE: imported_model baked into one relocatable blob by opusone_cooker, so the game doesn't have to run the
+// Assimp import (tangents, triangulation, vertex joining) on every launch.
+//
+// The file is the imported_* structs and arrays exactly as they are in memory, laid out behind the header with
+// the arena alignments the importer uses. Pointer fields hold file offsets (0 is null) and string_id fields hold
+// the file offset of a null terminated string. Both are listed in fixup tables, loading is reading the file into
+// the asset arena and patching those fields in place. Bone name maps are rebuilt, they're tiny.
+//
+// The layout is whatever this build's structs are, so the version has to go up when an imported_* struct
+// changes (LayoutCheck catches size changes that were missed).
+#define COOKED_MODEL_MAGIC 0x4C444F4D // NOTE: "MODL"
+#define COOKED_MODEL_VERSION 2
+#define COOKED_MODEL_EXTENSION ".cooked"
+
+struct cooked_model_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 LayoutCheck;
+    u32 PointerFixupCount;
+    u32 StringFixupCount;
+    u32 Reserved;
+
+    u64 FileSize;
+    u64 SourceWriteTime; // NOTE: CookedModel_GetSourceWriteTime, a different one makes the cooked model stale
+
+    u64 PointerFixupsOffset; // NOTE: u64 file offsets of the fields to patch
+    u64 StringFixupsOffset;
+    u64 ModelOffset;
+};
+
+// NOTE: The newest write time of the .gltf and the files it references (.bin buffers), the model has to cook
+// again when any of them changes
+b32
+CookedModel_GetSourceWriteTime(const char *SourcePath, u64 *Out_WriteTime);
+
+b32
+CookedModel_Write(const char *Path, imported_model *Model, u64 SourceWriteTime, memory_arena *TempArena);
+
+// NOTE: Returns 0 if there's no cooked model at Path, it's broken, from another version or older than SourcePath
+imported_model *
+CookedModel_Load(memory_arena *AssetArena, const char *Path, const char *SourcePath);
+
+#endif
@@ -0,0 +1,860 @@
+#include "opusone_cooked_texture.h"
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_math.h"
+
+#include <cstdio>
+
+// NOTE: Mip pixels and the file are built in address space reserved from the temp arena, only what's used gets committed
+#define COOKED_TEXTURE_MAX_SIZE Gigabytes(1)
+#define COOKED_TEXTURE_MAX_PIXELS_SIZE Gigabytes(2)
+
+// NOTE: 4x4 block of RGBA8 pixels, row by row
+typedef u8 texture_block_pixels[16][4];
+
+texture_data
+TextureData_FromImage(platform_image *Image)
+{
+    Assert(Image->BytesPerPixel == 4 || Image->BytesPerPixel == 3);
+    Assert(Image->Width * Image->BytesPerPixel == Image->Pitch);
+
+    texture_data Result = {};
+
+    Result.Format = (Image->BytesPerPixel == 4) ? TEXTURE_FORMAT_RGBA8 : TEXTURE_FORMAT_RGB8;
+    Result.Width = Image->Width;
+    Result.Height = Image->Height;
+    Result.MipCount = 1;
+    Result.GenerateMips = true;
+    Result.Mips[0] = Image->ImageData;
+    Result.MipSizes[0] = (size_t) Image->Pitch * Image->Height;
+
+    return Result;
+}
+
+//
+// NOTE: Block encoding (opusone_cooker)
+//
+internal void
+TextureBlock_Fetch_(u8 *Pixels, u32 Width, u32 Height, u32 BlockX, u32 BlockY, texture_block_pixels Out)
+{
+    // NOTE: Blocks hanging over the edge repeat the last row and column, those texels are never sampled
+    for (u32 Y = 0; Y < 4; ++Y)
+    {
+        u32 SourceY = Min(BlockY * 4 + Y, Height - 1);
+        for (u32 X = 0; X < 4; ++X)
+        {
+            u32 SourceX = Min(BlockX * 4 + X, Width - 1);
+            MemoryCopy(Out[Y * 4 + X], Pixels + (SourceY * Width + SourceX) * 4, 4);
+        }
+    }
+}
+
+// NOTE: Endpoints along the principal axis of the block's colors (the first ChannelCount channels), from the
+// extreme projections pulled in by 1/16 of the range, which lowers the error of the in-between pixels
+internal void
+TextureBlock_FindEndpoints_(texture_block_pixels Pixels, u32 ChannelCount, f32 *Out_E0, f32 *Out_E1)
+{
+    f32 Mean[4] = {};
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        for (u32 C = 0; C < ChannelCount; ++C)
+        {
+            Mean[C] += Pixels[PixelIndex][C] / 16.0f;
+        }
+    }
+
+    f32 Covariance[4][4] = {};
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        f32 D[4];
+        for (u32 C = 0; C < ChannelCount; ++C)
+        {
+            D[C] = Pixels[PixelIndex][C] - Mean[C];
+        }
+        for (u32 I = 0; I < ChannelCount; ++I)
+        {
+            for (u32 J = 0; J < ChannelCount; ++J)
+            {
+                Covariance[I][J] += D[I] * D[J];
+            }
+        }
+    }
+
+    // NOTE: Power iteration, a few steps is plenty for picking endpoints
+    f32 Axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (u32 Iteration = 0; Iteration < 8; ++Iteration)
+    {
+        f32 Next[4] = {};
+        f32 LengthSquared = 0.0f;
+        for (u32 I = 0; I < ChannelCount; ++I)
+        {
+            for (u32 J = 0; J < ChannelCount; ++J)
+            {
+                Next[I] += Covariance[I][J] * Axis[J];
+            }
+            LengthSquared += Next[I] * Next[I];
+        }
+
+        if (LengthSquared < 1e-8f)
+        {
+            break;
+        }
+
+        f32 InvLength = 1.0f / SqrtF(LengthSquared);
+        for (u32 C = 0; C < ChannelCount; ++C)
+        {
+            Axis[C] = Next[C] * InvLength;
+        }
+    }
+
+    f32 MinT = FLT_MAX;
+    f32 MaxT = -FLT_MAX;
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        f32 T = 0.0f;
+        for (u32 C = 0; C < ChannelCount; ++C)
+        {
+            T += (Pixels[PixelIndex][C] - Mean[C]) * Axis[C];
+        }
+        MinT = Min(MinT, T);
+        MaxT = Max(MaxT, T);
+    }
+
+    f32 Inset = (MaxT - MinT) / 16.0f;
+    MinT += Inset;
+    MaxT -= Inset;
+
+    for (u32 C = 0; C < ChannelCount; ++C)
+    {
+        Out_E0[C] = ClampF(Mean[C] + Axis[C] * MaxT, 0.0f, 255.0f);
+        Out_E1[C] = ClampF(Mean[C] + Axis[C] * MinT, 0.0f, 255.0f);
+    }
+}
+
+internal u32
+TextureBlock_NearestIndex_(u8 *Pixel, u8 (*Palette)[4], u32 PaletteCount, u32 ChannelCount)
+{
+    u32 Result = 0;
+    u32 BestError = 0xFFFFFFFF;
+    for (u32 PaletteIndex = 0; PaletteIndex < PaletteCount; ++PaletteIndex)
+    {
+        u32 Error = 0;
+        for (u32 C = 0; C < ChannelCount; ++C)
+        {
+            i32 D = (i32) Pixel[C] - (i32) Palette[PaletteIndex][C];
+            Error += (u32) (D * D);
+        }
+        if (Error < BestError)
+        {
+            BestError = Error;
+            Result = PaletteIndex;
+        }
+    }
+    return Result;
+}
+
+internal u16
+BC1_Pack565_(f32 *Color)
+{
+    u32 R = (u32) (Color[0] * 31.0f / 255.0f + 0.5f);
+    u32 G = (u32) (Color[1] * 63.0f / 255.0f + 0.5f);
+    u32 B = (u32) (Color[2] * 31.0f / 255.0f + 0.5f);
+    u16 Result = (u16) ((R << 11) | (G << 5) | B);
+    return Result;
+}
+
+internal void
+BC1_Unpack565_(u16 Packed, u8 *Out)
+{
+    u32 R = (Packed >> 11) & 31;
+    u32 G = (Packed >> 5) & 63;
+    u32 B = Packed & 31;
+    Out[0] = (u8) ((R << 3) | (R >> 2));
+    Out[1] = (u8) ((G << 2) | (G >> 4));
+    Out[2] = (u8) ((B << 3) | (B >> 2));
+    Out[3] = 255;
+}
+
+// NOTE: BC3 reads its color block in four color mode whatever the endpoint order is
+internal void
+BC1_BuildPalette_(u16 Color0, u16 Color1, b32 FourColorsAlways, u8 (*Out_Palette)[4])
+{
+    BC1_Unpack565_(Color0, Out_Palette[0]);
+    BC1_Unpack565_(Color1, Out_Palette[1]);
+
+    if (Color0 > Color1 || FourColorsAlways)
+    {
+        for (u32 C = 0; C < 3; ++C)
+        {
+            Out_Palette[2][C] = (u8) ((2 * Out_Palette[0][C] + Out_Palette[1][C]) / 3);
+            Out_Palette[3][C] = (u8) ((Out_Palette[0][C] + 2 * Out_Palette[1][C]) / 3);
+        }
+        Out_Palette[2][3] = 255;
+        Out_Palette[3][3] = 255;
+    }
+    else
+    {
+        for (u32 C = 0; C < 3; ++C)
+        {
+            Out_Palette[2][C] = (u8) ((Out_Palette[0][C] + Out_Palette[1][C]) / 2);
+            Out_Palette[3][C] = 0;
+        }
+        Out_Palette[2][3] = 255;
+        Out_Palette[3][3] = 0;
+    }
+}
+
+internal void
+BC1_EncodeBlock_(texture_block_pixels Pixels, u8 *Out)
+{
+    f32 E0[4], E1[4];
+    TextureBlock_FindEndpoints_(Pixels, 3, E0, E1);
+
+    u16 Color0 = BC1_Pack565_(E0);
+    u16 Color1 = BC1_Pack565_(E1);
+    if (Color0 < Color1)
+    {
+        u16 Swap = Color0;
+        Color0 = Color1;
+        Color1 = Swap;
+    }
+
+    u32 Indices = 0;
+    if (Color0 != Color1)
+    {
+        u8 Palette[4][4];
+        BC1_BuildPalette_(Color0, Color1, false, Palette);
+        for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+        {
+            Indices |= TextureBlock_NearestIndex_(Pixels[PixelIndex], Palette, 4, 3) << (PixelIndex * 2);
+        }
+    }
+
+    Out[0] = (u8) Color0;
+    Out[1] = (u8) (Color0 >> 8);
+    Out[2] = (u8) Color1;
+    Out[3] = (u8) (Color1 >> 8);
+    Out[4] = (u8) Indices;
+    Out[5] = (u8) (Indices >> 8);
+    Out[6] = (u8) (Indices >> 16);
+    Out[7] = (u8) (Indices >> 24);
+}
+
+internal void
+BC4_BuildPalette_(u8 Value0, u8 Value1, u8 *Out_Palette)
+{
+    Out_Palette[0] = Value0;
+    Out_Palette[1] = Value1;
+
+    if (Value0 > Value1)
+    {
+        for (u32 Step = 1; Step <= 6; ++Step)
+        {
+            Out_Palette[1 + Step] = (u8) (((7 - Step) * Value0 + Step * Value1) / 7);
+        }
+    }
+    else
+    {
+        for (u32 Step = 1; Step <= 4; ++Step)
+        {
+            Out_Palette[1 + Step] = (u8) (((5 - Step) * Value0 + Step * Value1) / 5);
+        }
+        Out_Palette[6] = 0;
+        Out_Palette[7] = 255;
+    }
+}
+
+// NOTE: One channel, as used for BC3 alpha and both BC5 channels
+internal void
+BC4_EncodeBlock_(texture_block_pixels Pixels, u32 Channel, u8 *Out)
+{
+    u8 Value0 = 0;
+    u8 Value1 = 255;
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        Value0 = Max(Value0, Pixels[PixelIndex][Channel]);
+        Value1 = Min(Value1, Pixels[PixelIndex][Channel]);
+    }
+
+    u64 Indices = 0;
+    if (Value0 != Value1)
+    {
+        u8 Palette[8];
+        BC4_BuildPalette_(Value0, Value1, Palette);
+        for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+        {
+            u32 BestIndex = 0;
+            i32 BestError = 256;
+            for (u32 PaletteIndex = 0; PaletteIndex < 8; ++PaletteIndex)
+            {
+                i32 Error = (i32) Pixels[PixelIndex][Channel] - (i32) Palette[PaletteIndex];
+                Error = (Error < 0) ? -Error : Error;
+                if (Error < BestError)
+                {
+                    BestError = Error;
+                    BestIndex = PaletteIndex;
+                }
+            }
+            Indices |= (u64) BestIndex << (PixelIndex * 3);
+        }
+    }
+
+    Out[0] = Value0;
+    Out[1] = Value1;
+    for (u32 ByteIndex = 0; ByteIndex < 6; ++ByteIndex)
+    {
+        Out[2 + ByteIndex] = (u8) (Indices >> (ByteIndex * 8));
+    }
+}
+
+global_variable u32 GlobalBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+internal void
+BC7_PutBits_(u8 *Block, u32 *BitPosition, u32 Value, u32 BitCount)
+{
+    for (u32 Bit = 0; Bit < BitCount; ++Bit)
+    {
+        u32 Position = *BitPosition + Bit;
+        Block[Position / 8] |= (u8) (((Value >> Bit) & 1) << (Position % 8));
+    }
+    *BitPosition += BitCount;
+}
+
+internal u32
+BC7_GetBits_(u8 *Block, u32 *BitPosition, u32 BitCount)
+{
+    u32 Result = 0;
+    for (u32 Bit = 0; Bit < BitCount; ++Bit)
+    {
+        u32 Position = *BitPosition + Bit;
+        Result |= (u32) ((Block[Position / 8] >> (Position % 8)) & 1) << Bit;
+    }
+    *BitPosition += BitCount;
+    return Result;
+}
+
+internal void
+BC7_Mode6Palette_(u8 (*Endpoints)[4], u8 (*Out_Palette)[4])
+{
+    for (u32 Index = 0; Index < 16; ++Index)
+    {
+        u32 Weight = GlobalBC7Weights4[Index];
+        for (u32 C = 0; C < 4; ++C)
+        {
+            Out_Palette[Index][C] = (u8) (((64 - Weight) * Endpoints[0][C] + Weight * Endpoints[1][C] + 32) >> 6);
+        }
+    }
+}
+
+// NOTE: Mode 6, 7 bit RGBA endpoints plus a shared low bit per endpoint, and 4 bit indices
+internal void
+BC7_EncodeBlock_(texture_block_pixels Pixels, u8 *Out)
+{
+    f32 E[2][4];
+    TextureBlock_FindEndpoints_(Pixels, 4, E[0], E[1]);
+
+    u32 Quantized[2][4] = {};
+    u32 PBits[2] = {};
+    for (u32 EndpointIndex = 0; EndpointIndex < 2; ++EndpointIndex)
+    {
+        f32 BestError = FLT_MAX;
+        for (u32 PBit = 0; PBit < 2; ++PBit)
+        {
+            u32 Q[4];
+            f32 Error = 0.0f;
+            for (u32 C = 0; C < 4; ++C)
+            {
+                f32 Value = ClampF((E[EndpointIndex][C] - PBit) / 2.0f + 0.5f, 0.0f, 127.0f);
+                Q[C] = (u32) Value;
+                Error += Square((f32) ((Q[C] << 1) | PBit) - E[EndpointIndex][C]);
+            }
+            if (Error < BestError)
+            {
+                BestError = Error;
+                PBits[EndpointIndex] = PBit;
+                MemoryCopy(Quantized[EndpointIndex], Q, sizeof(Q));
+            }
+        }
+    }
+
+    u8 Endpoints[2][4];
+    for (u32 EndpointIndex = 0; EndpointIndex < 2; ++EndpointIndex)
+    {
+        for (u32 C = 0; C < 4; ++C)
+        {
+            Endpoints[EndpointIndex][C] = (u8) ((Quantized[EndpointIndex][C] << 1) | PBits[EndpointIndex]);
+        }
+    }
+
+    u8 Palette[16][4];
+    BC7_Mode6Palette_(Endpoints, Palette);
+
+    u32 Indices[16];
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        Indices[PixelIndex] = TextureBlock_NearestIndex_(Pixels[PixelIndex], Palette, 16, 4);
+    }
+
+    // NOTE: The first index is stored without its top bit, swapping the endpoints makes sure it's 0
+    if (Indices[0] & 8)
+    {
+        for (u32 C = 0; C < 4; ++C)
+        {
+            u32 Swap = Quantized[0][C];
+            Quantized[0][C] = Quantized[1][C];
+            Quantized[1][C] = Swap;
+        }
+        u32 Swap = PBits[0];
+        PBits[0] = PBits[1];
+        PBits[1] = Swap;
+
+        for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+        {
+            Indices[PixelIndex] = 15 - Indices[PixelIndex];
+        }
+    }
+
+    MemoryZero(Out, 16);
+    u32 BitPosition = 0;
+    BC7_PutBits_(Out, &BitPosition, 1 << 6, 7);
+    for (u32 C = 0; C < 4; ++C)
+    {
+        BC7_PutBits_(Out, &BitPosition, Quantized[0][C], 7);
+        BC7_PutBits_(Out, &BitPosition, Quantized[1][C], 7);
+    }
+    BC7_PutBits_(Out, &BitPosition, PBits[0], 1);
+    BC7_PutBits_(Out, &BitPosition, PBits[1], 1);
+    BC7_PutBits_(Out, &BitPosition, Indices[0], 3);
+    for (u32 PixelIndex = 1; PixelIndex < 16; ++PixelIndex)
+    {
+        BC7_PutBits_(Out, &BitPosition, Indices[PixelIndex], 4);
+    }
+    Assert(BitPosition == 128);
+}
+
+// NOTE: Box filtered, odd sizes repeat their last row and column. Normal maps are renormalized, averaging them
+// shortens the normals.
+internal void
+CookedTexture_BuildMip_(u8 *Source, u32 SourceWidth, u32 SourceHeight, u8 *Dest, u32 Width, u32 Height, b32 IsNormalMap)
+{
+    for (u32 Y = 0; Y < Height; ++Y)
+    {
+        u32 Y0 = Min(Y * 2, SourceHeight - 1);
+        u32 Y1 = Min(Y * 2 + 1, SourceHeight - 1);
+        for (u32 X = 0; X < Width; ++X)
+        {
+            u32 X0 = Min(X * 2, SourceWidth - 1);
+            u32 X1 = Min(X * 2 + 1, SourceWidth - 1);
+
+            u8 *S00 = Source + (Y0 * SourceWidth + X0) * 4;
+            u8 *S01 = Source + (Y0 * SourceWidth + X1) * 4;
+            u8 *S10 = Source + (Y1 * SourceWidth + X0) * 4;
+            u8 *S11 = Source + (Y1 * SourceWidth + X1) * 4;
+            u8 *D = Dest + (Y * Width + X) * 4;
+
+            for (u32 C = 0; C < 4; ++C)
+            {
+                D[C] = (u8) ((S00[C] + S01[C] + S10[C] + S11[C] + 2) / 4);
+            }
+
+            if (IsNormalMap)
+            {
+                f32 N[3];
+                f32 LengthSquared = 0.0f;
+                for (u32 C = 0; C < 3; ++C)
+                {
+                    N[C] = (S00[C] + S01[C] + S10[C] + S11[C]) / (4.0f * 127.5f) - 1.0f;
+                    LengthSquared += N[C] * N[C];
+                }
+
+                if (LengthSquared > 1e-8f)
+                {
+                    f32 InvLength = 1.0f / SqrtF(LengthSquared);
+                    for (u32 C = 0; C < 3; ++C)
+                    {
+                        D[C] = (u8) ClampF((N[C] * InvLength + 1.0f) * 127.5f + 0.5f, 0.0f, 255.0f);
+                    }
+                }
+            }
+        }
+    }
+}
+
+internal void
+CookedTexture_EncodeMip_(u8 *Pixels, u32 Width, u32 Height, texture_format Format, u8 *Out)
+{
+    u32 BlockSize = TextureFormat_BlockSize(Format);
+    u32 BlocksX = (Width + 3) / 4;
+    u32 BlocksY = (Height + 3) / 4;
+
+    for (u32 BlockY = 0; BlockY < BlocksY; ++BlockY)
+    {
+        for (u32 BlockX = 0; BlockX < BlocksX; ++BlockX)
+        {
+            texture_block_pixels Block;
+            TextureBlock_Fetch_(Pixels, Width, Height, BlockX, BlockY, Block);
+            u8 *Dest = Out + (BlockY * BlocksX + BlockX) * BlockSize;
+
+            switch (Format)
+            {
+                case TEXTURE_FORMAT_BC1:
+                {
+                    BC1_EncodeBlock_(Block, Dest);
+                } break;
+
+                case TEXTURE_FORMAT_BC3:
+                {
+                    BC4_EncodeBlock_(Block, 3, Dest);
+                    BC1_EncodeBlock_(Block, Dest + 8);
+                } break;
+
+                case TEXTURE_FORMAT_BC5:
+                {
+                    BC4_EncodeBlock_(Block, 0, Dest);
+                    BC4_EncodeBlock_(Block, 1, Dest + 8);
+                } break;
+
+                case TEXTURE_FORMAT_BC7:
+                {
+                    BC7_EncodeBlock_(Block, Dest);
+                } break;
+
+                default:
+                {
+                    InvalidCodePath;
+                } break;
+            }
+        }
+    }
+}
+
+texture_format
+CookedTexture_ChooseFormat(platform_image *Image, b32 IsNormalMap, b32 PreferBC7)
+{
+    if (IsNormalMap)
+    {
+        return TEXTURE_FORMAT_BC5;
+    }
+    if (PreferBC7)
+    {
+        return TEXTURE_FORMAT_BC7;
+    }
+
+    b32 HasAlpha = false;
+    if (Image->BytesPerPixel == 4)
+    {
+        for (u32 Y = 0; Y < Image->Height && !HasAlpha; ++Y)
+        {
+            u8 *Row = Image->ImageData + Y * Image->Pitch;
+            for (u32 X = 0; X < Image->Width; ++X)
+            {
+                if (Row[X * 4 + 3] != 255)
+                {
+                    HasAlpha = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    texture_format Result = HasAlpha ? TEXTURE_FORMAT_BC3 : TEXTURE_FORMAT_BC1;
+    return Result;
+}
+
+b32
+CookedTexture_Write(const char *Path, platform_image *Image, texture_format Format, b32 IsNormalMap,
+                    u64 SourceWriteTime, memory_arena *TempArena)
+{
+    Assert(TextureFormat_IsCompressed(Format));
+    Assert(Image->BytesPerPixel == 4 || Image->BytesPerPixel == 3);
+
+    temporary_memory WriteMemory = MemoryArena_BeginTemp(TempArena);
+    memory_arena Blob = MemoryArenaNested(TempArena, COOKED_TEXTURE_MAX_SIZE);
+    memory_arena PixelArena = MemoryArenaNested(TempArena, COOKED_TEXTURE_MAX_PIXELS_SIZE);
+
+    cooked_texture_header *Header = MemoryArena_PushStruct(&Blob, cooked_texture_header);
+    *Header = {};
+
+    u32 Width = Image->Width;
+    u32 Height = Image->Height;
+
+    // NOTE: Everything's filtered and encoded from RGBA8
+    u8 *Pixels = MemoryArena_PushBytesAligned(&PixelArena, (size_t) Width * Height * 4, ARENA_ALIGN_CACHE_LINE);
+    for (u32 Y = 0; Y < Height; ++Y)
+    {
+        u8 *SourceRow = Image->ImageData + Y * Image->Pitch;
+        for (u32 X = 0; X < Width; ++X)
+        {
+            u8 *S = SourceRow + X * Image->BytesPerPixel;
+            u8 *D = Pixels + ((size_t) Y * Width + X) * 4;
+            D[0] = S[0];
+            D[1] = S[1];
+            D[2] = S[2];
+            D[3] = (Image->BytesPerPixel == 4) ? S[3] : 255;
+        }
+    }
+
+    u32 MipCount = 1;
+    while (MipCount < COOKED_TEXTURE_MAX_MIPS && ((Width >> MipCount) > 0 || (Height >> MipCount) > 0))
+    {
+        MipCount++;
+    }
+
+    for (u32 MipIndex = 0;
+         MipIndex < MipCount;
+         ++MipIndex)
+    {
+        u32 MipWidth = TextureMipDimension(Width, MipIndex);
+        u32 MipHeight = TextureMipDimension(Height, MipIndex);
+
+        if (MipIndex > 0)
+        {
+            u32 PreviousWidth = TextureMipDimension(Width, MipIndex - 1);
+            u32 PreviousHeight = TextureMipDimension(Height, MipIndex - 1);
+            u8 *MipPixels = MemoryArena_PushBytesAligned(&PixelArena, (size_t) MipWidth * MipHeight * 4, ARENA_ALIGN_CACHE_LINE);
+            CookedTexture_BuildMip_(Pixels, PreviousWidth, PreviousHeight, MipPixels, MipWidth, MipHeight, IsNormalMap);
+            Pixels = MipPixels;
+        }
+
+        size_t MipSize = TextureFormat_MipSize(Format, MipWidth, MipHeight);
+        u8 *MipBlocks = MemoryArena_PushBytesAligned(&Blob, MipSize, ARENA_ALIGN_SSE);
+        CookedTexture_EncodeMip_(Pixels, MipWidth, MipHeight, Format, MipBlocks);
+
+        Header->Mips[MipIndex].Offset = (u64) (MipBlocks - Blob.Base);
+        Header->Mips[MipIndex].Size = MipSize;
+    }
+
+    Header->Magic = COOKED_TEXTURE_MAGIC;
+    Header->Version = COOKED_TEXTURE_VERSION;
+    Header->Format = Format;
+    Header->Width = Width;
+    Header->Height = Height;
+    Header->MipCount = MipCount;
+    Header->FileSize = Blob.Used;
+    Header->SourceWriteTime = SourceWriteTime;
+
+    b32 Result = Platform_WriteFile(Path, Blob.Base, Blob.Used);
+
+    MemoryArena_EndTemp(WriteMemory);
+    return Result;
+}
+
+//
+// NOTE: Loading (game)
+//
+internal b32
+CookedTexture_IsValid_(cooked_texture_header *Header, u64 FileSize)
+{
+    if (Header->Magic != COOKED_TEXTURE_MAGIC || Header->Version != COOKED_TEXTURE_VERSION ||
+        Header->FileSize != FileSize || !TextureFormat_IsCompressed((texture_format) Header->Format) ||
+        Header->Format >= TEXTURE_FORMAT_COUNT || Header->Width == 0 || Header->Height == 0 ||
+        Header->MipCount == 0 || Header->MipCount > COOKED_TEXTURE_MAX_MIPS)
+    {
+        return false;
+    }
+
+    for (u32 MipIndex = 0;
+         MipIndex < Header->MipCount;
+         ++MipIndex)
+    {
+        cooked_texture_mip *Mip = Header->Mips + MipIndex;
+        u64 ExpectedSize = TextureFormat_MipSize((texture_format) Header->Format,
+                                                 TextureMipDimension(Header->Width, MipIndex),
+                                                 TextureMipDimension(Header->Height, MipIndex));
+        if (Mip->Size != ExpectedSize || Mip->Offset > FileSize || Mip->Size > (FileSize - Mip->Offset))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+b32
+CookedTexture_Map(const char *Path, const char *SourcePath, platform_mapped_file *Out_File, texture_data *Out_Texture)
+{
+    platform_mapped_file MappedFile = Platform_MapFile(Path, MapHint_Sequential);
+    if (!MappedFile.Data)
+    {
+        return false;
+    }
+
+    // NOTE: The header is only read once it's known to be in the file
+    cooked_texture_header *Header = (cooked_texture_header *) MappedFile.Data;
+    if (MappedFile.Size < sizeof(cooked_texture_header) || !CookedTexture_IsValid_(Header, MappedFile.Size))
+    {
+        printf("COOKER: %s is broken or from another version\n", Path);
+        Platform_UnmapFile(&MappedFile);
+        return false;
+    }
+
+    u64 SourceWriteTime;
+    if (Platform_GetFileWriteTime(SourcePath, &SourceWriteTime) && SourceWriteTime != Header->SourceWriteTime)
+    {
+        printf("COOKER: %s is stale, cook %s again\n", Path, SourcePath);
+        Platform_UnmapFile(&MappedFile);
+        return false;
+    }
+
+    texture_data Texture = {};
+    Texture.Format = (texture_format) Header->Format;
+    Texture.Width = Header->Width;
+    Texture.Height = Header->Height;
+    Texture.MipCount = Header->MipCount;
+    for (u32 MipIndex = 0;
+         MipIndex < Header->MipCount;
+         ++MipIndex)
+    {
+        Texture.Mips[MipIndex] = (u8 *) MappedFile.Data + Header->Mips[MipIndex].Offset;
+        Texture.MipSizes[MipIndex] = Header->Mips[MipIndex].Size;
+    }
+
+    *Out_File = MappedFile;
+    *Out_Texture = Texture;
+    return true;
+}
+
+//
+// NOTE: CPU decoding, for drivers that can't sample a format
+//
+internal void
+BC1_DecodeBlock_(u8 *Block, b32 FourColorsAlways, texture_block_pixels Out)
+{
+    u16 Color0 = (u16) (Block[0] | (Block[1] << 8));
+    u16 Color1 = (u16) (Block[2] | (Block[3] << 8));
+    u32 Indices = (u32) Block[4] | ((u32) Block[5] << 8) | ((u32) Block[6] << 16) | ((u32) Block[7] << 24);
+
+    u8 Palette[4][4];
+    BC1_BuildPalette_(Color0, Color1, FourColorsAlways, Palette);
+
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        MemoryCopy(Out[PixelIndex], Palette[(Indices >> (PixelIndex * 2)) & 3], 4);
+        // NOTE: Uploaded as RGB DXT1, which has no alpha
+        Out[PixelIndex][3] = 255;
+    }
+}
+
+internal void
+BC4_DecodeBlock_(u8 *Block, u32 Channel, texture_block_pixels Out)
+{
+    u8 Palette[8];
+    BC4_BuildPalette_(Block[0], Block[1], Palette);
+
+    u64 Indices = 0;
+    for (u32 ByteIndex = 0; ByteIndex < 6; ++ByteIndex)
+    {
+        Indices |= (u64) Block[2 + ByteIndex] << (ByteIndex * 8);
+    }
+
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        Out[PixelIndex][Channel] = Palette[(Indices >> (PixelIndex * 3)) & 7];
+    }
+}
+
+internal void
+BC7_DecodeBlock_(u8 *Block, texture_block_pixels Out)
+{
+    if ((Block[0] & 0x7F) != 0x40)
+    {
+        // NOTE: Not mode 6, which is all the cooker writes. Magenta, so it stands out.
+        for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+        {
+            Out[PixelIndex][0] = 255;
+            Out[PixelIndex][1] = 0;
+            Out[PixelIndex][2] = 255;
+            Out[PixelIndex][3] = 255;
+        }
+        return;
+    }
+
+    u32 BitPosition = 7;
+    u32 Quantized[2][4];
+    for (u32 C = 0; C < 4; ++C)
+    {
+        Quantized[0][C] = BC7_GetBits_(Block, &BitPosition, 7);
+        Quantized[1][C] = BC7_GetBits_(Block, &BitPosition, 7);
+    }
+    u32 PBit0 = BC7_GetBits_(Block, &BitPosition, 1);
+    u32 PBit1 = BC7_GetBits_(Block, &BitPosition, 1);
+
+    u8 Endpoints[2][4];
+    for (u32 C = 0; C < 4; ++C)
+    {
+        Endpoints[0][C] = (u8) ((Quantized[0][C] << 1) | PBit0);
+        Endpoints[1][C] = (u8) ((Quantized[1][C] << 1) | PBit1);
+    }
+
+    u8 Palette[16][4];
+    BC7_Mode6Palette_(Endpoints, Palette);
+
+    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+    {
+        u32 Index = BC7_GetBits_(Block, &BitPosition, (PixelIndex == 0) ? 3 : 4);
+        MemoryCopy(Out[PixelIndex], Palette[Index], 4);
+    }
+}
+
+void
+TextureBlocks_DecodeToRGBA8(texture_format Format, u8 *Blocks, u32 Width, u32 Height, u8 *Out)
+{
+    u32 BlockSize = TextureFormat_BlockSize(Format);
+    u32 BlocksX = (Width + 3) / 4;
+    u32 BlocksY = (Height + 3) / 4;
+
+    for (u32 BlockY = 0; BlockY < BlocksY; ++BlockY)
+    {
+        for (u32 BlockX = 0; BlockX < BlocksX; ++BlockX)
+        {
+            u8 *Block = Blocks + (BlockY * BlocksX + BlockX) * BlockSize;
+            texture_block_pixels Pixels;
+
+            switch (Format)
+            {
+                case TEXTURE_FORMAT_BC1:
+                {
+                    BC1_DecodeBlock_(Block, false, Pixels);
+                } break;
+
+                case TEXTURE_FORMAT_BC3:
+                {
+                    BC1_DecodeBlock_(Block + 8, true, Pixels);
+                    BC4_DecodeBlock_(Block, 3, Pixels);
+                } break;
+
+                case TEXTURE_FORMAT_BC5:
+                {
+                    // NOTE: Same as sampling an RG texture
+                    for (u32 PixelIndex = 0; PixelIndex < 16; ++PixelIndex)
+                    {
+                        Pixels[PixelIndex][2] = 0;
+                        Pixels[PixelIndex][3] = 255;
+                    }
+                    BC4_DecodeBlock_(Block, 0, Pixels);
+                    BC4_DecodeBlock_(Block + 8, 1, Pixels);
+                } break;
+
+                case TEXTURE_FORMAT_BC7:
+                {
+                    BC7_DecodeBlock_(Block, Pixels);
+                } break;
+
+                default:
+                {
+                    InvalidCodePath;
+                } break;
+            }
+
+            for (u32 Y = 0; Y < 4 && BlockY * 4 + Y < Height; ++Y)
+            {
+                for (u32 X = 0; X < 4 && BlockX * 4 + X < Width; ++X)
+                {
+                    u8 *D = Out + ((size_t) (BlockY * 4 + Y) * Width + (BlockX * 4 + X)) * 4;
+                    MemoryCopy(D, Pixels[Y * 4 + X], 4);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#ifndef OPUSONE_COOKED_TEXTURE_H
+#define OPUSONE_COOKED_TEXTURE_H
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+
+// NOTE: Textures block compressed by opusone_cooker, with the whole mip chain filtered offline, written next to
+// the source image as <Path>.ctex. The game uploads the blocks as they are (glCompressedTexImage2D), which takes
+// 4-8x less memory and bandwidth than RGBA8 and skips generating mips at load. Where the driver can't sample a
+// format the blocks are decoded to RGBA8 on the CPU instead (see TextureUploadQueue_Pump), mips and all.
+//
+// Color textures are BC1 (opaque) or BC3 (with alpha), or BC7 if the cooker is asked to. Normal maps are BC5, which
+// only keeps X and Y, so shaders rebuild Z. The BC7 encoder only writes mode 6 blocks (one subset, RGBA), and the
+// CPU decoder only reads those.
+#define COOKED_TEXTURE_MAGIC 0x43584554 // NOTE: "TEXC"
+#define COOKED_TEXTURE_VERSION 1
+#define COOKED_TEXTURE_EXTENSION ".ctex"
+#define COOKED_TEXTURE_MAX_MIPS 16
+
+enum texture_format
+{
+    TEXTURE_FORMAT_NONE,
+    TEXTURE_FORMAT_RGB8,
+    TEXTURE_FORMAT_RGBA8,
+    TEXTURE_FORMAT_BC1,
+    TEXTURE_FORMAT_BC3,
+    TEXTURE_FORMAT_BC5,
+    TEXTURE_FORMAT_BC7,
+    TEXTURE_FORMAT_COUNT
+};
+
+inline const char *
+TextureFormat_Name(texture_format Format)
+{
+    const char *Names[TEXTURE_FORMAT_COUNT] = { "None", "RGB8", "RGBA8", "BC1", "BC3", "BC5", "BC7" };
+    const char *Result = (Format < TEXTURE_FORMAT_COUNT) ? Names[Format] : "?";
+    return Result;
+}
+
+inline b32
+TextureFormat_IsCompressed(texture_format Format)
+{
+    b32 Result = (Format >= TEXTURE_FORMAT_BC1);
+    return Result;
+}
+
+// NOTE: Bytes per 4x4 block for compressed formats, per pixel otherwise
+inline u32
+TextureFormat_BlockSize(texture_format Format)
+{
+    switch (Format)
+    {
+        case TEXTURE_FORMAT_RGB8: return 3;
+        case TEXTURE_FORMAT_RGBA8: return 4;
+        case TEXTURE_FORMAT_BC1: return 8;
+        case TEXTURE_FORMAT_BC3: return 16;
+        case TEXTURE_FORMAT_BC5: return 16;
+        case TEXTURE_FORMAT_BC7: return 16;
+        default: InvalidCodePath; return 0;
+    }
+}
+
+inline size_t
+TextureFormat_MipSize(texture_format Format, u32 Width, u32 Height)
+{
+    size_t Result;
+    if (TextureFormat_IsCompressed(Format))
+    {
+        Result = (size_t) ((Width + 3) / 4) * ((Height + 3) / 4) * TextureFormat_BlockSize(Format);
+    }
+    else
+    {
+        Result = (size_t) Width * Height * TextureFormat_BlockSize(Format);
+    }
+    return Result;
+}
+
+inline u32
+TextureMipDimension(u32 Dimension, u32 MipIndex)
+{
+    u32 Result = Max(Dimension >> MipIndex, 1u);
+    return Result;
+}
+
+struct cooked_texture_mip
+{
+    u64 Offset;
+    u64 Size;
+};
+
+struct cooked_texture_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 Format; // NOTE: texture_format
+    u32 Width;
+    u32 Height;
+    u32 MipCount;
+
+    u64 FileSize;
+    u64 SourceWriteTime; // NOTE: A source written after this makes the cooked texture stale
+
+    cooked_texture_mip Mips[COOKED_TEXTURE_MAX_MIPS];
+};
+
+// NOTE: A texture ready to upload, either a cooked mip chain or a decoded image (one level, GenerateMips set).
+// Doesn't own the pixels.
+struct texture_data
+{
+    texture_format Format;
+    u32 Width;
+    u32 Height;
+    u32 MipCount;
+    b32 GenerateMips;
+
+    u8 *Mips[COOKED_TEXTURE_MAX_MIPS];
+    size_t MipSizes[COOKED_TEXTURE_MAX_MIPS];
+};
+
+texture_data
+TextureData_FromImage(platform_image *Image);
+
+// NOTE: BC5 for normal maps, otherwise BC7 if asked for, or else BC1 unless the image has alpha
+texture_format
+CookedTexture_ChooseFormat(platform_image *Image, b32 IsNormalMap, b32 PreferBC7);
+
+// NOTE: Normal maps get their mips renormalized and go to BC5, see the top of this file
+b32
+CookedTexture_Write(const char *Path, platform_image *Image, texture_format Format, b32 IsNormalMap,
+                    u64 SourceWriteTime, memory_arena *TempArena);
+
+// NOTE: Maps the cooked texture and points Out_Texture into the mapping, the caller unmaps it when it's done with
+// the texture. False if there's no cooked texture at Path, it's broken, from another version or older than SourcePath.
+b32
+CookedTexture_Map(const char *Path, const char *SourcePath, platform_mapped_file *Out_File, texture_data *Out_Texture);
+
+// NOTE: CPU fallback for formats the driver can't sample, Out is Width * Height RGBA8
+void
+TextureBlocks_DecodeToRGBA8(texture_format Format, u8 *Blocks, u32 Width, u32 Height, u8 *Out);
+
+#endif
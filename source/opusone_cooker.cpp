@@ -0,0 +1,185 @@
+// NOTE: Offline model cooker. Imports each model with Assimp, the way the game used to on every launch, and writes
+// the result next to it as <Path>.cooked (see opusone_cooked_model.h), which the game loads instead. Texture paths
+// are stored the way the importer builds them, so run it from the same directory as the game.
+//
+// The model's textures are cooked too, block compressed with their mips to <Path>.ctex (see
+// opusone_cooked_texture.h). -bc7 makes color textures BC7 instead of BC1/BC3, it looks better but drivers older
+// than GL 4.2 can't sample it and the game decodes it on the CPU then.
+//
+// Models and textures that are already cooked and newer than their sources are skipped, build.sh runs the cooker
+// on every build.
+//
+// Usage: opusone_cooker [-bc7] <Model>...    e.g. build/opusone_cooker resources/models/*/*.gltf
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_platform_services.cpp"
+
+#include "opusone_string_id.h"
+#include "opusone_assimp.h"
+#include "opusone_cooked_model.h"
+#include "opusone_cooked_texture.h"
+
+#include "opusone_assimp.cpp"
+#include "opusone_cooked_model.cpp"
+#include "opusone_cooked_texture.cpp"
+
+internal b32
+CookTexture(const char *Path, b32 IsNormalMap, b32 PreferBC7, memory_arena *Arena)
+{
+    u64 SourceWriteTime;
+    if (!Platform_GetFileWriteTime(Path, &SourceWriteTime))
+    {
+        printf("COOKER: Could not open %s\n", Path);
+        return false;
+    }
+
+    char CookedPath[256];
+    FormatString(CookedPath, sizeof(CookedPath), "%s%s", Path, COOKED_TEXTURE_EXTENSION);
+
+    // NOTE: Up to date unless -bc7 changed what color textures should be
+    platform_mapped_file CookedFile;
+    texture_data Cooked;
+    if (CookedTexture_Map(CookedPath, Path, &CookedFile, &Cooked))
+    {
+        b32 UpToDate = IsNormalMap || (PreferBC7 == (Cooked.Format == TEXTURE_FORMAT_BC7));
+        Platform_UnmapFile(&CookedFile);
+        if (UpToDate)
+        {
+            return true;
+        }
+    }
+
+    u64 StartCounter = SDL_GetPerformanceCounter();
+
+    platform_image Image = Platform_LoadImage(Path);
+    texture_format Format = CookedTexture_ChooseFormat(&Image, IsNormalMap, PreferBC7);
+    b32 Written = CookedTexture_Write(CookedPath, &Image, Format, IsNormalMap, SourceWriteTime, Arena);
+    Platform_FreeImage(&Image);
+
+    f64 Ms = (f64) (SDL_GetPerformanceCounter() - StartCounter) * 1000.0 / (f64) SDL_GetPerformanceFrequency();
+
+    size_t CookedSize = 0;
+    if (Written && Platform_GetFileSize(CookedPath, &CookedSize))
+    {
+        printf("COOKER: %s -> %s (%s, %u KB, %0.1fms)\n", Path, CookedPath, TextureFormat_Name(Format), (u32) (CookedSize / 1024), Ms);
+        return true;
+    }
+
+    printf("COOKER: Could not write %s\n", CookedPath);
+    return false;
+}
+
+int
+main(int Argc, char *Argv[])
+{
+    i32 FirstModelArg = 1;
+    b32 PreferBC7 = false;
+    if (Argc > 1 && CompareStrings(Argv[1], "-bc7"))
+    {
+        PreferBC7 = true;
+        FirstModelArg++;
+    }
+
+    if (Argc <= FirstModelArg)
+    {
+        printf("Usage: opusone_cooker [-bc7] <Model>...\n");
+        return 1;
+    }
+
+    size_t ArenaSize = Gigabytes(4);
+    memory_arena Arena = MemoryArenaReserved((u8 *) ReserveMemory(ArenaSize), ArenaSize);
+    Assert(Arena.Base);
+    memory_arena StringArena = MemoryArenaNested(&Arena, Megabytes(64));
+    GlobalStringTable = StringTable(&StringArena, 4096);
+
+    // NOTE: Models share textures, each is cooked once
+    hash_map<string_id, b32> CookedTextures = HashMap<string_id, b32>(&StringArena, 256);
+
+    u32 FailedCount = 0;
+    for (i32 ArgIndex = FirstModelArg;
+         ArgIndex < Argc;
+         ++ArgIndex)
+    {
+        const char *Path = Argv[ArgIndex];
+
+        u64 SourceWriteTime;
+        if (!CookedModel_GetSourceWriteTime(Path, &SourceWriteTime))
+        {
+            printf("COOKER: Could not open %s\n", Path);
+            FailedCount++;
+            continue;
+        }
+
+        char CookedPath[256];
+        FormatString(CookedPath, sizeof(CookedPath), "%s%s", Path, COOKED_MODEL_EXTENSION);
+
+        u64 StartCounter = SDL_GetPerformanceCounter();
+        temporary_memory ModelMemory = MemoryArena_BeginTemp(&Arena);
+
+        // NOTE: build.sh cooks on every build, models that are up to date only get their textures checked
+        imported_model *Model = CookedModel_Load(&Arena, CookedPath, Path);
+        if (Model)
+        {
+            printf("COOKER: %s is up to date\n", CookedPath);
+        }
+        else
+        {
+            // NOTE: A model that doesn't import is skipped, the rest still cook and the game imports that one at
+            // runtime (internal builds), which reports the same error
+            Model = Assimp_LoadModel(&Arena, Path);
+            if (!Model)
+            {
+                printf("COOKER: Skipping %s, it could not be imported\n", Path);
+                MemoryArena_EndTemp(ModelMemory);
+                FailedCount++;
+                continue;
+            }
+
+            b32 Written = CookedModel_Write(CookedPath, Model, SourceWriteTime, &Arena);
+            f64 Ms = (f64) (SDL_GetPerformanceCounter() - StartCounter) * 1000.0 / (f64) SDL_GetPerformanceFrequency();
+
+            size_t CookedSize = 0;
+            if (Written && Platform_GetFileSize(CookedPath, &CookedSize))
+            {
+                printf("COOKER: %s -> %s (%u KB, %0.1fms)\n", Path, CookedPath, (u32) (CookedSize / 1024), Ms);
+            }
+            else
+            {
+                printf("COOKER: Could not write %s\n", CookedPath);
+                FailedCount++;
+            }
+        }
+
+        for (u32 MaterialIndex = 0;
+             MaterialIndex < Model->MaterialCount;
+             ++MaterialIndex)
+        {
+            imported_material *Material = Model->Materials + MaterialIndex;
+            for (u32 TextureType = 0;
+                 TextureType < TEXTURE_TYPE_COUNT;
+                 ++TextureType)
+            {
+                string_id TexturePath = Material->TexturePaths[TextureType];
+                if (!TexturePath)
+                {
+                    continue;
+                }
+
+                b32 WasAdded;
+                HashMap_FindOrAdd(&CookedTextures, TexturePath, &WasAdded);
+                if (WasAdded && !CookTexture(StringID_GetString(TexturePath), (TextureType == TEXTURE_TYPE_NORMAL), PreferBC7, &Arena))
+                {
+                    FailedCount++;
+                }
+            }
+        }
+
+        MemoryArena_EndTemp(ModelMemory);
+    }
+
+    return (FailedCount > 0) ? 1 : 0;
+}
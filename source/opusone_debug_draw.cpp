@@ -83,6 +83,8 @@ DD_DrawEllipsoid(render_unit *RenderUnit, vec3 Position, f32 XRadius, f32 YRadiu
 
     u32 VertexCount = 2 + (RingCount - 2) * SectorCount;
     u32 IndexCount = (RingCount - 2) * SectorCount * 6;
+
+    temporary_memory VertexMemory = MemoryArena_BeginTemp(TransientArena);
     
     vec3 *Vertices = MemoryArena_PushArray(TransientArena, VertexCount, vec3);
     vec3 *Normals = MemoryArena_PushArray(TransientArena, VertexCount, vec3);
@@ -206,6 +208,8 @@ DD_DrawEllipsoid(render_unit *RenderUnit, vec3 Position, f32 XRadius, f32 YRadiu
     Assert(AttribCount <= ArrayCount(AttribData));
 
     SubVertexDataForRenderUnit(RenderUnit, AttribData, AttribCount, Indices, VertexCount, IndexCount);
+
+    MemoryArena_EndTemp(VertexMemory);
 }
 
 
@@ -12,14 +12,24 @@ entity *
 AddEntity(game_state *GameState,
           entity_type EntityType, vec3 Position, quat Rotation, vec3 Scale, b32 IsInvisible)
 {
-    Assert((GameState->EntityCount + 1) < ArrayCount(GameState->Entities));
-
-    entity *Entity = GameState->Entities + GameState->EntityCount++;
+    entity *Entity;
+    if (GameState->FirstFreeEntity)
+    {
+        // NOTE: Reuse a slot freed by RemoveEntity
+        Entity = GameState->FirstFreeEntity;
+        GameState->FirstFreeEntity = Entity->NextFree;
+    }
+    else
+    {
+        Assert((GameState->EntityCount + 1) < ArrayCount(GameState->Entities));
+        Entity = GameState->Entities + GameState->EntityCount++;
+    }
     *Entity = {};
 
     // NOTE: General entity params
     Entity->Type = EntityType;
     Entity->WorldPosition = WorldPosition(Position, Rotation, Scale);
+    Entity->PrevWorldPosition = Entity->WorldPosition;
     Entity->IsInvisible = IsInvisible;
 
     entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
@@ -29,9 +39,8 @@ AddEntity(game_state *GameState,
     if (EntityType != EntityType_Player &&
         ImportedModel->Armature && ImportedModel->Animations && ImportedModel->AnimationCount > 0)
     {
-        Entity->AnimationState = MemoryArena_PushStruct(&GameState->WorldArena, animation_state);
+        Entity->AnimationState = MemoryPool_Alloc(&GameState->AnimationStatePool, animation_state);
         animation_state *AnimationState = Entity->AnimationState;
-        *AnimationState = {};
         
         AnimationState->Armature = ImportedModel->Armature;
 
@@ -63,23 +72,101 @@ AddEntity(game_state *GameState,
             Assert(Marker->StateT == RENDER_STATE_MESH);
             render_state_mesh *Mesh = &Marker->StateD.Mesh;
 
-            b32 SlotFound = false;
-            for (u32 SlotIndex = 0;
-                 SlotIndex < MAX_INSTANCES_PER_MESH;
-                 ++SlotIndex)
+            // NOTE: Instances are kept packed at the front, so the next free slot is always at InstanceCount
+            Assert(Mesh->InstanceCount < MAX_INSTANCES_PER_MESH);
+            Mesh->EntityInstances[Mesh->InstanceCount++] = Entity;
+        }
+    }
+
+    return Entity;
+}
+
+void
+RemoveEntity(game_state *GameState, entity *Entity)
+{
+    Assert(Entity);
+    Assert(Entity->Type != EntityType_None);
+    // NOTE: The frame update needs a player, remove it by adding the new one first and repointing PlayerEntity
+    Assert(Entity != GameState->PlayerEntity);
+
+    MemoryPool_Free(&GameState->AnimationStatePool, Entity->AnimationState);
+
+    // NOTE: Take the instance out of the model's render unit markers, keeping the instance slots packed
+    entity_type_spec *Spec = GameState->EntityTypeSpecs + Entity->Type;
+    render_unit *RenderUnit = Spec->RenderUnit;
+    for (u32 MeshIndex = 0;
+         MeshIndex < Spec->MeshCount;
+         ++MeshIndex)
+    {
+        render_marker *Marker = RenderUnit->Markers + Spec->BaseMeshID + MeshIndex;
+        Assert(Marker->StateT == RENDER_STATE_MESH);
+        render_state_mesh *Mesh = &Marker->StateD.Mesh;
+
+        b32 InstanceFound = false;
+        for (u32 SlotIndex = 0;
+             SlotIndex < Mesh->InstanceCount;
+             ++SlotIndex)
+        {
+            if (Mesh->EntityInstances[SlotIndex] == Entity)
             {
-                if (Mesh->EntityInstances[SlotIndex] == 0)
-                {
-                    Mesh->EntityInstances[SlotIndex] = Entity;
-                    SlotFound = true;
-                    break;
-                }
+                Mesh->EntityInstances[SlotIndex] = Mesh->EntityInstances[--Mesh->InstanceCount];
+                Mesh->EntityInstances[Mesh->InstanceCount] = 0;
+                InstanceFound = true;
+                break;
             }
-            Assert(SlotFound);
         }
+        Assert(InstanceFound);
     }
 
-    return Entity;
+    *Entity = {};
+    Entity->NextFree = GameState->FirstFreeEntity;
+    GameState->FirstFreeEntity = Entity;
+}
+
+b32
+CanAddEntity(game_state *GameState, entity_type EntityType)
+{
+    if (!GameState->FirstFreeEntity && (GameState->EntityCount + 1) >= ArrayCount(GameState->Entities))
+    {
+        return false;
+    }
+
+    entity_type_spec *Spec = GameState->EntityTypeSpecs + EntityType;
+    for (u32 MeshIndex = 0;
+         MeshIndex < Spec->MeshCount;
+         ++MeshIndex)
+    {
+        render_marker *Marker = Spec->RenderUnit->Markers + Spec->BaseMeshID + MeshIndex;
+        if (Marker->StateD.Mesh.InstanceCount >= MAX_INSTANCES_PER_MESH)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+entity *
+FindClosestEntity(game_state *GameState, entity_type EntityType, vec3 Position)
+{
+    entity *Result = 0;
+    f32 ClosestDistanceSq = FLT_MAX;
+    for (u32 EntityIndex = 0;
+         EntityIndex < GameState->EntityCount;
+         ++EntityIndex)
+    {
+        entity *Entity = GameState->Entities + EntityIndex;
+        if (Entity->Type == EntityType)
+        {
+            f32 DistanceSq = VecLengthSq(Entity->WorldPosition.P - Position);
+            if (DistanceSq < ClosestDistanceSq)
+            {
+                ClosestDistanceSq = DistanceSq;
+                Result = Entity;
+            }
+        }
+    }
+    return Result;
 }
 
 vec3
@@ -103,7 +190,7 @@ EntityCollideWithWorld(entity *MovingEntity, vec3 OneOverEllipsoidDim, vec3 eEnt
     vec3 CollisionPoint;
     b32 FoundCollision = EntityTriangleCollide(eEntityP, eEntityDeltaP, eA, eB, eC, &TimeOfImpact, &CollisionPoint);
 
-    ImmText_DrawQuickString(SimpleStringF("FoundCollision: %d", FoundCollision).D);
+    ImmText_DrawQuickStringF("FoundCollision: %d", FoundCollision);
 
     if (!FoundCollision)
     {
@@ -179,7 +266,7 @@ EntityIntegrateAndMove(entity *MovingEntity, vec3 EntityEllipsoidDim, vec3 Entit
     }
 
     vec3 ActualDeltaP = (EntityP-Vec3(0,EntityEllipsoidDim.Y,0)) - MovingEntity->WorldPosition.P;
-    ImmText_DrawQuickString(SimpleStringF("DeltaP=<%0.3f,%0.3f,%0.3f>", ActualDeltaP.X, ActualDeltaP.Y, ActualDeltaP.Z).D);
+    ImmText_DrawQuickStringF("DeltaP=<%0.3f,%0.3f,%0.3f>", ActualDeltaP.X, ActualDeltaP.Y, ActualDeltaP.Z);
 
     MovingEntity->WorldPosition.P = EntityP-Vec3(0,EntityEllipsoidDim.Y,0);
 }
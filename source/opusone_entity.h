@@ -28,6 +28,7 @@ struct entity_type_spec
     render_unit *RenderUnit;
     u32 BaseMeshID;
     u32 MeshCount;
+    u32 BaseMaterialID; // NOTE: The model's material 1, material 0 is Assimp's default and isn't kept
 
     collision_geometry *CollisionGeometry;
     collision_type CollisionType;
@@ -61,6 +62,18 @@ WorldPositionTransform(world_position *WorldPosition)
     return Result;
 }
 
+inline world_position
+WorldPositionLerp(world_position *A, world_position *B, f32 LerpFactor)
+{
+    world_position Result = {};
+
+    Result.P = Vec3Lerp(A->P, B->P, LerpFactor);
+    Result.R = QuatSphericalLerp(A->R, B->R, LerpFactor);
+    Result.S = Vec3Lerp(A->S, B->S, LerpFactor);
+
+    return Result;
+}
+
 inline void
 WorldPositionPointTransform(vec3 *Point, world_position *WorldPosition)
 {
@@ -72,15 +85,30 @@ struct entity
     entity_type Type;
 
     world_position WorldPosition;
+    world_position PrevWorldPosition; // NOTE: As of the previous sim step, rendering interpolates between the two
     b32 IsInvisible;
 
     animation_state *AnimationState;
+
+    entity *NextFree; // NOTE: Only used while the slot is free (Type is EntityType_None)
 };
 
 struct game_state;
 entity *AddEntity(game_state *GameState,
                   entity_type EntityType, vec3 Position, quat Rotation, vec3 Scale, b32 IsInvisible = false);
 
+// NOTE: The slot is reused by the next AddEntity. GameState->PlayerEntity is the only pointer kept across frames,
+// and removing the player asserts.
+void
+RemoveEntity(game_state *GameState, entity *Entity);
+
+// NOTE: False when there's no free entity slot, or the type's meshes have no instance slot left
+b32
+CanAddEntity(game_state *GameState, entity_type EntityType);
+
+entity *
+FindClosestEntity(game_state *GameState, entity_type EntityType, vec3 Position);
+
 void
 EntityIntegrateAndMove(entity *MovingEntity, vec3 EntityEllipsoidDim, vec3 EntityAcc, vec3 *EntityVel,
                        f32 AccValue, f32 DragValue, f32 DeltaTime, b32 IgnoreCollisions,
@@ -0,0 +1,115 @@
+#ifndef OPUSONE_FRAME_STATS_CPP
+#define OPUSONE_FRAME_STATS_CPP
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_frame_stats.h"
+#include "opusone_immtext.h"
+
+// NOTE: Game side of the frame stats: summary lines and a stacked bar graph of the newest frames, one bar per
+// frame with the stages bottom to top. The graph tops out at FRAME_STATS_GRAPH_MAX_MS, taller frames get clipped
+// and a red cap.
+#define FRAME_STATS_GRAPH_FRAME_COUNT 256
+#define FRAME_STATS_GRAPH_BAR_WIDTH 3
+#define FRAME_STATS_GRAPH_HEIGHT 200
+#define FRAME_STATS_GRAPH_MAX_MS 40.0f
+#define FRAME_STATS_GRAPH_TARGET_MS (1000.0f / 60.0f)
+
+internal vec4
+FrameStats_GetStageColor(frame_stage Stage)
+{
+    vec4 Result;
+    switch (Stage)
+    {
+        case FrameStage_Wait:   { Result = Vec4(0.5f, 0.5f, 0.5f, 0.8f); } break;
+        case FrameStage_Update: { Result = Vec4(0.2f, 0.5f, 1.0f, 0.8f); } break;
+        case FrameStage_Render: { Result = Vec4(0.2f, 0.9f, 0.3f, 0.8f); } break;
+        case FrameStage_Swap:   { Result = Vec4(1.0f, 0.7f, 0.1f, 0.8f); } break;
+        default:                { Result = Vec4(1.0f, 0.0f, 1.0f, 0.8f); } break;
+    }
+    return Result;
+}
+
+internal i32
+FrameStats_MsToGraphPixels(f32 Ms)
+{
+    i32 Result = (i32) (Ms * ((f32) FRAME_STATS_GRAPH_HEIGHT / FRAME_STATS_GRAPH_MAX_MS) + 0.5f);
+    return Result;
+}
+
+void
+FrameStats_DrawOverlay(frame_stats *Stats, memory_arena *TempArena)
+{
+    if (!Stats || Stats->FrameCount == 0)
+    {
+        return;
+    }
+
+    temporary_memory OverlayMemory = MemoryArena_BeginTemp(TempArena);
+
+    f32 *SortScratch = MemoryArena_PushArray(TempArena, FRAME_STATS_COUNT, f32);
+    frame_stats_summary Summary = FrameStats_Summarize(Stats, SortScratch);
+
+    ImmText_DrawQuickStringF("Frame ms (last %u): avg %0.2f | p50 %0.2f | p95 %0.2f | p99 %0.2f | max %0.2f | %u hitches",
+                             Summary.SampleCount, Summary.MeanMs, Summary.P50Ms, Summary.P95Ms, Summary.P99Ms,
+                             Summary.MaxMs, Summary.HitchCount);
+
+    frame_timing *Latest = FrameStats_GetFrame(Stats, 0);
+    ImmText_DrawQuickStringF("Last frame: wait %0.2f | update %0.2f | render %0.2f | swap %0.2f",
+                             Latest->StageMs[FrameStage_Wait], Latest->StageMs[FrameStage_Update],
+                             Latest->StageMs[FrameStage_Render], Latest->StageMs[FrameStage_Swap]);
+
+    u32 GraphFrameCount = Min(Summary.SampleCount, (u32) FRAME_STATS_GRAPH_FRAME_COUNT);
+    u32 MaxRectCount = 2 + GraphFrameCount * (FrameStage_Count + 1);
+    imm_text_rect *Rects = MemoryArena_PushArray(TempArena, MaxRectCount, imm_text_rect);
+    u32 RectCount = 0;
+
+    i32 GraphWidth = FRAME_STATS_GRAPH_FRAME_COUNT * FRAME_STATS_GRAPH_BAR_WIDTH;
+    Rects[RectCount++] = { 0, 0, GraphWidth, FRAME_STATS_GRAPH_HEIGHT, Vec4(0.0f, 0.0f, 0.0f, 0.5f) };
+
+    f32 HitchThresholdMs = Summary.P50Ms * FRAME_STATS_HITCH_RATIO;
+
+    // NOTE: Newest frame on the right
+    for (u32 Age = 0;
+         Age < GraphFrameCount;
+         ++Age)
+    {
+        frame_timing *Timing = FrameStats_GetFrame(Stats, Age);
+        i32 BarX = GraphWidth - (i32) (Age + 1) * FRAME_STATS_GRAPH_BAR_WIDTH;
+        i32 BarBottom = FRAME_STATS_GRAPH_HEIGHT;
+        f32 StageStartMs = 0.0f;
+
+        for (u32 StageIndex = 0;
+             StageIndex < FrameStage_Count;
+             ++StageIndex)
+        {
+            // NOTE: Rounded from the running sum so the bar height matches the total without drifting
+            f32 StageEndMs = Min(StageStartMs + Timing->StageMs[StageIndex], FRAME_STATS_GRAPH_MAX_MS);
+            i32 StageTop = FRAME_STATS_GRAPH_HEIGHT - FrameStats_MsToGraphPixels(StageEndMs);
+            StageStartMs = StageEndMs;
+
+            if (StageTop < BarBottom)
+            {
+                Rects[RectCount++] = { BarX, StageTop, FRAME_STATS_GRAPH_BAR_WIDTH - 1, BarBottom - StageTop,
+                                       FrameStats_GetStageColor((frame_stage) StageIndex) };
+                BarBottom = StageTop;
+            }
+        }
+
+        if (Timing->TotalMs > HitchThresholdMs || Timing->TotalMs > FRAME_STATS_GRAPH_MAX_MS)
+        {
+            i32 CapTop = Max(BarBottom - 4, 0);
+            Rects[RectCount++] = { BarX, CapTop, FRAME_STATS_GRAPH_BAR_WIDTH - 1, 4, Vec4(1.0f, 0.1f, 0.1f, 1.0f) };
+        }
+    }
+
+    i32 TargetY = FRAME_STATS_GRAPH_HEIGHT - FrameStats_MsToGraphPixels(FRAME_STATS_GRAPH_TARGET_MS);
+    Rects[RectCount++] = { 0, TargetY, GraphWidth, 1, Vec4(1.0f, 1.0f, 1.0f, 0.6f) };
+    Assert(RectCount <= MaxRectCount);
+
+    ImmText_DrawQuickRects(Rects, RectCount, FRAME_STATS_GRAPH_HEIGHT + 5);
+
+    MemoryArena_EndTemp(OverlayMemory);
+}
+
+#endif
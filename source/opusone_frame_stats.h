@@ -0,0 +1,187 @@
+#ifndef OPUSONE_FRAME_STATS_H
+#define OPUSONE_FRAME_STATS_H
+
+#include "opusone_common.h"
+
+// NOTE: Per-frame timings for the last FRAME_STATS_COUNT frames. The platform owns it and marks where each
+// stage starts; the game marks the start of rendering (FrameStats_Mark with FrameStage_Render) and draws it.
+// Stages that weren't marked in a frame take 0ms. Smoothness is judged by the percentiles and hitch count, the
+// mean hides exactly the frames that matter.
+#define FRAME_STATS_COUNT 512 // NOTE: Has to be a power of 2
+#define FRAME_STATS_HITCH_RATIO 2.0f // NOTE: Frames this many times longer than the median count as hitches
+
+enum frame_stage
+{
+    FrameStage_Wait,   // NOTE: Frame pacing, waiting on the GPU
+    FrameStage_Update, // NOTE: Events, input and the game update
+    FrameStage_Render, // NOTE: Submitting GL work
+    FrameStage_Swap,
+    FrameStage_Count
+};
+
+struct frame_timing
+{
+    f32 StageMs[FrameStage_Count];
+    f32 TotalMs;
+};
+
+struct frame_stats
+{
+    frame_timing Frames[FRAME_STATS_COUNT];
+    u64 FrameCount; // NOTE: Frames recorded so far, the latest one is Frames[(FrameCount - 1) % FRAME_STATS_COUNT]
+
+    u64 CounterFrequency;
+    u64 FrameStartCounter;
+    u64 StageStartCounters[FrameStage_Count];
+};
+
+struct frame_stats_summary
+{
+    u32 SampleCount;
+    f32 MeanMs;
+    f32 P50Ms;
+    f32 P95Ms;
+    f32 P99Ms;
+    f32 MaxMs;
+    u32 HitchCount;
+};
+
+inline void
+FrameStats_BeginFrame(frame_stats *Stats, u64 Counter)
+{
+    Stats->FrameStartCounter = Counter;
+    for (u32 StageIndex = 0;
+         StageIndex < FrameStage_Count;
+         ++StageIndex)
+    {
+        Stats->StageStartCounters[StageIndex] = 0;
+    }
+    Stats->StageStartCounters[0] = Counter;
+}
+
+inline void
+FrameStats_Mark(frame_stats *Stats, frame_stage Stage, u64 Counter)
+{
+    Stats->StageStartCounters[Stage] = Counter;
+}
+
+inline void
+FrameStats_EndFrame(frame_stats *Stats, u64 Counter)
+{
+    frame_timing *Timing = Stats->Frames + (Stats->FrameCount++ & (FRAME_STATS_COUNT - 1));
+    f32 MsPerCount = (f32) (1000.0 / (f64) Stats->CounterFrequency);
+
+    // NOTE: A stage runs until the next stage that was marked
+    u64 StageEnd = Counter;
+    for (i32 StageIndex = FrameStage_Count - 1;
+         StageIndex >= 0;
+         --StageIndex)
+    {
+        u64 StageStart = Stats->StageStartCounters[StageIndex];
+        if (StageStart && StageStart <= StageEnd)
+        {
+            Timing->StageMs[StageIndex] = (f32) (StageEnd - StageStart) * MsPerCount;
+            StageEnd = StageStart;
+        }
+        else
+        {
+            Timing->StageMs[StageIndex] = 0.0f;
+        }
+    }
+
+    Timing->TotalMs = (f32) (Counter - Stats->FrameStartCounter) * MsPerCount;
+}
+
+inline u32
+FrameStats_GetSampleCount(frame_stats *Stats)
+{
+    u32 Result = (u32) Min(Stats->FrameCount, (u64) FRAME_STATS_COUNT);
+    return Result;
+}
+
+// NOTE: Age 0 is the latest frame, has to be below FrameStats_GetSampleCount
+inline frame_timing *
+FrameStats_GetFrame(frame_stats *Stats, u32 Age)
+{
+    Assert(Age < FrameStats_GetSampleCount(Stats));
+    frame_timing *Result = Stats->Frames + ((Stats->FrameCount - 1 - Age) & (FRAME_STATS_COUNT - 1));
+    return Result;
+}
+
+inline void
+SortF32(f32 *Values, u32 Count)
+{
+    // NOTE: Shell sort with Ciura's gaps, a few hundred values don't need anything smarter
+    u32 Gaps[] = { 701, 301, 132, 57, 23, 10, 4, 1 };
+    for (u32 GapIndex = 0;
+         GapIndex < ArrayCount(Gaps);
+         ++GapIndex)
+    {
+        u32 Gap = Gaps[GapIndex];
+        for (u32 Index = Gap;
+             Index < Count;
+             ++Index)
+        {
+            f32 Value = Values[Index];
+            u32 InsertIndex = Index;
+            while (InsertIndex >= Gap && Values[InsertIndex - Gap] > Value)
+            {
+                Values[InsertIndex] = Values[InsertIndex - Gap];
+                InsertIndex -= Gap;
+            }
+            Values[InsertIndex] = Value;
+        }
+    }
+}
+
+// NOTE: Nearest rank percentile of sorted values
+inline f32
+GetSortedPercentile(f32 *SortedValues, u32 Count, f32 Percentile)
+{
+    Assert(Count > 0);
+    u32 Rank = (u32) ((Percentile / 100.0f) * (f32) Count + 0.5f);
+    u32 Index = (Rank > 0) ? (Rank - 1) : 0;
+    f32 Result = SortedValues[Min(Index, Count - 1)];
+    return Result;
+}
+
+// NOTE: Scratch has to hold FRAME_STATS_COUNT values
+inline frame_stats_summary
+FrameStats_Summarize(frame_stats *Stats, f32 *Scratch)
+{
+    frame_stats_summary Result = {};
+    Result.SampleCount = FrameStats_GetSampleCount(Stats);
+    if (Result.SampleCount == 0)
+    {
+        return Result;
+    }
+
+    f32 TotalMs = 0.0f;
+    for (u32 Age = 0;
+         Age < Result.SampleCount;
+         ++Age)
+    {
+        Scratch[Age] = FrameStats_GetFrame(Stats, Age)->TotalMs;
+        TotalMs += Scratch[Age];
+    }
+
+    SortF32(Scratch, Result.SampleCount);
+
+    Result.MeanMs = TotalMs / (f32) Result.SampleCount;
+    Result.P50Ms = GetSortedPercentile(Scratch, Result.SampleCount, 50.0f);
+    Result.P95Ms = GetSortedPercentile(Scratch, Result.SampleCount, 95.0f);
+    Result.P99Ms = GetSortedPercentile(Scratch, Result.SampleCount, 99.0f);
+    Result.MaxMs = Scratch[Result.SampleCount - 1];
+
+    f32 HitchThresholdMs = Result.P50Ms * FRAME_STATS_HITCH_RATIO;
+    for (u32 SampleIndex = Result.SampleCount;
+         SampleIndex > 0 && Scratch[SampleIndex - 1] > HitchThresholdMs;
+         --SampleIndex)
+    {
+        Result.HitchCount++;
+    }
+
+    return Result;
+}
+
+#endif
@@ -33,7 +33,7 @@ ImmText_LoadFont(memory_arena *Arena, const char *Path, u32 PointSize)
     FontInfo->GlyphCount = 128;
     FontInfo->GlyphInfos = MemoryArena_PushArray(Arena, FontInfo->GlyphCount, glyph_info);
     // NOTE: Allocate temp memory for the rendered glyphs (just the header, image bytes are handled by the platform)
-    MemoryArena_Freeze(Arena);
+    temporary_memory GlyphImageMemory = MemoryArena_BeginTemp(Arena);
     platform_image *GlyphImages = MemoryArena_PushArray(Arena, FontInfo->GlyphCount, platform_image);
     for (u32 GlyphIndex = 0;
          GlyphIndex < FontInfo->GlyphCount;
@@ -90,7 +90,7 @@ ImmText_LoadFont(memory_arena *Arena, const char *Path, u32 PointSize)
     u32 AtlasPxWidth = AtlasColumns * MaxGlyphWidth;
     u32 AtlasPxHeight = AtlasRows * MaxGlyphHeight;
     u32 AtlasPitch = BytesPerPixel * AtlasPxWidth;
-    u8 *AtlasBytes = MemoryArena_PushArray(Arena, AtlasPitch * AtlasPxHeight, u8);
+    u8 *AtlasBytes = MemoryArena_PushArrayAndZero(Arena, AtlasPitch * AtlasPxHeight, u8);
     
     //
     // NOTE: Blit each glyph surface to the atlas surface
@@ -122,20 +122,7 @@ ImmText_LoadFont(memory_arena *Arena, const char *Path, u32 PointSize)
              GlyphPxY < GlyphImage->Height;
              ++GlyphPxY)
         {
-            u8 *DestByte = (u8 *) Dest;
-            u8 *SourceByte = (u8 *) Source;
-            
-            for (u32 GlyphPxX = 0;
-                 GlyphPxX < GlyphImage->Width;
-                 ++GlyphPxX)
-            {
-                for (u32 PixelByte = 0;
-                     PixelByte < BytesPerPixel;
-                     ++PixelByte)
-                {
-                    *DestByte++ = *SourceByte++;
-                }
-            }
+            MemoryCopy(Dest, Source, GlyphImage->Width * BytesPerPixel);
 
             Dest += AtlasPitch;
             Source += GlyphImage->Pitch;
@@ -183,7 +170,7 @@ ImmText_LoadFont(memory_arena *Arena, const char *Path, u32 PointSize)
     Platform_SaveImageToDisk(SaveToPath.D, &AtlasPlatformImage,
                              0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
 
-    MemoryArena_Unfreeze(Arena);
+    MemoryArena_EndTemp(GlyphImageMemory);
     Platform_CloseFont(&Font);
     
     return FontInfo;
@@ -253,7 +240,7 @@ ImmText_DrawString(const char *String, font_info *FontInfo, i32 X, i32 Y, u32 Sc
         OffsetForBgIndices = 6;
     }
 
-    MemoryArena_Freeze(Arena);
+    temporary_memory VertexMemory = MemoryArena_BeginTemp(Arena);
     u32 VertexCount = OffsetForBgVertices + StringVisibleCount * 4;
     u32 IndexCount = OffsetForBgIndices + StringVisibleCount * 6;
     vec2 *Vertices = MemoryArena_PushArray(Arena, VertexCount, vec2);
@@ -390,7 +377,88 @@ ImmText_DrawString(const char *String, font_info *FontInfo, i32 X, i32 Y, u32 Sc
 
     SubVertexDataForRenderUnit(RenderUnit, AttribData, AttribCount, Indices, VertexCount, IndexCount);
 
-    MemoryArena_Unfreeze(Arena);
+    MemoryArena_EndTemp(VertexMemory);
+}
+
+// NOTE: All rects go in one marker. FontInfo is only needed for its atlas, rects use the same "filled quad"
+// UV hack as text backgrounds.
+void
+ImmText_DrawRects(imm_text_rect *Rects, u32 RectCount, font_info *FontInfo, u32 ScreenWidth, u32 ScreenHeight,
+                  render_unit *RenderUnit, memory_arena *Arena)
+{
+    Assert(FontInfo);
+    Assert(FontInfo->TextureID > 0);
+
+    if (RectCount == 0)
+    {
+        return;
+    }
+
+    f32 OneOverHalfScreenWidth = 1.0f / ((f32) ScreenWidth * 0.5f);
+    f32 OneOverHalfScreenHeight = 1.0f / ((f32) ScreenHeight * 0.5f);
+
+    temporary_memory VertexMemory = MemoryArena_BeginTemp(Arena);
+    u32 VertexCount = RectCount * 4;
+    u32 IndexCount = RectCount * 6;
+    vec2 *Vertices = MemoryArena_PushArray(Arena, VertexCount, vec2);
+    vec4 *Colors = MemoryArena_PushArray(Arena, VertexCount, vec4);
+    vec3 *UVs = MemoryArena_PushArray(Arena, VertexCount, vec3);
+    i32 *Indices = MemoryArena_PushArray(Arena, IndexCount, i32);
+
+    for (u32 RectIndex = 0;
+         RectIndex < RectCount;
+         ++RectIndex)
+    {
+        imm_text_rect *Rect = Rects + RectIndex;
+
+        vec2 MinNDC = PixelsToNDCAbs(Vec2((f32) Rect->X, (f32) Rect->Y), OneOverHalfScreenWidth, OneOverHalfScreenHeight);
+        vec2 MaxNDC = PixelsToNDCAbs(Vec2((f32) (Rect->X + Rect->Width), (f32) (Rect->Y + Rect->Height)),
+                                     OneOverHalfScreenWidth, OneOverHalfScreenHeight);
+
+        u32 BaseVertexIndex = RectIndex * 4;
+        Vertices[BaseVertexIndex + 0] =      MinNDC;
+        Vertices[BaseVertexIndex + 1] = Vec2(MinNDC.X, MaxNDC.Y);
+        Vertices[BaseVertexIndex + 2] =      MaxNDC;
+        Vertices[BaseVertexIndex + 3] = Vec2(MaxNDC.X, MinNDC.Y);
+
+        for (u32 CornerIndex = 0;
+             CornerIndex < 4;
+             ++CornerIndex)
+        {
+            Colors[BaseVertexIndex + CornerIndex] = Rect->Color;
+            UVs[BaseVertexIndex + CornerIndex] = Vec3(0, 0, 1);
+        }
+
+        i32 IndicesToCopy[] = {
+            0, 1, 3,  3, 1, 2
+        };
+
+        for (u32 IndexToCopyIndex = 0;
+             IndexToCopyIndex < ArrayCount(IndicesToCopy);
+             ++IndexToCopyIndex)
+        {
+            Indices[RectIndex * 6 + IndexToCopyIndex] = BaseVertexIndex + IndicesToCopy[IndexToCopyIndex];
+        }
+    }
+
+    render_marker *Marker = RenderUnit->Markers + (RenderUnit->MarkerCount++);
+    *Marker = {};
+    Marker->StateT = RENDER_STATE_IMM_TEXT;
+    Marker->BaseVertexIndex = RenderUnit->VertexCount;
+    Marker->StartingIndex = RenderUnit->IndexCount;
+    Marker->IndexCount = IndexCount;
+    Marker->StateD.ImmText.AtlasTextureID = FontInfo->TextureID;
+
+    void *AttribData[16] = {};
+    u32 AttribCount = 0;
+    AttribData[AttribCount++] = Vertices;
+    AttribData[AttribCount++] = Colors;
+    AttribData[AttribCount++] = UVs;
+    Assert(AttribCount <= ArrayCount(AttribData));
+
+    SubVertexDataForRenderUnit(RenderUnit, AttribData, AttribCount, Indices, VertexCount, IndexCount);
+
+    MemoryArena_EndTemp(VertexMemory);
 }
 
 global_variable font_info *_ImmTextQuick_Font;
@@ -434,6 +502,45 @@ ImmText_DrawQuickString(const char *String)
     _ImmTextQuick_CurrentY += _ImmTextQuick_Font->Height;
 }
 
+void
+ImmText_DrawQuickStringF(const char *Format, ...)
+{
+    temporary_memory StringMemory = MemoryArena_BeginTemp(_ImmTextQuick_Arena);
+
+    va_list VarArgs;
+    va_start(VarArgs, Format);
+    char *String = MemoryArena_PushStringFList_(_ImmTextQuick_Arena, Format, VarArgs);
+    va_end(VarArgs);
+
+    ImmText_DrawQuickString(String);
+
+    MemoryArena_EndTemp(StringMemory);
+}
+
+// NOTE: Rects are relative to the current quick draw position, which then moves down by Height
+void
+ImmText_DrawQuickRects(imm_text_rect *Rects, u32 RectCount, i32 Height)
+{
+    temporary_memory RectMemory = MemoryArena_BeginTemp(_ImmTextQuick_Arena);
+
+    imm_text_rect *PlacedRects = MemoryArena_PushArray(_ImmTextQuick_Arena, RectCount, imm_text_rect);
+    for (u32 RectIndex = 0;
+         RectIndex < RectCount;
+         ++RectIndex)
+    {
+        PlacedRects[RectIndex] = Rects[RectIndex];
+        PlacedRects[RectIndex].X += _ImmTextQuick_CurrentX;
+        PlacedRects[RectIndex].Y += _ImmTextQuick_CurrentY;
+    }
+
+    ImmText_DrawRects(PlacedRects, RectCount, _ImmTextQuick_Font, _ImmTextQuick_ScreenWidth, _ImmTextQuick_ScreenHeight,
+                      _ImmTextQuick_RenderUnit, _ImmTextQuick_Arena);
+
+    MemoryArena_EndTemp(RectMemory);
+
+    _ImmTextQuick_CurrentY += Height;
+}
+
 void
 ImmText_ResetQuickDraw()
 {
@@ -26,6 +26,16 @@ struct font_info
     u32 Height;
 };
 
+// NOTE: Filled rectangle in pixels, drawn in the same pass as the text
+struct imm_text_rect
+{
+    i32 X;
+    i32 Y;
+    i32 Width;
+    i32 Height;
+    vec4 Color;
+};
+
 font_info *
 ImmText_LoadFont(memory_arena *Arena, const char *Path, u32 PointSize);
 
@@ -34,6 +44,10 @@ void
 ImmText_DrawString(const char *String, font_info *FontInfo, i32 X, i32 Y, u32 ScreenWidth, u32 ScreenHeight,
                    vec4 Color, b32 DrawBackground, vec3 BackgroundColor, render_unit *RenderUnit, memory_arena *Arena);
 
+void
+ImmText_DrawRects(imm_text_rect *Rects, u32 RectCount, font_info *FontInfo, u32 ScreenWidth, u32 ScreenHeight,
+                  render_unit *RenderUnit, memory_arena *Arena);
+
 void
 ImmText_InitializeQuickDraw(font_info *Font,
                             i32 X, i32 Y, i32 ScreenWidth, i32 ScreenHeight,
@@ -43,6 +57,12 @@ ImmText_InitializeQuickDraw(font_info *Font,
 void
 ImmText_DrawQuickString(const char *String);
 
+void
+ImmText_DrawQuickStringF(const char *Format, ...);
+
+void
+ImmText_DrawQuickRects(imm_text_rect *Rects, u32 RectCount, i32 Height);
+
 void
 ImmText_ResetQuickDraw();
 
@@ -564,7 +564,7 @@ QuatSphericalLerp(quat A, quat B, f32 LerpFactor)
     if (CosTheta < 0.0f)
     {
         B = -B;
-        CosTheta -= CosTheta;
+        CosTheta = -CosTheta;
     }
 
     // NOTE: Perform a linear interpolation when CosTheta is close to 1 to avoid side effect
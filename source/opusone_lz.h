@@ -0,0 +1,261 @@
+#ifndef OPUSONE_LZ_H
+#define OPUSONE_LZ_H
+
+#include <cstring>
+
+#include "opusone_common.h"
+
+// NOTE: Small byte-oriented LZ77 codec in the spirit of LZ4, tuned for speed over ratio. Used for memory
+// snapshots, where most pages are either untouched zeroes or floats that barely compress anyway, so a greedy
+// single-probe matcher is as good as it gets for the time it's allowed.
+//
+// A block is a list of sequences:
+//   Token       1 byte, high nibble literal count, low nibble match length - LZ_MIN_MATCH
+//               (15 in either means more length bytes follow, each added until one is below 255)
+//   Literals    literal count bytes
+//   Offset      2 bytes little endian, distance back to the match (1..65535)
+//   Match       extra match length bytes, if the low nibble was 15
+// The last sequence is literals only and has no offset. Matches always end at least LZ_LAST_LITERALS bytes
+// before the end, which keeps the matcher's reads in bounds.
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 8
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 13
+
+inline size_t
+LZ_GetMaxCompressedSize(size_t Size)
+{
+    // NOTE: Incompressible input is one long literal run: a token, one length byte per 255 and the bytes
+    size_t Result = Size + (Size / 255) + 16;
+    return Result;
+}
+
+inline u32
+LZ_Read32_(const u8 *At)
+{
+    u32 Result;
+    memcpy(&Result, At, sizeof(Result));
+    return Result;
+}
+
+inline u64
+LZ_Read64_(const u8 *At)
+{
+    u64 Result;
+    memcpy(&Result, At, sizeof(Result));
+    return Result;
+}
+
+inline u32
+LZ_Hash_(u32 Value)
+{
+    u32 Result = (Value * 2654435761u) >> (32 - LZ_HASH_BITS);
+    return Result;
+}
+
+inline u8 *
+LZ_WriteLength_(u8 *Out, size_t Length)
+{
+    while (Length >= 255)
+    {
+        *Out++ = 255;
+        Length -= 255;
+    }
+    *Out++ = (u8) Length;
+    return Out;
+}
+
+// NOTE: Dest has to hold LZ_GetMaxCompressedSize(SourceSize) bytes. Returns the compressed size.
+inline size_t
+LZ_Compress(const void *Source, size_t SourceSize, void *Dest)
+{
+    const u8 *In = (const u8 *) Source;
+    const u8 *InEnd = In + SourceSize;
+    const u8 *LiteralStart = In;
+    u8 *Out = (u8 *) Dest;
+
+    // NOTE: Positions are stored + 1 so a zeroed table means "nothing here yet"
+    u32 HashTable[1 << LZ_HASH_BITS] = {};
+
+    if (SourceSize > LZ_LAST_LITERALS + LZ_MIN_MATCH)
+    {
+        const u8 *MatchLimit = InEnd - LZ_LAST_LITERALS;
+        const u8 *At = In;
+
+        while (At + LZ_MIN_MATCH <= MatchLimit)
+        {
+            u32 Value = LZ_Read32_(At);
+            u32 Hash = LZ_Hash_(Value);
+            u32 Candidate = HashTable[Hash];
+            HashTable[Hash] = (u32) (At - In) + 1;
+
+            const u8 *Match = In + Candidate - 1;
+            if (!Candidate || (size_t) (At - Match) > LZ_MAX_OFFSET || LZ_Read32_(Match) != Value)
+            {
+                // NOTE: The longer nothing matched, the bigger the steps; incompressible data goes by fast
+                At += 1 + ((size_t) (At - LiteralStart) >> 6);
+                continue;
+            }
+
+            // NOTE: Extend backwards into the pending literals, then forwards
+            while (At > LiteralStart && Match > In && At[-1] == Match[-1])
+            {
+                At--;
+                Match--;
+            }
+
+            const u8 *MatchEnd = At + LZ_MIN_MATCH;
+            const u8 *Reference = Match + LZ_MIN_MATCH;
+            while (MatchEnd + 8 <= MatchLimit && LZ_Read64_(MatchEnd) == LZ_Read64_(Reference))
+            {
+                MatchEnd += 8;
+                Reference += 8;
+            }
+            while (MatchEnd < MatchLimit && *MatchEnd == *Reference)
+            {
+                MatchEnd++;
+                Reference++;
+            }
+
+            size_t LiteralCount = (size_t) (At - LiteralStart);
+            size_t MatchLength = (size_t) (MatchEnd - At) - LZ_MIN_MATCH;
+            u16 Offset = (u16) (At - Match);
+
+            u8 *Token = Out++;
+            *Token = (u8) ((Min(LiteralCount, (size_t) 15) << 4) | Min(MatchLength, (size_t) 15));
+            if (LiteralCount >= 15)
+            {
+                Out = LZ_WriteLength_(Out, LiteralCount - 15);
+            }
+            memcpy(Out, LiteralStart, LiteralCount);
+            Out += LiteralCount;
+
+            *Out++ = (u8) (Offset & 0xFF);
+            *Out++ = (u8) (Offset >> 8);
+            if (MatchLength >= 15)
+            {
+                Out = LZ_WriteLength_(Out, MatchLength - 15);
+            }
+
+            At = MatchEnd;
+            LiteralStart = At;
+        }
+    }
+
+    size_t LiteralCount = (size_t) (InEnd - LiteralStart);
+    *Out++ = (u8) (Min(LiteralCount, (size_t) 15) << 4);
+    if (LiteralCount >= 15)
+    {
+        Out = LZ_WriteLength_(Out, LiteralCount - 15);
+    }
+    memcpy(Out, LiteralStart, LiteralCount);
+    Out += LiteralCount;
+
+    size_t Result = (size_t) (Out - (u8 *) Dest);
+    Assert(Result <= LZ_GetMaxCompressedSize(SourceSize));
+    return Result;
+}
+
+inline b32
+LZ_ReadLength_(const u8 **At, const u8 *End, size_t *Length)
+{
+    u8 Byte;
+    do
+    {
+        if (*At >= End)
+        {
+            return false;
+        }
+        Byte = *(*At)++;
+        *Length += Byte;
+    } while (Byte == 255);
+    return true;
+}
+
+// NOTE: Checks every length and offset against the buffers, so bad input fails instead of scribbling.
+// Returns false unless it decoded exactly DestSize bytes.
+inline b32
+LZ_Decompress(const void *Source, size_t SourceSize, void *Dest, size_t DestSize)
+{
+    const u8 *In = (const u8 *) Source;
+    const u8 *InEnd = In + SourceSize;
+    u8 *Out = (u8 *) Dest;
+    u8 *OutEnd = Out + DestSize;
+
+    while (In < InEnd)
+    {
+        u8 Token = *In++;
+
+        size_t LiteralCount = Token >> 4;
+        if (LiteralCount == 15 && !LZ_ReadLength_(&In, InEnd, &LiteralCount))
+        {
+            return false;
+        }
+        if (LiteralCount > (size_t) (InEnd - In) || LiteralCount > (size_t) (OutEnd - Out))
+        {
+            return false;
+        }
+        memcpy(Out, In, LiteralCount);
+        In += LiteralCount;
+        Out += LiteralCount;
+
+        if (In == InEnd)
+        {
+            // NOTE: Last sequence
+            break;
+        }
+
+        if ((InEnd - In) < 2)
+        {
+            return false;
+        }
+        size_t Offset = (size_t) In[0] | ((size_t) In[1] << 8);
+        In += 2;
+
+        size_t MatchLength = Token & 15;
+        if (MatchLength == 15 && !LZ_ReadLength_(&In, InEnd, &MatchLength))
+        {
+            return false;
+        }
+        MatchLength += LZ_MIN_MATCH;
+
+        if (Offset == 0 || Offset > (size_t) (Out - (u8 *) Dest) || MatchLength > (size_t) (OutEnd - Out))
+        {
+            return false;
+        }
+
+        const u8 *Match = Out - Offset;
+        u8 *CopyEnd = Out + MatchLength;
+        if (Offset < 8)
+        {
+            // NOTE: Overlapping match, the output repeats with a period of Offset. Copy bytes until the
+            // distance back is a multiple of the period that's at least 8, from there 8 byte steps work too.
+            size_t Distance = Offset * ((8 + Offset - 1) / Offset);
+            u8 *PrefixEnd = Out + Min(Distance - Offset, MatchLength);
+            while (Out < PrefixEnd)
+            {
+                *Out++ = *Match++;
+            }
+            Match = Out - Distance;
+        }
+
+        // NOTE: 8 byte steps may run up to 7 bytes past the match (while there's room in Dest), later
+        // sequences overwrite those
+        while (Out < CopyEnd && (size_t) (OutEnd - Out) >= 8)
+        {
+            memcpy(Out, Match, 8);
+            Out += 8;
+            Match += 8;
+        }
+        while (Out < CopyEnd)
+        {
+            *Out++ = *Match++;
+        }
+        Out = CopyEnd;
+    }
+
+    b32 Result = (Out == OutEnd);
+    return Result;
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define OPUSONE_PLATFORM_H
 
 #include "opusone_common.h"
+#include "opusone_frame_stats.h"
 
-#include <sdl2/SDL_scancode.h>
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_atomic.h>
 
 enum mouse_button_type
 {
@@ -13,12 +15,44 @@ enum mouse_button_type
     MouseButton_Count,
 };
 
+// NOTE: Key and mouse button transitions, in the order they happened. Timestamps are in seconds on the
+// platform's input clock, the same clock as game_input::FrameTime.
+#define INPUT_EVENT_RING_SIZE 256 // NOTE: Has to be a power of 2
+
+enum input_event_type
+{
+    InputEvent_KeyDown,
+    InputEvent_KeyUp,
+    InputEvent_MouseButtonDown,
+    InputEvent_MouseButtonUp,
+};
+
+struct input_event
+{
+    input_event_type Type;
+    u32 Code; // NOTE: Scancode or mouse_button_type
+    f64 Time;
+};
+
+// NOTE: The platform only touches the keys that changed. Each key remembers the last frame it went down and up,
+// which is all the JustPressed/JustReleased helpers need (and a tap that starts and ends within one frame still
+// counts as pressed and released on that frame). Sub-frame timing comes from the event ring: this frame's
+// events are [FrameFirstEvent_, EventCount_), older ones get overwritten once the ring wraps.
 struct game_input
 {
-    u8 CurrentKeyStates_[SDL_NUM_SCANCODES];
-    u8 PreviousKeyStates_[SDL_NUM_SCANCODES];
-    u8 CurrentMouseButtonStates_[MouseButton_Count];
-    u8 PreviousMouseButtonStates_[MouseButton_Count];
+    u32 FrameIndex; // NOTE: Starts at 1, 0 means "never" in the per-key frame numbers
+    f64 FrameTime;  // NOTE: When this frame's input was sampled
+    
+    u8 KeyIsDown_[SDL_NUM_SCANCODES];
+    u32 KeyPressedFrame_[SDL_NUM_SCANCODES];
+    u32 KeyReleasedFrame_[SDL_NUM_SCANCODES];
+    u8 MouseButtonIsDown_[MouseButton_Count];
+    u32 MouseButtonPressedFrame_[MouseButton_Count];
+    u32 MouseButtonReleasedFrame_[MouseButton_Count];
+
+    input_event Events_[INPUT_EVENT_RING_SIZE];
+    u64 EventCount_;
+    u64 FrameFirstEvent_;
 
     i32 MouseX;
     i32 MouseY;
@@ -32,12 +66,66 @@ struct game_input
     i32 OriginalScreenHeight;
 };
 
+//
+// NOTE: Job system. Jobs are pushed onto the calling thread's queue and can be stolen by any worker. Every job
+// belongs to a group, which counts the jobs that haven't finished yet. Waiting on a group runs jobs (from any
+// group) on the waiting thread until the count drops to zero, so the main thread is a worker too.
+// Jobs get a per-worker scratch arena that is reset after every job.
+// Only the main thread and jobs themselves can add jobs.
+//
+struct platform_job_system;
+
+struct platform_job_group
+{
+    SDL_atomic_t PendingCount_;
+};
+
+typedef void platform_job_proc(void *Data, memory_arena *ScratchArena);
+
+typedef void platform_add_job(platform_job_system *JobSystem, platform_job_group *Group,
+                              platform_job_proc *Proc, void *Data);
+typedef void platform_wait_for_job_group(platform_job_system *JobSystem, platform_job_group *Group);
+
+typedef void *platform_get_gl_proc_address(const char *Name);
+
+// NOTE: Storage is reserved, not committed. Pages are committed on demand with Platform_CommitMemory.
 struct game_memory
 {
     b32 IsInitialized;
     
     size_t StorageSize;
     void *Storage;
+
+    platform_job_system *JobSystem;
+    platform_add_job *AddJob;
+    platform_wait_for_job_group *WaitForJobGroup;
+    u32 WorkerCount; // NOTE: Including the main thread
+
+    // NOTE: Owned by the platform, the game marks FrameStage_Render and reads it for the overlay. Can be 0.
+    frame_stats *FrameStats;
+
+    // NOTE: Set by the game each frame while assets are still streaming in after init (texture uploads are spread
+    // over frames), so benchmarks can tell loading frames from steady state ones
+    b32 IsStreamingAssets;
+
+    // NOTE: Set by the platform whenever game code was (re)loaded, the first frame included. Globals live in the
+    // game module, not in Storage, so the game points them back at its state and reloads its GL functions.
+    b32 ModuleReloaded;
+    platform_get_gl_proc_address *GetGLProcAddress;
+};
+
+// NOTE: Read-only view of a whole file, parse it in place instead of copying it out. Data is 0 if the file
+// couldn't be mapped (or is empty). The hint says how the caller is going to walk it.
+enum platform_map_hint
+{
+    MapHint_Sequential, // NOTE: Read front to back once, pages are read ahead aggressively
+    MapHint_Random,     // NOTE: Jumped around in, no read ahead
+};
+
+struct platform_mapped_file
+{
+    void *Data;
+    size_t Size;
 };
 
 struct platform_image
@@ -57,63 +145,158 @@ struct platform_font
     u32 PointSize;
 };
 
-void
+// NOTE: C linkage so hot reload builds can look it up in the game module (see opusone_platform_module.cpp)
+typedef void game_update_and_render(game_input *GameInput, game_memory *GameMemory, b32 *GameShouldQuit);
+
+extern "C" void
 GameUpdateAndRender(game_input *GameInput, game_memory *GameMemory, b32 *GameShouldQuit);
 
 inline b32
 Platform_KeyIsDown(game_input *GameInput, u32 KeyScancode)
 {
-    b32 Result = GameInput->CurrentKeyStates_[KeyScancode];
+    b32 Result = GameInput->KeyIsDown_[KeyScancode];
     return Result;
 }
 
 inline b32
 Platform_KeyJustPressed(game_input *GameInput, u32 KeyScancode)
 {
-    b32 Result = (GameInput->CurrentKeyStates_[KeyScancode] && !GameInput->PreviousKeyStates_[KeyScancode]);
+    b32 Result = (GameInput->KeyPressedFrame_[KeyScancode] == GameInput->FrameIndex);
     return Result;
 }
 
 inline b32
 Platform_KeyJustReleased(game_input *GameInput, u32 KeyScancode)
 {
-    b32 Result = (!GameInput->CurrentKeyStates_[KeyScancode] && GameInput->PreviousKeyStates_[KeyScancode]);
+    b32 Result = (GameInput->KeyReleasedFrame_[KeyScancode] == GameInput->FrameIndex);
     return Result;
 }
 
 inline b32
 Platform_MouseButtonIsDown(game_input *GameInput, mouse_button_type MouseButton)
 {
-    b32 Result = GameInput->CurrentMouseButtonStates_[MouseButton];
+    b32 Result = GameInput->MouseButtonIsDown_[MouseButton];
     return Result;
 }
 
 inline b32
 Platform_MouseButtonJustPressed(game_input *GameInput, mouse_button_type MouseButton)
 {
-    b32 Result = (GameInput->CurrentMouseButtonStates_[MouseButton] && !GameInput->PreviousMouseButtonStates_[MouseButton]);
+    b32 Result = (GameInput->MouseButtonPressedFrame_[MouseButton] == GameInput->FrameIndex);
     return Result;
 }
 
 inline b32
 Platform_MouseButtonJustReleased(game_input *GameInput, mouse_button_type MouseButton)
 {
-    b32 Result = (!GameInput->CurrentMouseButtonStates_[MouseButton] && GameInput->PreviousMouseButtonStates_[MouseButton]);
+    b32 Result = (GameInput->MouseButtonReleasedFrame_[MouseButton] == GameInput->FrameIndex);
     return Result;
 }
 
+// NOTE: This frame's events that are still in the ring
+inline u64
+Platform_GetFrameFirstEvent_(game_input *GameInput)
+{
+    u64 Result = GameInput->FrameFirstEvent_;
+    if ((GameInput->EventCount_ - Result) > INPUT_EVENT_RING_SIZE)
+    {
+        Result = GameInput->EventCount_ - INPUT_EVENT_RING_SIZE;
+    }
+    return Result;
+}
+
+// NOTE: All the events still in the ring, earlier frames' included
+inline u64
+Platform_GetOldestEvent_(game_input *GameInput)
+{
+    u64 Result = (GameInput->EventCount_ > INPUT_EVENT_RING_SIZE) ? (GameInput->EventCount_ - INPUT_EVENT_RING_SIZE) : 0;
+    return Result;
+}
+
+// NOTE: Whether the key was down at Time. Works back from the current state: the first transition after Time says
+// what the state was before it. Looks through the whole ring, not just this frame, since sim steps trail real time
+// and a step's window can start in the previous frame.
+inline b32
+Platform_KeyIsDownAt(game_input *GameInput, u32 KeyScancode, f64 Time)
+{
+    b32 Result = GameInput->KeyIsDown_[KeyScancode];
+
+    for (u64 EventIndex = Platform_GetOldestEvent_(GameInput);
+         EventIndex < GameInput->EventCount_;
+         ++EventIndex)
+    {
+        input_event *Event = GameInput->Events_ + (EventIndex & (INPUT_EVENT_RING_SIZE - 1));
+        if (Event->Code == KeyScancode && Event->Time > Time &&
+            (Event->Type == InputEvent_KeyDown || Event->Type == InputEvent_KeyUp))
+        {
+            Result = (Event->Type == InputEvent_KeyUp);
+            break;
+        }
+    }
+
+    return Result;
+}
+
+// NOTE: Whether the key went down in (StartTime, EndTime], for sim steps that want presses at their own time. The
+// range can reach back into the previous frame, like for Platform_KeyIsDownAt.
+inline b32
+Platform_KeyPressedInRange(game_input *GameInput, u32 KeyScancode, f64 StartTime, f64 EndTime)
+{
+    for (u64 EventIndex = Platform_GetOldestEvent_(GameInput);
+         EventIndex < GameInput->EventCount_;
+         ++EventIndex)
+    {
+        input_event *Event = GameInput->Events_ + (EventIndex & (INPUT_EVENT_RING_SIZE - 1));
+        if (Event->Type == InputEvent_KeyDown && Event->Code == KeyScancode &&
+            Event->Time > StartTime && Event->Time <= EndTime)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void
 Platform_SetRelativeMouse(b32 Enabled);
 
+// NOTE: Same counter as the platform's frame_stats
+u64
+Platform_GetPerformanceCounter();
+
+// NOTE: Platform_CommitMemory is declared in opusone_common.h, next to the arenas that use it
+void
+Platform_AdviseHugePages(void *Address, size_t Size);
+
 char *
 Platform_ReadFile(const char *FilePath);
 
+b32
+Platform_WriteFile(const char *FilePath, void *Data, size_t Size);
+
 void
 Platform_Free(void *Memory);
 
+b32
+Platform_GetFileSize(const char *FilePath, size_t *Out_Size);
+
+// NOTE: Only good for comparing with other write times from the same machine
+b32
+Platform_GetFileWriteTime(const char *FilePath, u64 *Out_WriteTime);
+
+platform_mapped_file
+Platform_MapFile(const char *FilePath, platform_map_hint Hint);
+
+void
+Platform_UnmapFile(platform_mapped_file *MappedFile);
+
 platform_image
 Platform_LoadImage(const char *ImagePath);
 
+// NOTE: Decodes an image file that is already in memory, Name is only for error messages
+platform_image
+Platform_LoadImageFromMemory(void *Data, size_t Size, const char *Name);
+
 void
 Platform_FreeImage(platform_image *PlatformImage);
 
@@ -0,0 +1,307 @@
+#ifndef OPUSONE_PLATFORM_JOBS_CPP
+#define OPUSONE_PLATFORM_JOBS_CPP
+
+// NOTE: Platform side of the job system (see opusone_platform.h). Only needs SDL threads and atomics, and
+// ReserveMemory from opusone_platform_services.cpp, which includes it.
+
+#include <SDL2/SDL.h>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+
+#define JOB_QUEUE_SIZE 1024 // NOTE: Per worker, has to be a power of 2
+#define JOB_MAX_WORKERS 16
+#define JOB_SCRATCH_ARENA_SIZE Megabytes(64)
+#define JOB_CACHE_LINE_SIZE 64
+
+struct platform_job
+{
+    platform_job_proc *Proc;
+    void *Data;
+    platform_job_group *Group;
+};
+
+// NOTE: Chase-Lev work-stealing deque over a fixed size ring. The owning worker pushes and pops at the bottom
+// (LIFO, so it keeps working on what's hot in cache), the other workers steal from the top. Top only ever moves
+// forward, and whoever moves it with a CAS owns the job that was there. The only owner/thief race is on the last
+// job, which both sides settle through the same CAS on Top.
+struct platform_job_queue
+{
+    SDL_atomic_t Top;
+    u8 TopPad_[JOB_CACHE_LINE_SIZE - sizeof(SDL_atomic_t)];
+    SDL_atomic_t Bottom;
+    u8 BottomPad_[JOB_CACHE_LINE_SIZE - sizeof(SDL_atomic_t)];
+
+    platform_job Jobs[JOB_QUEUE_SIZE];
+};
+
+struct platform_job_worker
+{
+    platform_job_queue Queue;
+
+    platform_job_system *JobSystem;
+    u32 WorkerIndex;
+    SDL_Thread *Thread;
+    memory_arena ScratchArena;
+};
+
+struct platform_job_system
+{
+    platform_job_worker Workers[JOB_MAX_WORKERS];
+    u32 WorkerCount;
+
+    // NOTE: Posted once per queued job, idle workers sleep on it
+    SDL_sem *WakeSemaphore;
+    SDL_atomic_t ShouldQuit;
+};
+
+// NOTE: The worker running on this thread. Set for the main thread (worker 0) and every worker thread.
+global_variable thread_local platform_job_worker *GlobalThreadJobWorker;
+
+inline void
+JobSystem_Pause()
+{
+#if MEMORY_SIMD_WIDTH
+    _mm_pause();
+#endif
+}
+
+// NOTE: Owner only
+internal b32
+JobQueue_Push(platform_job_queue *Queue, platform_job *Job)
+{
+    i32 Bottom = SDL_AtomicGet(&Queue->Bottom);
+    i32 Top = SDL_AtomicGet(&Queue->Top);
+    if ((Bottom - Top) >= JOB_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    Queue->Jobs[Bottom & (JOB_QUEUE_SIZE - 1)] = *Job;
+
+    // NOTE: The job has to be visible before the new bottom is
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&Queue->Bottom, Bottom + 1);
+
+    return true;
+}
+
+// NOTE: Owner only
+internal b32
+JobQueue_Pop(platform_job_queue *Queue, platform_job *Out_Job)
+{
+    // NOTE: SDL_AtomicAdd is a full barrier, which this needs: thieves have to see the claimed bottom before
+    // Top is read here, or both sides could take the last job
+    i32 Bottom = SDL_AtomicAdd(&Queue->Bottom, -1) - 1;
+    i32 Top = SDL_AtomicGet(&Queue->Top);
+
+    b32 Result = false;
+
+    if (Top <= Bottom)
+    {
+        *Out_Job = Queue->Jobs[Bottom & (JOB_QUEUE_SIZE - 1)];
+        Result = true;
+
+        if (Top == Bottom)
+        {
+            // NOTE: Last job, race the thieves for it
+            Result = SDL_AtomicCAS(&Queue->Top, Top, Top + 1);
+            SDL_AtomicSet(&Queue->Bottom, Bottom + 1);
+        }
+    }
+    else
+    {
+        // NOTE: Was already empty
+        SDL_AtomicSet(&Queue->Bottom, Bottom + 1);
+    }
+
+    return Result;
+}
+
+// NOTE: Any thread. Fails when the queue is empty or another thread got the job first.
+internal b32
+JobQueue_Steal(platform_job_queue *Queue, platform_job *Out_Job)
+{
+    i32 Top = SDL_AtomicGet(&Queue->Top);
+    SDL_MemoryBarrierAcquire();
+    i32 Bottom = SDL_AtomicGet(&Queue->Bottom);
+
+    if (Top < Bottom)
+    {
+        // NOTE: Read before the CAS, once Top moves on the owner is free to reuse the slot
+        platform_job Job = Queue->Jobs[Top & (JOB_QUEUE_SIZE - 1)];
+        if (SDL_AtomicCAS(&Queue->Top, Top, Top + 1))
+        {
+            *Out_Job = Job;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+internal void
+JobSystem_RunJob(platform_job_worker *Worker, platform_job *Job)
+{
+    temporary_memory JobMemory = MemoryArena_BeginTemp(&Worker->ScratchArena);
+    Job->Proc(Job->Data, &Worker->ScratchArena);
+    MemoryArena_EndTemp(JobMemory);
+
+    // NOTE: Full barrier, everything the job wrote is visible once the waiter sees the count drop
+    SDL_AtomicAdd(&Job->Group->PendingCount_, -1);
+}
+
+// NOTE: Runs one job from the worker's own queue, or one stolen from another worker. Returns false if there was
+// nothing to run.
+internal b32
+JobSystem_TryRunJob(platform_job_worker *Worker)
+{
+    platform_job_system *JobSystem = Worker->JobSystem;
+    platform_job Job;
+
+    b32 Found = JobQueue_Pop(&Worker->Queue, &Job);
+
+    for (u32 Offset = 1;
+         !Found && Offset < JobSystem->WorkerCount;
+         ++Offset)
+    {
+        platform_job_worker *Victim = JobSystem->Workers + ((Worker->WorkerIndex + Offset) % JobSystem->WorkerCount);
+        Found = JobQueue_Steal(&Victim->Queue, &Job);
+    }
+
+    if (Found)
+    {
+        JobSystem_RunJob(Worker, &Job);
+    }
+
+    return Found;
+}
+
+internal void
+JobSystem_AddJob(platform_job_system *JobSystem, platform_job_group *Group, platform_job_proc *Proc, void *Data)
+{
+    platform_job_worker *Worker = GlobalThreadJobWorker;
+    Assert(Worker && Worker->JobSystem == JobSystem);
+
+    platform_job Job = {};
+    Job.Proc = Proc;
+    Job.Data = Data;
+    Job.Group = Group;
+
+    SDL_AtomicAdd(&Group->PendingCount_, 1);
+
+    if (JobSystem->WorkerCount > 1 && JobQueue_Push(&Worker->Queue, &Job))
+    {
+        SDL_SemPost(JobSystem->WakeSemaphore);
+    }
+    else
+    {
+        // NOTE: No other workers, or the queue is full; just run it right here
+        JobSystem_RunJob(Worker, &Job);
+    }
+}
+
+internal void
+JobSystem_WaitForJobGroup(platform_job_system *JobSystem, platform_job_group *Group)
+{
+    platform_job_worker *Worker = GlobalThreadJobWorker;
+    Assert(Worker && Worker->JobSystem == JobSystem);
+
+    while (SDL_AtomicGet(&Group->PendingCount_) > 0)
+    {
+        if (!JobSystem_TryRunJob(Worker))
+        {
+            // NOTE: Whatever is left is already running on other workers
+            JobSystem_Pause();
+        }
+    }
+}
+
+internal int
+JobSystem_WorkerThreadProc(void *Data)
+{
+    platform_job_worker *Worker = (platform_job_worker *) Data;
+    platform_job_system *JobSystem = Worker->JobSystem;
+    GlobalThreadJobWorker = Worker;
+
+    while (!SDL_AtomicGet(&JobSystem->ShouldQuit))
+    {
+        if (!JobSystem_TryRunJob(Worker))
+        {
+            // NOTE: A wake-up can be "used" by a worker that lost the race for the job, so a job may sit in a
+            // queue until the next post. Waiting on a group always helps though, so nothing is ever stuck.
+            SDL_SemWait(JobSystem->WakeSemaphore);
+        }
+    }
+
+    return 0;
+}
+
+// NOTE: Has to be called from the main thread, which becomes worker 0. WorkerCount includes it.
+internal platform_job_system *
+JobSystem_Create(u32 WorkerCount)
+{
+    WorkerCount = Min(Max(WorkerCount, 1u), (u32) JOB_MAX_WORKERS);
+
+    platform_job_system *JobSystem = (platform_job_system *) calloc(1, sizeof(platform_job_system));
+    Assert(JobSystem);
+
+    JobSystem->WorkerCount = WorkerCount;
+    JobSystem->WakeSemaphore = SDL_CreateSemaphore(0);
+    Assert(JobSystem->WakeSemaphore);
+
+    for (u32 WorkerIndex = 0;
+         WorkerIndex < WorkerCount;
+         ++WorkerIndex)
+    {
+        platform_job_worker *Worker = JobSystem->Workers + WorkerIndex;
+        Worker->JobSystem = JobSystem;
+        Worker->WorkerIndex = WorkerIndex;
+
+        u8 *ScratchMemory = (u8 *) ReserveMemory(JOB_SCRATCH_ARENA_SIZE);
+        Assert(ScratchMemory);
+        Worker->ScratchArena = MemoryArenaReserved(ScratchMemory, JOB_SCRATCH_ARENA_SIZE);
+    }
+
+    GlobalThreadJobWorker = JobSystem->Workers + 0;
+
+    for (u32 WorkerIndex = 1;
+         WorkerIndex < WorkerCount;
+         ++WorkerIndex)
+    {
+        platform_job_worker *Worker = JobSystem->Workers + WorkerIndex;
+
+        char ThreadName[32];
+        FormatString(ThreadName, sizeof(ThreadName), "OpusOne Worker %u", WorkerIndex);
+        Worker->Thread = SDL_CreateThread(JobSystem_WorkerThreadProc, ThreadName, Worker);
+        Assert(Worker->Thread);
+    }
+
+    return JobSystem;
+}
+
+internal void
+JobSystem_Destroy(platform_job_system *JobSystem)
+{
+    SDL_AtomicSet(&JobSystem->ShouldQuit, 1);
+
+    for (u32 WorkerIndex = 1;
+         WorkerIndex < JobSystem->WorkerCount;
+         ++WorkerIndex)
+    {
+        SDL_SemPost(JobSystem->WakeSemaphore);
+    }
+
+    for (u32 WorkerIndex = 1;
+         WorkerIndex < JobSystem->WorkerCount;
+         ++WorkerIndex)
+    {
+        SDL_WaitThread(JobSystem->Workers[WorkerIndex].Thread, 0);
+    }
+
+    SDL_DestroySemaphore(JobSystem->WakeSemaphore);
+    GlobalThreadJobWorker = 0;
+    free(JobSystem);
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef OPUSONE_PLATFORM_MODULE_CPP
+#define OPUSONE_PLATFORM_MODULE_CPP
+
+// NOTE: Game code as a shared object the platform reloads whenever a new build of it shows up (OPUSONE_HOT_RELOAD
+// builds, see build.sh). game_memory and everything in Storage survive, the game re-establishes its globals when
+// GameMemory->ModuleReloaded is set.
+//
+// dlopen only loads a path once, so every build is loaded from a copy with a fresh name (and the copy is deleted
+// again right away). Old builds are never closed: arena debug names and tags are string literals in the module,
+// jobs might still be running its code, and keeping a few MB mapped is cheaper than tracking all that.
+// build.sh writes the module under a temporary name and renames it, so a half-written one is never loaded.
+// Linux only for now. Only included by opusone_platform_services.cpp.
+
+#include <cstdio>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+
+struct game_module
+{
+    const char *Path;
+    void *Handle;
+    game_update_and_render *UpdateAndRender;
+
+    i64 LoadedWriteTime; // NOTE: Nanoseconds
+    u32 LoadCount; // NOTE: Attempts, failed ones included
+};
+
+internal i64
+GameModule_GetWriteTime_(const char *Path)
+{
+    struct stat FileStat;
+    i64 Result = 0;
+    if (stat(Path, &FileStat) == 0 && FileStat.st_size > 0)
+    {
+        Result = (i64) FileStat.st_mtim.tv_sec * 1000000000 + (i64) FileStat.st_mtim.tv_nsec;
+    }
+    return Result;
+}
+
+internal b32
+GameModule_CopyFile_(const char *SourcePath, const char *DestPath)
+{
+    FILE *Source = fopen(SourcePath, "rb");
+    if (!Source)
+    {
+        return false;
+    }
+    FILE *Dest = fopen(DestPath, "wb");
+    if (!Dest)
+    {
+        fclose(Source);
+        return false;
+    }
+
+    b32 Result = true;
+    char Buffer[65536];
+    size_t BytesRead;
+    while (Result && (BytesRead = fread(Buffer, 1, sizeof(Buffer), Source)) > 0)
+    {
+        Result = (fwrite(Buffer, 1, BytesRead, Dest) == BytesRead);
+    }
+
+    fclose(Source);
+    Result = (fclose(Dest) == 0) && Result;
+    return Result;
+}
+
+// NOTE: Keeps the current build if the new one fails to load, so a broken build doesn't take the game down
+internal b32
+GameModule_Load_(game_module *Module)
+{
+    i64 WriteTime = GameModule_GetWriteTime_(Module->Path);
+    if (!WriteTime)
+    {
+        return false;
+    }
+
+    // NOTE: Every attempt gets a new name, dlopen hands back the handle it already has for a path it has seen
+    char LoadPath[512];
+    FormatString(LoadPath, sizeof(LoadPath), "%s.%u.loaded", Module->Path, Module->LoadCount++);
+    if (!GameModule_CopyFile_(Module->Path, LoadPath))
+    {
+        printf("PLATFORM: Could not copy %s to %s\n", Module->Path, LoadPath);
+        return false;
+    }
+
+    void *Handle = dlopen(LoadPath, RTLD_NOW | RTLD_LOCAL);
+    remove(LoadPath);
+    if (!Handle)
+    {
+        printf("PLATFORM: Could not load %s: %s\n", Module->Path, dlerror());
+        return false;
+    }
+
+    game_update_and_render *UpdateAndRender = (game_update_and_render *) dlsym(Handle, "GameUpdateAndRender");
+    if (!UpdateAndRender)
+    {
+        printf("PLATFORM: %s has no GameUpdateAndRender\n", Module->Path);
+        dlclose(Handle);
+        return false;
+    }
+
+    Module->Handle = Handle;
+    Module->UpdateAndRender = UpdateAndRender;
+    Module->LoadedWriteTime = WriteTime;
+    return true;
+}
+
+internal b32
+GameModule_Open(game_module *Module, const char *Path)
+{
+    *Module = {};
+    Module->Path = Path;
+
+    b32 Result = GameModule_Load_(Module);
+    if (Result)
+    {
+        printf("PLATFORM: Loaded game module %s\n", Path);
+    }
+    return Result;
+}
+
+// NOTE: Call between frames. Returns true when a new build was loaded.
+internal b32
+GameModule_ReloadIfChanged(game_module *Module)
+{
+    i64 WriteTime = GameModule_GetWriteTime_(Module->Path);
+    if (!WriteTime || WriteTime == Module->LoadedWriteTime)
+    {
+        return false;
+    }
+
+    u64 StartCounter = SDL_GetPerformanceCounter();
+    b32 Result = GameModule_Load_(Module);
+    if (Result)
+    {
+        f64 Ms = (f64) (SDL_GetPerformanceCounter() - StartCounter) * 1000.0 / (f64) SDL_GetPerformanceFrequency();
+        printf("PLATFORM: Reloaded game module %s (attempt %u, %0.2fms)\n", Module->Path, Module->LoadCount, Ms);
+    }
+    else
+    {
+        // NOTE: Don't retry the same broken build every frame
+        Module->LoadedWriteTime = WriteTime;
+    }
+    return Result;
+}
+
+#endif
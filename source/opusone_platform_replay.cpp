@@ -0,0 +1,448 @@
+#ifndef OPUSONE_PLATFORM_REPLAY_CPP
+#define OPUSONE_PLATFORM_REPLAY_CPP
+
+// NOTE: Input recording and playback. A replay file holds the game_input as it was when recording started,
+// optionally a snapshot of the committed pages of game_memory::Storage, and then every frame's input: timing,
+// mouse, screen size and the events from the ring. Playback feeds those through the same BeginInputFrame/Push*
+// calls the platform layers use, so the game sees a bit-exact copy of the recorded game_input, DeltaTime and
+// FrameTime included, no matter how fast the frames actually run.
+//
+// Without a snapshot a replay has to be played from launch (recording started before the first frame), the game
+// initializes itself the same way both times. A snapshot only restores Storage, so it's only good within the
+// process that recorded it (GL objects, fonts, the job system etc. live outside of it). The first time playback
+// reads the snapshot it also keeps it as a platform_snapshot (opusone_platform_snapshot.cpp), so looping only
+// restores the pages the playback changed instead of reading all of Storage back from the file.
+// Only included by opusone_platform_services.cpp.
+
+#include <cstdio>
+#include <cstring>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+
+#define REPLAY_FILE_MAGIC 0x504C5252 // NOTE: "RRLP"
+#define REPLAY_FILE_VERSION 1
+
+struct replay_file_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 GameInputSize; // NOTE: Replays only work with the build (well, the game_input layout) that made them
+    u32 HasSnapshot;
+    u64 StorageSize;
+    u64 StorageBase; // NOTE: A snapshot can't be restored at any other address (or, really, in another process)
+};
+
+// NOTE: Snapshot ranges follow the initial game_input, terminated by a range with Size 0
+struct replay_snapshot_range
+{
+    u64 Offset;
+    u64 Size;
+};
+
+struct replay_frame_header
+{
+    f64 FrameTime;
+    f32 DeltaTime;
+    i32 MouseX;
+    i32 MouseY;
+    i32 MouseDeltaX;
+    i32 MouseDeltaY;
+    i32 ScreenWidth;
+    i32 ScreenHeight;
+    u32 EventCount; // NOTE: input_events follow
+};
+
+enum replay_mode
+{
+    ReplayMode_None,
+    ReplayMode_Recording,
+    ReplayMode_Playback,
+};
+
+struct replay_state
+{
+    replay_mode Mode;
+    FILE *File;
+    u32 FrameCount;
+    b32 HasSnapshot;
+    b32 IsBroken; // NOTE: Playback hit data that can't have been recorded, looping would only hit it again
+
+    platform_job_system *JobSystem;
+    platform_snapshot LoopSnapshot;
+    long FramesOffset; // NOTE: Where the first frame starts, past the snapshot
+};
+
+internal b32
+Replay_Write_(FILE *File, void *Data, size_t Size)
+{
+    b32 Result = (Size == 0) || (fwrite(Data, Size, 1, File) == 1);
+    return Result;
+}
+
+internal b32
+Replay_Read_(FILE *File, void *Data, size_t Size)
+{
+    b32 Result = (Size == 0) || (fread(Data, Size, 1, File) == 1);
+    return Result;
+}
+
+internal b32
+Replay_WriteSnapshot_(FILE *File, game_memory *GameMemory)
+{
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+    Assert(CommitMap->Base == (u8 *) GameMemory->Storage);
+
+    b32 Result = true;
+    size_t At = 0;
+    size_t Offset;
+    size_t Size;
+    while (Result && CommitMap_GetNextRange(CommitMap, &At, &Offset, &Size))
+    {
+        replay_snapshot_range Range = { Offset, Size };
+        Result = (Replay_Write_(File, &Range, sizeof(Range)) &&
+                  Replay_Write_(File, CommitMap->Base + Offset, Size));
+    }
+
+    replay_snapshot_range EndRange = {};
+    Result = Result && Replay_Write_(File, &EndRange, sizeof(EndRange));
+
+    return Result;
+}
+
+internal b32
+Replay_ReadSnapshot_(FILE *File, game_memory *GameMemory)
+{
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+    Assert(CommitMap->Base == (u8 *) GameMemory->Storage);
+
+    // NOTE: Pages committed after the snapshot was taken go back to zero, like they were back then
+    size_t At = 0;
+    size_t Offset;
+    size_t Size;
+    while (CommitMap_GetNextRange(CommitMap, &At, &Offset, &Size))
+    {
+        memset(CommitMap->Base + Offset, 0, Size);
+    }
+
+    for (;;)
+    {
+        replay_snapshot_range Range;
+        if (!Replay_Read_(File, &Range, sizeof(Range)) ||
+            (Range.Offset + Range.Size) > GameMemory->StorageSize)
+        {
+            return false;
+        }
+        if (Range.Size == 0)
+        {
+            break;
+        }
+
+        Platform_CommitMemory(CommitMap->Base + Range.Offset, (size_t) Range.Size);
+        if (!Replay_Read_(File, CommitMap->Base + Range.Offset, (size_t) Range.Size))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// NOTE: The file is only as trustworthy as the disk it came from, everything that indexes an array is checked before
+// it goes anywhere near Push*
+internal b32
+Replay_EventIsValid_(input_event *Event)
+{
+    b32 Result = false;
+    switch (Event->Type)
+    {
+        case InputEvent_KeyDown:
+        case InputEvent_KeyUp:
+        {
+            Result = (Event->Code < SDL_NUM_SCANCODES);
+        } break;
+        case InputEvent_MouseButtonDown:
+        case InputEvent_MouseButtonUp:
+        {
+            Result = (Event->Code < MouseButton_Count);
+        } break;
+        default:
+        {
+            Result = false;
+        } break;
+    }
+    return Result;
+}
+
+internal void
+Replay_Close_(replay_state *Replay)
+{
+    if (Replay->File)
+    {
+        fclose(Replay->File);
+    }
+    if (Replay->LoopSnapshot.IsValid)
+    {
+        Snapshot_Release(Replay->JobSystem, &Replay->LoopSnapshot);
+    }
+    *Replay = {};
+}
+
+// NOTE: Call between frames. Every frame after this goes through Replay_RecordFrame.
+internal b32
+Replay_BeginRecording(replay_state *Replay, const char *Path, game_input *GameInput, game_memory *GameMemory,
+                      b32 WithSnapshot)
+{
+    Assert(Replay->Mode == ReplayMode_None);
+
+    *Replay = {};
+    Replay->File = OpenFile_(Path, "wb");
+    if (!Replay->File)
+    {
+        printf("PLATFORM: Could not open %s for recording\n", Path);
+        return false;
+    }
+
+    replay_file_header Header = {};
+    Header.Magic = REPLAY_FILE_MAGIC;
+    Header.Version = REPLAY_FILE_VERSION;
+    Header.GameInputSize = sizeof(game_input);
+    Header.HasSnapshot = WithSnapshot;
+    Header.StorageSize = GameMemory->StorageSize;
+    Header.StorageBase = (u64) (size_t) GameMemory->Storage;
+
+    b32 Written = (Replay_Write_(Replay->File, &Header, sizeof(Header)) &&
+                   Replay_Write_(Replay->File, GameInput, sizeof(game_input)));
+    if (Written && WithSnapshot)
+    {
+        Written = Replay_WriteSnapshot_(Replay->File, GameMemory);
+    }
+
+    if (!Written)
+    {
+        printf("PLATFORM: Could not write %s\n", Path);
+        Replay_Close_(Replay);
+        return false;
+    }
+
+    Replay->Mode = ReplayMode_Recording;
+    Replay->HasSnapshot = WithSnapshot;
+    printf("PLATFORM: Recording input to %s%s\n", Path, WithSnapshot ? " (with snapshot)" : "");
+
+    return true;
+}
+
+// NOTE: After the platform gathered this frame's input, before the game runs
+internal void
+Replay_RecordFrame(replay_state *Replay, game_input *GameInput)
+{
+    Assert(Replay->Mode == ReplayMode_Recording);
+
+    // NOTE: Events that already fell out of the ring are lost, the ring is sized so that doesn't happen
+    u64 FirstEvent = Platform_GetFrameFirstEvent_(GameInput);
+    if (FirstEvent != GameInput->FrameFirstEvent_)
+    {
+        printf("PLATFORM: Too many input events in one frame, replay won't match\n");
+    }
+
+    replay_frame_header Frame = {};
+    Frame.FrameTime = GameInput->FrameTime;
+    Frame.DeltaTime = GameInput->DeltaTime;
+    Frame.MouseX = GameInput->MouseX;
+    Frame.MouseY = GameInput->MouseY;
+    Frame.MouseDeltaX = GameInput->MouseDeltaX;
+    Frame.MouseDeltaY = GameInput->MouseDeltaY;
+    Frame.ScreenWidth = GameInput->ScreenWidth;
+    Frame.ScreenHeight = GameInput->ScreenHeight;
+    Frame.EventCount = (u32) (GameInput->EventCount_ - FirstEvent);
+
+    b32 Written = Replay_Write_(Replay->File, &Frame, sizeof(Frame));
+    for (u64 EventIndex = FirstEvent;
+         Written && EventIndex < GameInput->EventCount_;
+         ++EventIndex)
+    {
+        Written = Replay_Write_(Replay->File, GameInput->Events_ + (EventIndex & (INPUT_EVENT_RING_SIZE - 1)), sizeof(input_event));
+    }
+
+    if (!Written)
+    {
+        printf("PLATFORM: Could not write replay frame, recording stopped\n");
+        Replay_Close_(Replay);
+        return;
+    }
+
+    Replay->FrameCount++;
+}
+
+internal void
+Replay_EndRecording(replay_state *Replay)
+{
+    Assert(Replay->Mode == ReplayMode_Recording);
+    printf("PLATFORM: Recorded %u frames\n", Replay->FrameCount);
+    Replay_Close_(Replay);
+}
+
+// NOTE: Puts GameInput (and Storage, if there's a snapshot) back to where they were when recording started
+internal b32
+Replay_Rewind_(replay_state *Replay, game_input *GameInput, game_memory *GameMemory)
+{
+    b32 Result = (fseek(Replay->File, (long) sizeof(replay_file_header), SEEK_SET) == 0 &&
+                  Replay_Read_(Replay->File, GameInput, sizeof(game_input)));
+    if (Result && Replay->HasSnapshot)
+    {
+        if (Replay->LoopSnapshot.IsValid)
+        {
+            Snapshot_Restore(GameMemory->JobSystem, &Replay->LoopSnapshot);
+            Result = (fseek(Replay->File, Replay->FramesOffset, SEEK_SET) == 0);
+        }
+        else
+        {
+            Result = Replay_ReadSnapshot_(Replay->File, GameMemory);
+            if (Result)
+            {
+                Replay->FramesOffset = ftell(Replay->File);
+                Replay->JobSystem = GameMemory->JobSystem;
+                Snapshot_Take(GameMemory->JobSystem, &Replay->LoopSnapshot, 0);
+            }
+        }
+    }
+
+    Replay->FrameCount = 0;
+    return Result;
+}
+
+// NOTE: Call between frames, GameInput is overwritten with the recorded one
+internal b32
+Replay_BeginPlayback(replay_state *Replay, const char *Path, game_input *GameInput, game_memory *GameMemory)
+{
+    Assert(Replay->Mode == ReplayMode_None);
+
+    *Replay = {};
+    Replay->File = OpenFile_(Path, "rb");
+    if (!Replay->File)
+    {
+        printf("PLATFORM: Could not open replay %s\n", Path);
+        return false;
+    }
+
+    replay_file_header Header;
+    if (!Replay_Read_(Replay->File, &Header, sizeof(Header)) ||
+        Header.Magic != REPLAY_FILE_MAGIC || Header.Version != REPLAY_FILE_VERSION ||
+        Header.GameInputSize != sizeof(game_input) || Header.StorageSize != GameMemory->StorageSize)
+    {
+        printf("PLATFORM: %s is not a replay for this build\n", Path);
+        Replay_Close_(Replay);
+        return false;
+    }
+
+    if (Header.HasSnapshot && Header.StorageBase != (u64) (size_t) GameMemory->Storage)
+    {
+        printf("PLATFORM: %s has a snapshot from another run\n", Path);
+        Replay_Close_(Replay);
+        return false;
+    }
+
+    Replay->HasSnapshot = Header.HasSnapshot;
+    if (!Replay_Rewind_(Replay, GameInput, GameMemory))
+    {
+        printf("PLATFORM: %s is truncated\n", Path);
+        Replay_Close_(Replay);
+        return false;
+    }
+
+    Replay->Mode = ReplayMode_Playback;
+    printf("PLATFORM: Playing back %s%s\n", Path, Replay->HasSnapshot ? " (with snapshot)" : "");
+
+    return true;
+}
+
+// NOTE: Replaces the platform's input gathering for a frame. Returns false once the recording has run out or turned
+// out to be broken.
+internal b32
+Replay_PlayFrame(replay_state *Replay, game_input *GameInput)
+{
+    Assert(Replay->Mode == ReplayMode_Playback);
+
+    replay_frame_header Frame;
+    if (!Replay_Read_(Replay->File, &Frame, sizeof(Frame)))
+    {
+        return false;
+    }
+    if (Frame.EventCount > INPUT_EVENT_RING_SIZE)
+    {
+        printf("PLATFORM: Replay frame %u has %u input events, the replay is broken, playback stopped\n",
+               Replay->FrameCount, Frame.EventCount);
+        Replay->IsBroken = true;
+        return false;
+    }
+
+    BeginInputFrame(GameInput);
+
+    for (u32 EventIndex = 0;
+         EventIndex < Frame.EventCount;
+         ++EventIndex)
+    {
+        input_event Event;
+        if (!Replay_Read_(Replay->File, &Event, sizeof(Event)))
+        {
+            return false;
+        }
+        if (!Replay_EventIsValid_(&Event))
+        {
+            printf("PLATFORM: Replay frame %u has an invalid input event (type %u, code %u), the replay is broken, "
+                   "playback stopped\n", Replay->FrameCount, (u32) Event.Type, Event.Code);
+            Replay->IsBroken = true;
+            return false;
+        }
+
+        switch (Event.Type)
+        {
+            case InputEvent_KeyDown:
+            case InputEvent_KeyUp:
+            {
+                PushKeyEvent(GameInput, Event.Code, (Event.Type == InputEvent_KeyDown), Event.Time);
+            } break;
+            case InputEvent_MouseButtonDown:
+            case InputEvent_MouseButtonUp:
+            {
+                PushMouseButtonEvent(GameInput, (mouse_button_type) Event.Code, (Event.Type == InputEvent_MouseButtonDown), Event.Time);
+            } break;
+            default:
+            {
+                InvalidCodePath;
+            } break;
+        }
+    }
+
+    GameInput->FrameTime = Frame.FrameTime;
+    GameInput->DeltaTime = Frame.DeltaTime;
+    GameInput->MouseX = Frame.MouseX;
+    GameInput->MouseY = Frame.MouseY;
+    GameInput->MouseDeltaX = Frame.MouseDeltaX;
+    GameInput->MouseDeltaY = Frame.MouseDeltaY;
+    GameInput->ScreenWidth = Frame.ScreenWidth;
+    GameInput->ScreenHeight = Frame.ScreenHeight;
+
+    Replay->FrameCount++;
+    return true;
+}
+
+// NOTE: Only replays with a snapshot can loop, the others would need the game to start over
+internal b32
+Replay_LoopPlayback(replay_state *Replay, game_input *GameInput, game_memory *GameMemory)
+{
+    Assert(Replay->Mode == ReplayMode_Playback);
+
+    b32 Result = Replay->HasSnapshot && !Replay->IsBroken && Replay_Rewind_(Replay, GameInput, GameMemory);
+    return Result;
+}
+
+internal void
+Replay_EndPlayback(replay_state *Replay)
+{
+    Assert(Replay->Mode == ReplayMode_Playback);
+    printf("PLATFORM: Played back %u frames\n", Replay->FrameCount);
+    Replay_Close_(Replay);
+}
+
+#endif
@@ -0,0 +1,682 @@
+#ifndef OPUSONE_PLATFORM_SERVICES_CPP
+#define OPUSONE_PLATFORM_SERVICES_CPP
+
+// NOTE: Platform services every platform layer shares (sdl_opusone.cpp, headless_opusone.cpp): memory, files,
+// images and fonts (SDL_image and SDL_ttf don't need a window), and the job system. The platform layers
+// themselves only own the main loop, the GL context and input.
+
+#include <cstdlib>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+
+global_variable b32 GlobalUseHugePages;
+
+internal void *
+ReserveMemory(size_t Size)
+{
+#ifdef _WIN32
+    void *Result = VirtualAlloc(0, Size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void *Result = mmap(0, Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (Result == MAP_FAILED)
+    {
+        Result = 0;
+    }
+#endif
+    
+    return Result;
+}
+
+internal size_t
+GetPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    size_t Result = SystemInfo.dwPageSize;
+#else
+    size_t Result = (size_t) sysconf(_SC_PAGESIZE);
+#endif
+    
+    return Result;
+}
+
+// NOTE: Which pages of game_memory::Storage are committed, one bit per page. Snapshots only copy these,
+// everything else is still untouched reserved address space. Jobs push into Storage arenas too (startup model
+// imports, collision cooking, string interning), so pages get committed from worker threads and the bits are
+// set with an atomic or. Snapshots are only taken between frames, when no job is running.
+struct commit_map
+{
+    u8 *Base;
+    size_t Size;
+    size_t PageSize;
+    u64 *PageBits;
+};
+
+global_variable commit_map GlobalStorageCommitMap;
+
+internal void
+AtomicOrU64_(u64 *Dest, u64 Value)
+{
+#ifdef _WIN32
+    InterlockedOr64((LONG64 volatile *) Dest, (LONG64) Value);
+#else
+    __atomic_fetch_or(Dest, Value, __ATOMIC_RELAXED);
+#endif
+}
+
+internal void
+CommitMap_Mark(commit_map *CommitMap, size_t Start, size_t End)
+{
+    size_t MapStart = (size_t) CommitMap->Base;
+    size_t MapEnd = MapStart + CommitMap->Size;
+    if (!CommitMap->PageBits || End <= MapStart || Start >= MapEnd)
+    {
+        return;
+    }
+
+    Start = Max(Start, MapStart);
+    End = Min(End, MapEnd);
+    for (size_t PageIndex = (Start - MapStart) / CommitMap->PageSize;
+         PageIndex < (End - MapStart) / CommitMap->PageSize;
+         ++PageIndex)
+    {
+        // NOTE: Two threads committing pages that share a word would otherwise lose each other's bits, and a lost bit
+        // is a page snapshots silently skip
+        AtomicOrU64_(CommitMap->PageBits + PageIndex / 64, 1ULL << (PageIndex % 64));
+    }
+}
+
+internal b32
+CommitMap_IsPageCommitted(commit_map *CommitMap, size_t PageIndex)
+{
+    b32 Result = (CommitMap->PageBits[PageIndex / 64] >> (PageIndex % 64)) & 1;
+    return Result;
+}
+
+// NOTE: Finds the next run of committed pages at or after *At. Returns false when there are no more.
+internal b32
+CommitMap_GetNextRange(commit_map *CommitMap, size_t *At, size_t *Out_Offset, size_t *Out_Size)
+{
+    size_t PageCount = CommitMap->Size / CommitMap->PageSize;
+    size_t PageIndex = *At / CommitMap->PageSize;
+
+    while (PageIndex < PageCount && !CommitMap_IsPageCommitted(CommitMap, PageIndex))
+    {
+        // NOTE: Skip empty words whole, most of Storage is never committed
+        if ((PageIndex % 64) == 0 && CommitMap->PageBits[PageIndex / 64] == 0)
+        {
+            PageIndex += 64;
+        }
+        else
+        {
+            PageIndex++;
+        }
+    }
+    if (PageIndex >= PageCount)
+    {
+        *At = CommitMap->Size;
+        return false;
+    }
+
+    size_t FirstPage = PageIndex;
+    while (PageIndex < PageCount && CommitMap_IsPageCommitted(CommitMap, PageIndex))
+    {
+        PageIndex++;
+    }
+
+    *Out_Offset = FirstPage * CommitMap->PageSize;
+    *Out_Size = (PageIndex - FirstPage) * CommitMap->PageSize;
+    *At = PageIndex * CommitMap->PageSize;
+    return true;
+}
+
+void
+Platform_CommitMemory(void *Address, size_t Size)
+{
+    if (Size == 0)
+    {
+        return;
+    }
+    
+    // NOTE: Arenas don't know about pages, so round out to whole pages. Committing a page twice is fine.
+    size_t PageMask = GetPageSize() - 1;
+    size_t Start = (size_t) Address & ~PageMask;
+    size_t End = ((size_t) Address + Size + PageMask) & ~PageMask;
+
+#ifdef _WIN32
+    void *Result = VirtualAlloc((void *) Start, End - Start, MEM_COMMIT, PAGE_READWRITE);
+    Assert(Result);
+#else
+    i32 Result = mprotect((void *) Start, End - Start, PROT_READ | PROT_WRITE);
+    Assert(Result == 0);
+#endif
+
+    CommitMap_Mark(&GlobalStorageCommitMap, Start, End);
+}
+
+void
+Platform_AdviseHugePages(void *Address, size_t Size)
+{
+#ifndef _WIN32
+    if (GlobalUseHugePages)
+    {
+        // NOTE: Transparent huge pages are advisory; if the kernel has them disabled this is a no-op.
+        // Only whole 2MB-aligned ranges can be backed by huge pages, so shrink the range inwards.
+        size_t HugePageMask = Megabytes(2) - 1;
+        size_t Start = ((size_t) Address + HugePageMask) & ~HugePageMask;
+        size_t End = ((size_t) Address + Size) & ~HugePageMask;
+        if (End > Start)
+        {
+            madvise((void *) Start, End - Start, MADV_HUGEPAGE);
+        }
+    }
+#endif
+}
+
+internal FILE *
+OpenFile_(const char *FilePath, const char *Mode)
+{
+#ifdef _WIN32
+    FILE *File = 0;
+    fopen_s(&File, FilePath, Mode);
+#else
+    FILE *File = fopen(FilePath, Mode);
+#endif
+    return File;
+}
+
+char *
+Platform_ReadFile(const char *FilePath)
+{
+    FILE *File = OpenFile_(FilePath, "rb");
+    // TODO: Handle errors opening files properly
+    Assert(File);
+    
+    fseek(File, 0, SEEK_END);
+    size_t FileSize = ftell(File);
+    Assert(FileSize > 0);
+    fseek(File, 0, SEEK_SET);
+
+    char *Result = (char *) malloc(FileSize + 1);
+    Assert(Result);
+    size_t ElementsRead = fread(Result, FileSize, 1, File);
+    Assert(ElementsRead == 1);
+    Result[FileSize] = '\0';
+
+    fclose(File);
+
+    return Result;
+}
+
+b32
+Platform_WriteFile(const char *FilePath, void *Data, size_t Size)
+{
+    FILE *File = OpenFile_(FilePath, "wb");
+    if (!File)
+    {
+        return false;
+    }
+
+    size_t ElementsWritten = fwrite(Data, Size, 1, File);
+    fclose(File);
+
+    return (ElementsWritten == 1);
+}
+
+platform_mapped_file
+Platform_MapFile(const char *FilePath, platform_map_hint Hint)
+{
+    platform_mapped_file Result = {};
+
+#ifdef _WIN32
+    DWORD Flags = (Hint == MapHint_Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE File = CreateFileA(FilePath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, Flags, 0);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return Result;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (GetFileSizeEx(File, &FileSize) && FileSize.QuadPart > 0)
+    {
+        // NOTE: The view keeps the mapping and the file open, both handles can go right away
+        HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+        if (Mapping)
+        {
+            Result.Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+            Result.Size = Result.Data ? (size_t) FileSize.QuadPart : 0;
+            CloseHandle(Mapping);
+        }
+    }
+    CloseHandle(File);
+#else
+    int File = open(FilePath, O_RDONLY);
+    if (File < 0)
+    {
+        return Result;
+    }
+
+    struct stat FileStat;
+    if (fstat(File, &FileStat) == 0 && FileStat.st_size > 0)
+    {
+        void *Data = mmap(0, (size_t) FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+        if (Data != MAP_FAILED)
+        {
+            Result.Data = Data;
+            Result.Size = (size_t) FileStat.st_size;
+            // NOTE: Advice values aren't flags, each one is its own call
+            if (Hint == MapHint_Sequential)
+            {
+                madvise(Result.Data, Result.Size, MADV_SEQUENTIAL);
+                madvise(Result.Data, Result.Size, MADV_WILLNEED);
+            }
+            else
+            {
+                madvise(Result.Data, Result.Size, MADV_RANDOM);
+            }
+        }
+    }
+    // NOTE: The mapping holds its own reference to the file
+    close(File);
+#endif
+
+    return Result;
+}
+
+void
+Platform_UnmapFile(platform_mapped_file *MappedFile)
+{
+    if (MappedFile->Data)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(MappedFile->Data);
+#else
+        munmap(MappedFile->Data, MappedFile->Size);
+#endif
+    }
+    MappedFile->Data = 0;
+    MappedFile->Size = 0;
+}
+
+void
+Platform_Free(void *Memory)
+{
+    free(Memory);
+}
+
+internal platform_image
+ImageFromSurface_(SDL_Surface *ImageSurface)
+{
+    platform_image Result = {};
+
+    Result.Width = (u32) ImageSurface->w;
+    Result.Height = (u32) ImageSurface->h;
+    Result.Pitch = (u32) ImageSurface->pitch;
+    Result.BytesPerPixel = (u32) ImageSurface->format->BytesPerPixel;
+    Result.ImageData = (u8 *) ImageSurface->pixels;
+    Result.PointerToFree_ = (void *) ImageSurface;
+
+    return Result;
+}
+
+platform_image
+Platform_LoadImage(const char *ImagePath)
+{
+    // TODO: JPG and PNG only for now, BMPs have to be handled separately
+    SDL_Surface *ImageSurface = IMG_Load(ImagePath);
+    // TODO: Handle errors opening images properly
+    Assert(ImageSurface);
+
+    platform_image Result = ImageFromSurface_(ImageSurface);
+    return Result;
+}
+
+platform_image
+Platform_LoadImageFromMemory(void *Data, size_t Size, const char *Name)
+{
+    SDL_RWops *RWops = SDL_RWFromConstMem(Data, (i32) Size);
+    Assert(RWops);
+    
+    // NOTE: Closes RWops
+    SDL_Surface *ImageSurface = IMG_Load_RW(RWops, 1);
+    if (!ImageSurface)
+    {
+        printf("PLATFORM: Could not decode image %s: %s\n", Name, SDL_GetError());
+    }
+    // TODO: Handle errors decoding images properly
+    Assert(ImageSurface);
+
+    platform_image Result = ImageFromSurface_(ImageSurface);
+    return Result;
+}
+
+void
+Platform_FreeImage(platform_image *PlatformImage)
+{
+    SDL_FreeSurface((SDL_Surface *) PlatformImage->PointerToFree_);
+    PlatformImage->ImageData = 0;
+    PlatformImage->PointerToFree_ = 0;
+}
+
+platform_font
+Platform_LoadFont(const char *FontPath, u32 PointSize)
+{
+    platform_font Result = {};
+    TTF_Font *Font = TTF_OpenFont(FontPath, PointSize);
+    Assert(Font);
+
+    Result.Font_ = (void *) Font;
+    Result.Height = TTF_FontHeight(Font);
+    Result.PointSize = PointSize;
+    
+    return Result;
+}
+
+void
+Platform_CloseFont(platform_font *PlatformFont)
+{
+    TTF_CloseFont((TTF_Font  *) PlatformFont->Font_);
+    PlatformFont->Font_ = 0;
+}
+
+void
+Platform_GetGlyphMetrics(platform_font *PlatformFont, char Glyph,
+                        i32 *Out_MinX, i32 *Out_MaxX, i32 *Out_MinY, i32 *Out_MaxY, i32 *Out_Advance)
+{
+    Assert(PlatformFont);
+    Assert(PlatformFont->Font_);
+    Assert(Out_MinX);
+    Assert(Out_MaxX);
+    Assert(Out_MinY);
+    Assert(Out_MaxY);
+    Assert(Out_Advance);
+   
+    TTF_GlyphMetrics((TTF_Font *) PlatformFont->Font_, Glyph, Out_MinX, Out_MaxX, Out_MinY, Out_MaxY, Out_Advance);
+}
+
+platform_image
+Platform_RenderGlyph(platform_font *PlatformFont, char Glyph)
+{
+    Assert(PlatformFont);
+    Assert(PlatformFont->Font_);
+    TTF_Font *TTFFont = (TTF_Font *) PlatformFont->Font_;
+    
+    SDL_Surface *GlyphSurface = TTF_RenderGlyph_Blended(TTFFont, Glyph, SDL_Color { 255, 255, 255, 255 });
+
+    // TODO: Handle errors opening images properly
+    Assert(GlyphSurface);
+
+    platform_image Result {};
+
+    Result.Width = (u32) GlyphSurface->w;
+    Result.Height = (u32) GlyphSurface->h;
+    Result.Pitch = (u32) GlyphSurface->pitch;
+    Result.BytesPerPixel = (u32) GlyphSurface->format->BytesPerPixel;
+    Result.ImageData = (u8 *) GlyphSurface->pixels;
+    Result.PointerToFree_ = (void *) GlyphSurface;
+
+    return Result;
+}
+
+void
+Platform_SaveImageToDisk(const char *Path, platform_image *PlatformImage, u32 RMask, u32 GMask, u32 BMask, u32 AMask)
+{
+    SDL_Surface *Surface = SDL_CreateRGBSurfaceFrom((void *) PlatformImage->ImageData,
+                                                    PlatformImage->Width,
+                                                    PlatformImage->Height,
+                                                    PlatformImage->BytesPerPixel * 8,
+                                                    PlatformImage->Pitch,
+                                                    RMask, GMask, BMask, AMask);
+
+    i32 Result = SDL_SaveBMP(Surface, Path);
+    Assert(Result == 0);
+    
+    SDL_FreeSurface(Surface);
+}
+
+
+//
+// NOTE: Input. The platform layers feed key and mouse transitions through these, see game_input.
+//
+internal void
+BeginInputFrame(game_input *GameInput)
+{
+    GameInput->FrameIndex++;
+    GameInput->FrameFirstEvent_ = GameInput->EventCount_;
+    GameInput->MouseDeltaX = 0;
+    GameInput->MouseDeltaY = 0;
+}
+
+internal void
+PushInputEvent_(game_input *GameInput, input_event_type Type, u32 Code, f64 Time)
+{
+    input_event *Event = GameInput->Events_ + (GameInput->EventCount_++ & (INPUT_EVENT_RING_SIZE - 1));
+    Event->Type = Type;
+    Event->Code = Code;
+    Event->Time = Time;
+}
+
+internal void
+PushKeyEvent(game_input *GameInput, u32 Scancode, b32 IsDown, f64 Time)
+{
+    Assert(Scancode < SDL_NUM_SCANCODES);
+    
+    // NOTE: Drops key repeats, only real transitions go in
+    if ((b32) GameInput->KeyIsDown_[Scancode] == IsDown)
+    {
+        return;
+    }
+
+    GameInput->KeyIsDown_[Scancode] = (u8) IsDown;
+    if (IsDown)
+    {
+        GameInput->KeyPressedFrame_[Scancode] = GameInput->FrameIndex;
+    }
+    else
+    {
+        GameInput->KeyReleasedFrame_[Scancode] = GameInput->FrameIndex;
+    }
+
+    PushInputEvent_(GameInput, IsDown ? InputEvent_KeyDown : InputEvent_KeyUp, Scancode, Time);
+}
+
+internal void
+PushMouseButtonEvent(game_input *GameInput, mouse_button_type MouseButton, b32 IsDown, f64 Time)
+{
+    Assert(MouseButton < MouseButton_Count);
+    
+    if ((b32) GameInput->MouseButtonIsDown_[MouseButton] == IsDown)
+    {
+        return;
+    }
+
+    GameInput->MouseButtonIsDown_[MouseButton] = (u8) IsDown;
+    if (IsDown)
+    {
+        GameInput->MouseButtonPressedFrame_[MouseButton] = GameInput->FrameIndex;
+    }
+    else
+    {
+        GameInput->MouseButtonReleasedFrame_[MouseButton] = GameInput->FrameIndex;
+    }
+
+    PushInputEvent_(GameInput, IsDown ? InputEvent_MouseButtonDown : InputEvent_MouseButtonUp, MouseButton, Time);
+}
+
+// NOTE: Motion is only accumulated per frame, camera look doesn't need sub-frame timing
+internal void
+PushMouseMotion(game_input *GameInput, i32 MouseX, i32 MouseY, i32 DeltaX, i32 DeltaY)
+{
+    GameInput->MouseX = MouseX;
+    GameInput->MouseY = MouseY;
+    GameInput->MouseDeltaX += DeltaX;
+    GameInput->MouseDeltaY += DeltaY;
+}
+
+#include "opusone_platform_jobs.cpp"
+#include "opusone_platform_snapshot.cpp"
+#include "opusone_platform_replay.cpp"
+#if OPUSONE_HOT_RELOAD
+#include "opusone_platform_module.cpp"
+#endif
+
+
+//
+// NOTE: File queries
+//
+b32
+Platform_GetFileSize(const char *FilePath, size_t *Out_Size)
+{
+    FILE *File = OpenFile_(FilePath, "rb");
+    if (!File)
+    {
+        return false;
+    }
+
+    fseek(File, 0, SEEK_END);
+    long FileSize = ftell(File);
+    fclose(File);
+
+    if (FileSize < 0)
+    {
+        return false;
+    }
+
+    *Out_Size = (size_t) FileSize;
+    return true;
+}
+
+b32
+Platform_GetFileWriteTime(const char *FilePath, u64 *Out_WriteTime)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA Attributes;
+    if (!GetFileAttributesExA(FilePath, GetFileExInfoStandard, &Attributes))
+    {
+        return false;
+    }
+    *Out_WriteTime = ((u64) Attributes.ftLastWriteTime.dwHighDateTime << 32) | Attributes.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat FileStat;
+    if (stat(FilePath, &FileStat) != 0)
+    {
+        return false;
+    }
+    *Out_WriteTime = (u64) FileStat.st_mtim.tv_sec * 1000000000 + (u64) FileStat.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+
+//
+// NOTE: Frame timing, see opusone_frame_stats.h
+//
+u64
+Platform_GetPerformanceCounter()
+{
+    u64 Result = SDL_GetPerformanceCounter();
+    return Result;
+}
+
+internal frame_stats *
+CreateFrameStats()
+{
+    frame_stats *FrameStats = (frame_stats *) calloc(1, sizeof(frame_stats));
+    Assert(FrameStats);
+    FrameStats->CounterFrequency = SDL_GetPerformanceFrequency();
+    return FrameStats;
+}
+
+// NOTE: Oldest frame first, one row per frame still in the ring
+internal b32
+WriteFrameStatsCSV(const char *FilePath, frame_stats *FrameStats)
+{
+    FILE *File = OpenFile_(FilePath, "w");
+    if (!File)
+    {
+        return false;
+    }
+
+    fprintf(File, "Frame,WaitMs,UpdateMs,RenderMs,SwapMs,TotalMs\n");
+
+    u32 SampleCount = FrameStats_GetSampleCount(FrameStats);
+    for (u32 Age = SampleCount;
+         Age > 0;
+         --Age)
+    {
+        frame_timing *Timing = FrameStats_GetFrame(FrameStats, Age - 1);
+        fprintf(File, "%llu,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                (unsigned long long) (FrameStats->FrameCount - Age),
+                Timing->StageMs[FrameStage_Wait], Timing->StageMs[FrameStage_Update],
+                Timing->StageMs[FrameStage_Render], Timing->StageMs[FrameStage_Swap],
+                Timing->TotalMs);
+    }
+
+    b32 Result = (ferror(File) == 0);
+    fclose(File);
+
+    return Result;
+}
+
+internal void
+InitMediaLibraries()
+{
+    i32 SDLImageFlags = IMG_INIT_JPG | IMG_INIT_PNG;
+    b32 IMGInitResult = IMG_Init(SDLImageFlags);
+    Assert(IMGInitResult & SDLImageFlags);
+
+    i32 TTFInitResult = TTF_Init();
+    Assert(TTFInitResult != -1);
+}
+
+// NOTE: Only address space is reserved here, the game commits pages as its arenas grow.
+// Also starts the job system, one worker per core with the calling (main) thread as worker 0, and sets up
+// the frame stats.
+internal game_memory
+CreateGameMemory()
+{
+    game_memory GameMemory = {};
+    GameMemory.StorageSize = Gigabytes(4);
+    GameMemory.Storage = ReserveMemory(GameMemory.StorageSize);
+    Assert(GameMemory.Storage);
+
+    GlobalStorageCommitMap.Base = (u8 *) GameMemory.Storage;
+    GlobalStorageCommitMap.Size = GameMemory.StorageSize;
+    GlobalStorageCommitMap.PageSize = GetPageSize();
+    size_t PageCount = GameMemory.StorageSize / GlobalStorageCommitMap.PageSize;
+    GlobalStorageCommitMap.PageBits = (u64 *) calloc((PageCount + 63) / 64, sizeof(u64));
+    Assert(GlobalStorageCommitMap.PageBits);
+    printf("PLATFORM: Reserved %u MB of game memory%s\n", (u32) (GameMemory.StorageSize / Megabytes(1)),
+           GlobalUseHugePages ? " (huge pages advised)" : "");
+
+    i32 CPUCount = SDL_GetCPUCount();
+    GameMemory.JobSystem = JobSystem_Create((u32) Max(CPUCount, 1));
+    GameMemory.AddJob = JobSystem_AddJob;
+    GameMemory.WaitForJobGroup = JobSystem_WaitForJobGroup;
+    GameMemory.WorkerCount = GameMemory.JobSystem->WorkerCount;
+    printf("PLATFORM: Job system started with %u workers\n", GameMemory.WorkerCount);
+
+    GameMemory.FrameStats = CreateFrameStats();
+    GameMemory.ModuleReloaded = true;
+
+    return GameMemory;
+}
+
+#endif
@@ -0,0 +1,500 @@
+#ifndef OPUSONE_PLATFORM_SNAPSHOT_CPP
+#define OPUSONE_PLATFORM_SNAPSHOT_CPP
+
+// NOTE: Incremental snapshots of game_memory::Storage. Only committed pages are looked at (see commit_map), and
+// every page is hashed, in parallel on the job system. A page whose hash matches the parent snapshot's is shared
+// with it instead of copied, so after the first snapshot only pages the game actually wrote cost anything.
+// Changed pages are copied in runs of up to SNAPSHOT_BLOCK_PAGES (in parallel, the game has to be stopped for
+// that part) and then compressed with opusone_lz.h in the background; blocks are refcounted by the pages
+// pointing into them. Restoring hashes the live pages too and only decompresses blocks whose pages differ.
+//
+// Like the replay snapshots this only covers Storage, so it's for quicksaves, rewinding and bench loops within
+// one run. Snapshots are taken and restored between frames, on the main thread.
+// Only included by opusone_platform_services.cpp.
+
+#include <cstdlib>
+#include <cstring>
+
+#include "opusone_common.h"
+#include "opusone_platform.h"
+#include "opusone_lz.h"
+
+#define SNAPSHOT_BLOCK_PAGES 16
+#define SNAPSHOT_HASH_JOB_PAGES 512
+#define SNAPSHOT_COPY_JOB_BLOCKS 32
+
+struct snapshot_block
+{
+    i32 RefCount;   // NOTE: Pages, in any snapshot, that point into this block. Main thread only.
+    u32 PageCount;
+
+    // NOTE: Raw copy of the pages until the compression job swaps in the compressed data, if that came out smaller
+    u8 *Data;
+    u32 DataSize;
+    b32 IsCompressed;
+
+    u32 FirstPageIndex; // NOTE: Where the pages came from, only used while copying
+};
+
+struct snapshot_page
+{
+    u32 PageIndex; // NOTE: Page of Storage
+    u32 PageInBlock;
+    u64 Hash;
+    snapshot_block *Block;
+};
+
+struct platform_snapshot
+{
+    b32 IsValid;
+    u32 PageCount;
+    snapshot_page *Pages; // NOTE: Sorted by PageIndex
+
+    u32 NewBlockCount;    // NOTE: Blocks and pages this snapshot had to copy, the rest were shared
+    u32 NewPageCount;
+    u64 FrameIndex;       // NOTE: Whatever the caller wants to remember it by
+};
+
+// NOTE: Compression of every snapshot goes into this one group, a snapshot can share blocks that an older
+// snapshot's jobs are still compressing
+global_variable platform_job_group GlobalSnapshotCompressGroup;
+
+internal u64
+Snapshot_HashPage(u8 *Page, size_t PageSize)
+{
+    // NOTE: Four independent multiply-xor lanes so it runs at memory speed. Not a cryptographic hash; a
+    // collision would leave one stale page behind.
+    u64 Prime = 0x9E3779B97F4A7C15ULL;
+    u64 Lanes[4] = { 0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL, 0x082EFA98EC4E6C89ULL };
+    for (size_t Offset = 0;
+         Offset < PageSize;
+         Offset += 4 * sizeof(u64))
+    {
+        u64 Words[4];
+        memcpy(Words, Page + Offset, sizeof(Words));
+        Lanes[0] = (Lanes[0] ^ Words[0]) * Prime;
+        Lanes[1] = (Lanes[1] ^ Words[1]) * Prime;
+        Lanes[2] = (Lanes[2] ^ Words[2]) * Prime;
+        Lanes[3] = (Lanes[3] ^ Words[3]) * Prime;
+    }
+
+    u64 Result = 0;
+    for (u32 LaneIndex = 0;
+         LaneIndex < 4;
+         ++LaneIndex)
+    {
+        Result = (Result ^ (Lanes[LaneIndex] ^ (Lanes[LaneIndex] >> 29))) * Prime;
+    }
+    return Result ^ (Result >> 32);
+}
+
+struct snapshot_hash_job
+{
+    snapshot_page *Pages;
+    u32 PageCount;
+    u64 *Out_Hashes; // NOTE: Hashes of the live pages, one per page
+};
+
+internal void
+Snapshot_HashJob(void *Data, memory_arena *ScratchArena)
+{
+    snapshot_hash_job *Job = (snapshot_hash_job *) Data;
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+
+    for (u32 PageIndex = 0;
+         PageIndex < Job->PageCount;
+         ++PageIndex)
+    {
+        u8 *Page = CommitMap->Base + (size_t) Job->Pages[PageIndex].PageIndex * CommitMap->PageSize;
+        Job->Out_Hashes[PageIndex] = Snapshot_HashPage(Page, CommitMap->PageSize);
+    }
+}
+
+// NOTE: Hashes the live Storage pages of Pages in parallel
+internal void
+Snapshot_HashLivePages_(platform_job_system *JobSystem, snapshot_page *Pages, u32 PageCount, u64 *Out_Hashes)
+{
+    u32 JobCount = (PageCount + SNAPSHOT_HASH_JOB_PAGES - 1) / SNAPSHOT_HASH_JOB_PAGES;
+    snapshot_hash_job *Jobs = (snapshot_hash_job *) malloc(Max(JobCount, 1u) * sizeof(snapshot_hash_job));
+    Assert(Jobs);
+
+    platform_job_group HashGroup = {};
+    for (u32 JobIndex = 0;
+         JobIndex < JobCount;
+         ++JobIndex)
+    {
+        u32 FirstPage = JobIndex * SNAPSHOT_HASH_JOB_PAGES;
+        snapshot_hash_job *Job = Jobs + JobIndex;
+        Job->Pages = Pages + FirstPage;
+        Job->PageCount = Min(PageCount - FirstPage, (u32) SNAPSHOT_HASH_JOB_PAGES);
+        Job->Out_Hashes = Out_Hashes + FirstPage;
+        JobSystem_AddJob(JobSystem, &HashGroup, Snapshot_HashJob, Job);
+    }
+    JobSystem_WaitForJobGroup(JobSystem, &HashGroup);
+
+    free(Jobs);
+}
+
+struct snapshot_copy_job
+{
+    snapshot_block **Blocks;
+    u32 BlockCount;
+};
+
+internal void
+Snapshot_CopyJob(void *Data, memory_arena *ScratchArena)
+{
+    snapshot_copy_job *Job = (snapshot_copy_job *) Data;
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+
+    for (u32 BlockIndex = 0;
+         BlockIndex < Job->BlockCount;
+         ++BlockIndex)
+    {
+        snapshot_block *Block = Job->Blocks[BlockIndex];
+        memcpy(Block->Data, CommitMap->Base + (size_t) Block->FirstPageIndex * CommitMap->PageSize, Block->DataSize);
+    }
+}
+
+internal void
+Snapshot_CompressJob(void *Data, memory_arena *ScratchArena)
+{
+    snapshot_block *Block = (snapshot_block *) Data;
+
+    u8 *Compressed = MemoryArena_PushBytes(ScratchArena, LZ_GetMaxCompressedSize(Block->DataSize));
+    size_t CompressedSize = LZ_Compress(Block->Data, Block->DataSize, Compressed);
+
+    if (CompressedSize < Block->DataSize)
+    {
+        u8 *CompressedData = (u8 *) malloc(CompressedSize);
+        Assert(CompressedData);
+        memcpy(CompressedData, Compressed, CompressedSize);
+
+        free(Block->Data);
+        Block->Data = CompressedData;
+        Block->DataSize = (u32) CompressedSize;
+        Block->IsCompressed = true;
+    }
+}
+
+internal void
+Snapshot_WaitForCompression(platform_job_system *JobSystem)
+{
+    JobSystem_WaitForJobGroup(JobSystem, &GlobalSnapshotCompressGroup);
+}
+
+// NOTE: Drops the snapshot's references, blocks nothing else uses any more are freed
+internal void
+Snapshot_Release(platform_job_system *JobSystem, platform_snapshot *Snapshot)
+{
+    if (!Snapshot->IsValid)
+    {
+        return;
+    }
+
+    // NOTE: Can't free a block out from under its compression job
+    Snapshot_WaitForCompression(JobSystem);
+
+    for (u32 PageIndex = 0;
+         PageIndex < Snapshot->PageCount;
+         ++PageIndex)
+    {
+        snapshot_block *Block = Snapshot->Pages[PageIndex].Block;
+        Assert(Block->RefCount > 0);
+        if (--Block->RefCount == 0)
+        {
+            free(Block->Data);
+            free(Block);
+        }
+    }
+
+    free(Snapshot->Pages);
+    *Snapshot = {};
+}
+
+// NOTE: Parent is usually the previous snapshot and can be 0. Out_Snapshot mustn't hold a snapshot already.
+// Returns as soon as the changed pages are copied, compression carries on in the background.
+internal void
+Snapshot_Take(platform_job_system *JobSystem, platform_snapshot *Out_Snapshot, platform_snapshot *Parent)
+{
+    Assert(!Out_Snapshot->IsValid);
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+    Assert(CommitMap->PageBits);
+
+    platform_snapshot Snapshot = {};
+    Snapshot.IsValid = true;
+
+    // NOTE: Committed pages, in order
+    size_t At = 0;
+    size_t Offset;
+    size_t Size;
+    while (CommitMap_GetNextRange(CommitMap, &At, &Offset, &Size))
+    {
+        Snapshot.PageCount += (u32) (Size / CommitMap->PageSize);
+    }
+
+    Snapshot.Pages = (snapshot_page *) calloc(Max(Snapshot.PageCount, 1u), sizeof(snapshot_page));
+    Assert(Snapshot.Pages);
+
+    u32 PageCursor = 0;
+    At = 0;
+    while (CommitMap_GetNextRange(CommitMap, &At, &Offset, &Size))
+    {
+        for (size_t PageOffset = 0;
+             PageOffset < Size;
+             PageOffset += CommitMap->PageSize)
+        {
+            Snapshot.Pages[PageCursor++].PageIndex = (u32) ((Offset + PageOffset) / CommitMap->PageSize);
+        }
+    }
+    Assert(PageCursor == Snapshot.PageCount);
+
+    u64 *Hashes = (u64 *) malloc(Max(Snapshot.PageCount, 1u) * sizeof(u64));
+    Assert(Hashes);
+    Snapshot_HashLivePages_(JobSystem, Snapshot.Pages, Snapshot.PageCount, Hashes);
+
+    // NOTE: Share unchanged pages with the parent, both page lists are sorted
+    snapshot_block **NewBlocks = (snapshot_block **) malloc(Max(Snapshot.PageCount, 1u) * sizeof(snapshot_block *));
+    Assert(NewBlocks);
+    u32 ParentCursor = 0;
+    snapshot_block *OpenBlock = 0;
+
+    for (u32 PageIndex = 0;
+         PageIndex < Snapshot.PageCount;
+         ++PageIndex)
+    {
+        snapshot_page *Page = Snapshot.Pages + PageIndex;
+        Page->Hash = Hashes[PageIndex];
+
+        if (Parent && Parent->IsValid)
+        {
+            while (ParentCursor < Parent->PageCount && Parent->Pages[ParentCursor].PageIndex < Page->PageIndex)
+            {
+                ParentCursor++;
+            }
+            if (ParentCursor < Parent->PageCount)
+            {
+                snapshot_page *ParentPage = Parent->Pages + ParentCursor;
+                if (ParentPage->PageIndex == Page->PageIndex && ParentPage->Hash == Page->Hash)
+                {
+                    Page->Block = ParentPage->Block;
+                    Page->PageInBlock = ParentPage->PageInBlock;
+                    Page->Block->RefCount++;
+                    OpenBlock = 0;
+                    continue;
+                }
+            }
+        }
+
+        // NOTE: Changed page, goes into the open block if it directly follows its last page
+        if (!OpenBlock || OpenBlock->PageCount == SNAPSHOT_BLOCK_PAGES ||
+            (OpenBlock->FirstPageIndex + OpenBlock->PageCount) != Page->PageIndex)
+        {
+            OpenBlock = (snapshot_block *) calloc(1, sizeof(snapshot_block));
+            Assert(OpenBlock);
+            OpenBlock->FirstPageIndex = Page->PageIndex;
+            NewBlocks[Snapshot.NewBlockCount++] = OpenBlock;
+        }
+
+        Page->Block = OpenBlock;
+        Page->PageInBlock = OpenBlock->PageCount++;
+        Snapshot.NewPageCount++;
+        OpenBlock->RefCount++;
+    }
+
+    free(Hashes);
+
+    // NOTE: Copy the changed pages in parallel while the game is stopped...
+    for (u32 BlockIndex = 0;
+         BlockIndex < Snapshot.NewBlockCount;
+         ++BlockIndex)
+    {
+        snapshot_block *Block = NewBlocks[BlockIndex];
+        Block->DataSize = (u32) (Block->PageCount * CommitMap->PageSize);
+        Block->Data = (u8 *) malloc(Block->DataSize);
+        Assert(Block->Data);
+    }
+
+    u32 CopyJobCount = (Snapshot.NewBlockCount + SNAPSHOT_COPY_JOB_BLOCKS - 1) / SNAPSHOT_COPY_JOB_BLOCKS;
+    snapshot_copy_job *CopyJobs = (snapshot_copy_job *) malloc(Max(CopyJobCount, 1u) * sizeof(snapshot_copy_job));
+    Assert(CopyJobs);
+
+    platform_job_group CopyGroup = {};
+    for (u32 JobIndex = 0;
+         JobIndex < CopyJobCount;
+         ++JobIndex)
+    {
+        u32 FirstBlock = JobIndex * SNAPSHOT_COPY_JOB_BLOCKS;
+        CopyJobs[JobIndex].Blocks = NewBlocks + FirstBlock;
+        CopyJobs[JobIndex].BlockCount = Min(Snapshot.NewBlockCount - FirstBlock, (u32) SNAPSHOT_COPY_JOB_BLOCKS);
+        JobSystem_AddJob(JobSystem, &CopyGroup, Snapshot_CopyJob, CopyJobs + JobIndex);
+    }
+    JobSystem_WaitForJobGroup(JobSystem, &CopyGroup);
+    free(CopyJobs);
+
+    // NOTE: ...and compress them after the game moved on
+    for (u32 BlockIndex = 0;
+         BlockIndex < Snapshot.NewBlockCount;
+         ++BlockIndex)
+    {
+        JobSystem_AddJob(JobSystem, &GlobalSnapshotCompressGroup, Snapshot_CompressJob, NewBlocks[BlockIndex]);
+    }
+
+    free(NewBlocks);
+
+    *Out_Snapshot = Snapshot;
+}
+
+struct snapshot_restore_job
+{
+    snapshot_page *Pages; // NOTE: Consecutive pages of one block
+    u32 PageCount;
+    u64 *LiveHashes;
+};
+
+internal void
+Snapshot_RestoreJob(void *Data, memory_arena *ScratchArena)
+{
+    snapshot_restore_job *Job = (snapshot_restore_job *) Data;
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+    snapshot_block *Block = Job->Pages[0].Block;
+
+    u8 *Decompressed = 0;
+    for (u32 PageIndex = 0;
+         PageIndex < Job->PageCount;
+         ++PageIndex)
+    {
+        snapshot_page *Page = Job->Pages + PageIndex;
+        if (Job->LiveHashes[PageIndex] == Page->Hash)
+        {
+            continue;
+        }
+
+        u8 *Source;
+        if (Block->IsCompressed)
+        {
+            if (!Decompressed)
+            {
+                size_t DecompressedSize = Block->PageCount * CommitMap->PageSize;
+                Decompressed = MemoryArena_PushBytes(ScratchArena, DecompressedSize);
+                b32 Decoded = LZ_Decompress(Block->Data, Block->DataSize, Decompressed, DecompressedSize);
+                Assert(Decoded);
+            }
+            Source = Decompressed;
+        }
+        else
+        {
+            Source = Block->Data;
+        }
+
+        memcpy(CommitMap->Base + (size_t) Page->PageIndex * CommitMap->PageSize,
+               Source + (size_t) Page->PageInBlock * CommitMap->PageSize, CommitMap->PageSize);
+    }
+}
+
+// NOTE: Puts Storage back the way it was. Pages committed since are zeroed, like they were back then.
+//
+// Only Storage goes back, not the GL objects the game keeps IDs of there. Restoring across a texture being
+// acquired or released leaves the asset registry and the upload queue disagreeing with the driver: textures
+// created since leak, ones deleted since are sampled as whatever reuses the name, and pending uploads run again.
+// Fine for stepping back through gameplay, don't restore across asset loads.
+internal void
+Snapshot_Restore(platform_job_system *JobSystem, platform_snapshot *Snapshot)
+{
+    Assert(Snapshot->IsValid);
+    commit_map *CommitMap = &GlobalStorageCommitMap;
+
+    Snapshot_WaitForCompression(JobSystem);
+
+    // NOTE: Both lists are sorted, zero what's committed now but not in the snapshot
+    u32 PageCursor = 0;
+    size_t At = 0;
+    size_t Offset;
+    size_t Size;
+    while (CommitMap_GetNextRange(CommitMap, &At, &Offset, &Size))
+    {
+        for (size_t PageOffset = 0;
+             PageOffset < Size;
+             PageOffset += CommitMap->PageSize)
+        {
+            u32 LivePageIndex = (u32) ((Offset + PageOffset) / CommitMap->PageSize);
+            while (PageCursor < Snapshot->PageCount && Snapshot->Pages[PageCursor].PageIndex < LivePageIndex)
+            {
+                PageCursor++;
+            }
+            if (PageCursor >= Snapshot->PageCount || Snapshot->Pages[PageCursor].PageIndex != LivePageIndex)
+            {
+                memset(CommitMap->Base + (size_t) LivePageIndex * CommitMap->PageSize, 0, CommitMap->PageSize);
+            }
+        }
+    }
+
+    for (u32 PageIndex = 0;
+         PageIndex < Snapshot->PageCount;
+         ++PageIndex)
+    {
+        Platform_CommitMemory(CommitMap->Base + (size_t) Snapshot->Pages[PageIndex].PageIndex * CommitMap->PageSize,
+                              CommitMap->PageSize);
+    }
+
+    u64 *LiveHashes = (u64 *) malloc(Max(Snapshot->PageCount, 1u) * sizeof(u64));
+    Assert(LiveHashes);
+    Snapshot_HashLivePages_(JobSystem, Snapshot->Pages, Snapshot->PageCount, LiveHashes);
+
+    // NOTE: One job per run of pages from the same block, so each block is decompressed at most once per job
+    snapshot_restore_job *Jobs = (snapshot_restore_job *) malloc(Max(Snapshot->PageCount, 1u) * sizeof(snapshot_restore_job));
+    Assert(Jobs);
+    u32 JobCount = 0;
+
+    platform_job_group RestoreGroup = {};
+    for (u32 PageIndex = 0;
+         PageIndex < Snapshot->PageCount;)
+    {
+        u32 FirstPage = PageIndex;
+        b32 AnyChanged = false;
+        do
+        {
+            AnyChanged |= (LiveHashes[PageIndex] != Snapshot->Pages[PageIndex].Hash);
+            PageIndex++;
+        } while (PageIndex < Snapshot->PageCount && Snapshot->Pages[PageIndex].Block == Snapshot->Pages[FirstPage].Block);
+
+        if (AnyChanged)
+        {
+            snapshot_restore_job *Job = Jobs + JobCount++;
+            Job->Pages = Snapshot->Pages + FirstPage;
+            Job->PageCount = PageIndex - FirstPage;
+            Job->LiveHashes = LiveHashes + FirstPage;
+            JobSystem_AddJob(JobSystem, &RestoreGroup, Snapshot_RestoreJob, Job);
+        }
+    }
+    JobSystem_WaitForJobGroup(JobSystem, &RestoreGroup);
+
+    free(Jobs);
+    free(LiveHashes);
+}
+
+// NOTE: Bytes the snapshot's blocks take up, shared blocks counted in full
+internal u64
+Snapshot_GetBlockBytes(platform_snapshot *Snapshot, u32 *Out_BlockCount)
+{
+    u64 Result = 0;
+    u32 BlockCount = 0;
+    snapshot_block *LastBlock = 0;
+    for (u32 PageIndex = 0;
+         PageIndex < Snapshot->PageCount;
+         ++PageIndex)
+    {
+        snapshot_block *Block = Snapshot->Pages[PageIndex].Block;
+        if (Block != LastBlock)
+        {
+            // NOTE: Blocks are page runs, so apart from shared blocks that got split up this counts each once
+            Result += Block->DataSize;
+            BlockCount++;
+            LastBlock = Block;
+        }
+    }
+    *Out_BlockCount = BlockCount;
+    return Result;
+}
+
+#endif
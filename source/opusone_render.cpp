@@ -4,12 +4,16 @@ internal u32
 CompileShaderFromPath_(const char *Path, u32 ShaderType)
 {
     printf("Compiling shader at %s: ", Path);
-    char *Source = Platform_ReadFile(Path);
+    // NOTE: Mapped sources aren't null terminated, GL gets the length instead
+    platform_mapped_file SourceFile = Platform_MapFile(Path, MapHint_Sequential);
+    // TODO: Handle errors opening files properly
+    Assert(SourceFile.Data);
+    const char *Source = (const char *) SourceFile.Data;
+    i32 SourceLength = (i32) SourceFile.Size;
     u32 Shader = glCreateShader(ShaderType);
-    glShaderSource(Shader, 1, &Source, 0);
+    glShaderSource(Shader, 1, &Source, &SourceLength);
     glCompileShader(Shader);
-    Platform_Free(Source);
-    Source = 0;
+    Platform_UnmapFile(&SourceFile);
 
     i32 Success = 0;
     glGetShaderiv(Shader, GL_COMPILE_STATUS, &Success);
@@ -176,6 +180,19 @@ OpenGL_SetUniformMat4F(u32 ShaderID, const char *UniformName, f32 *Value, b32 Us
     return true;
 }
 
+// NOTE: Location based setters for the per-frame path, the program has to be in use already
+inline void
+OpenGL_SetUniformVec3FAt(i32 UniformLocation, f32 *Value)
+{
+    glUniform3fv(UniformLocation, 1, Value);
+}
+
+inline void
+OpenGL_SetUniformMat4FAt(i32 UniformLocation, f32 *Values, u32 Count)
+{
+    glUniformMatrix4fv(UniformLocation, Count, false, Values);
+}
+
 void
 OpenGL_PrepareVertexDataHelper(u32 VertexCount, u32 IndexCount,
                                size_t *AttribStrides, u8 *AttribComponentCounts,
@@ -292,22 +309,14 @@ OpenGL_SubVertexDataHelper(u32 StartingVertex, u32 VertexCount, u32 MaxVertexCou
     }
 }
 
-u32
-OpenGL_LoadTexture(u8 *ImageData, u32 Width, u32 Height, u32 Pitch, u32 BytesPerPixel)
+internal u32
+OpenGL_CreateMaterialTexture_()
 {
-    // TODO: Handle different image data formats better
-    Assert(Width * BytesPerPixel == Pitch);
-    Assert(BytesPerPixel == 4 || BytesPerPixel == 3);
-    
     u32 TextureID;
 
     glGenTextures(1, &TextureID);
     Assert(TextureID);
     glBindTexture(GL_TEXTURE_2D, TextureID);
-    u32 InternalFormat = (BytesPerPixel == 4 ? GL_RGBA8 : GL_RGB8);
-    u32 Format = (BytesPerPixel == 4 ? GL_RGBA : GL_RGB);
-    glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, Width, Height, 0, Format, GL_UNSIGNED_BYTE, ImageData);
-    glGenerateMipmap(GL_TEXTURE_2D);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -317,6 +326,285 @@ OpenGL_LoadTexture(u8 *ImageData, u32 Width, u32 Height, u32 Pitch, u32 BytesPer
     return TextureID;
 }
 
+// NOTE: The core 3.3 headers don't have the S3TC and BPTC formats
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+internal GLenum
+OpenGL_CompressedInternalFormat_(texture_format Format)
+{
+    switch (Format)
+    {
+        case TEXTURE_FORMAT_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TEXTURE_FORMAT_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TEXTURE_FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+        case TEXTURE_FORMAT_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default: InvalidCodePath; return 0;
+    }
+}
+
+// NOTE: What goes into the unpack buffer, the blocks as they are or decoded to RGBA8. Out_MipOffsets get where
+// each level ended up in Dest.
+internal void
+TextureUpload_WriteMips_(texture_upload *Upload, u8 *Dest, size_t *Out_MipOffsets)
+{
+    if (!Upload->DecodeOnCPU)
+    {
+        MemoryCopy(Dest, Upload->Data, Upload->UploadSize);
+        MemoryCopyArray(Out_MipOffsets, Upload->MipOffsets, Upload->MipCount, size_t);
+        return;
+    }
+
+    size_t DestOffset = 0;
+    for (u32 MipIndex = 0;
+         MipIndex < Upload->MipCount;
+         ++MipIndex)
+    {
+        u32 MipWidth = TextureMipDimension(Upload->Width, MipIndex);
+        u32 MipHeight = TextureMipDimension(Upload->Height, MipIndex);
+        TextureBlocks_DecodeToRGBA8(Upload->Format, Upload->Data + Upload->MipOffsets[MipIndex],
+                                    MipWidth, MipHeight, Dest + DestOffset);
+        Out_MipOffsets[MipIndex] = DestOffset;
+        DestOffset += TextureFormat_MipSize(TEXTURE_FORMAT_RGBA8, MipWidth, MipHeight);
+    }
+    Assert(DestOffset == Upload->UploadSize);
+}
+
+// NOTE: Base is 0 when a GL_PIXEL_UNPACK_BUFFER is bound, the offsets are into that then
+internal void
+TextureUpload_SetImages_(texture_upload *Upload, u8 *Base, size_t *MipOffsets)
+{
+    glBindTexture(GL_TEXTURE_2D, Upload->TextureID);
+
+    for (u32 MipIndex = 0;
+         MipIndex < Upload->MipCount;
+         ++MipIndex)
+    {
+        u32 MipWidth = TextureMipDimension(Upload->Width, MipIndex);
+        u32 MipHeight = TextureMipDimension(Upload->Height, MipIndex);
+        void *Pixels = (void *) ((size_t) Base + MipOffsets[MipIndex]);
+
+        if (TextureFormat_IsCompressed(Upload->Format) && !Upload->DecodeOnCPU)
+        {
+            size_t MipSize = TextureFormat_MipSize(Upload->Format, MipWidth, MipHeight);
+            glCompressedTexImage2D(GL_TEXTURE_2D, MipIndex, OpenGL_CompressedInternalFormat_(Upload->Format),
+                                   MipWidth, MipHeight, 0, (GLsizei) MipSize, Pixels);
+        }
+        else
+        {
+            // TODO: Handle different image data formats better
+            b32 IsRGB = (Upload->Format == TEXTURE_FORMAT_RGB8);
+            glTexImage2D(GL_TEXTURE_2D, MipIndex, IsRGB ? GL_RGB8 : GL_RGBA8, MipWidth, MipHeight, 0,
+                         IsRGB ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, Pixels);
+        }
+    }
+
+    if (Upload->GenerateMips)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Upload->MipCount - 1);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+u32
+OpenGL_LoadTexture(u8 *ImageData, u32 Width, u32 Height, u32 Pitch, u32 BytesPerPixel)
+{
+    Assert(Width * BytesPerPixel == Pitch);
+    Assert(BytesPerPixel == 4 || BytesPerPixel == 3);
+
+    texture_upload Upload = {};
+    Upload.TextureID = OpenGL_CreateMaterialTexture_();
+    Upload.Format = (BytesPerPixel == 4) ? TEXTURE_FORMAT_RGBA8 : TEXTURE_FORMAT_RGB8;
+    Upload.Width = Width;
+    Upload.Height = Height;
+    Upload.MipCount = 1;
+    Upload.GenerateMips = true;
+    TextureUpload_SetImages_(&Upload, ImageData, Upload.MipOffsets);
+
+    return Upload.TextureID;
+}
+
+void
+TextureUploadQueue_Initialize(texture_upload_queue *Queue, memory_arena *Arena)
+{
+    *Queue = {};
+    Queue->Arena = Arena;
+    Queue->Uploads = StretchyArray<texture_upload>(Arena, 64);
+    glGenBuffers(1, &Queue->PBO);
+
+    i32 MajorVersion = 0;
+    i32 MinorVersion = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &MajorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &MinorVersion);
+
+    // NOTE: RGTC is core since 3.0, BPTC since 4.2, S3TC is an extension everywhere (patents kept it out of core)
+    b32 *Supported = Queue->FormatIsSupported;
+    Supported[TEXTURE_FORMAT_RGB8] = true;
+    Supported[TEXTURE_FORMAT_RGBA8] = true;
+    Supported[TEXTURE_FORMAT_BC5] = true;
+    Supported[TEXTURE_FORMAT_BC7] = (MajorVersion > 4 || (MajorVersion == 4 && MinorVersion >= 2));
+
+    i32 ExtensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &ExtensionCount);
+    for (i32 ExtensionIndex = 0;
+         ExtensionIndex < ExtensionCount;
+         ++ExtensionIndex)
+    {
+        const char *Extension = (const char *) glGetStringi(GL_EXTENSIONS, ExtensionIndex);
+        if (CompareStrings(Extension, "GL_EXT_texture_compression_s3tc"))
+        {
+            Supported[TEXTURE_FORMAT_BC1] = true;
+            Supported[TEXTURE_FORMAT_BC3] = true;
+        }
+        else if (CompareStrings(Extension, "GL_ARB_texture_compression_bptc"))
+        {
+            Supported[TEXTURE_FORMAT_BC7] = true;
+        }
+    }
+
+    for (u32 Format = TEXTURE_FORMAT_NONE + 1;
+         Format < TEXTURE_FORMAT_COUNT;
+         ++Format)
+    {
+        if (!Supported[Format])
+        {
+            printf("RENDER: The driver can't sample %s, those textures are decoded on the CPU\n", TextureFormat_Name((texture_format) Format));
+        }
+    }
+}
+
+u32
+TextureUploadQueue_Push(texture_upload_queue *Queue, texture_data *Texture)
+{
+    Assert(Texture->MipCount > 0 && Texture->MipCount <= COOKED_TEXTURE_MAX_MIPS);
+
+    texture_upload Upload = {};
+    Upload.TextureID = OpenGL_CreateMaterialTexture_();
+    Upload.Format = Texture->Format;
+    Upload.Width = Texture->Width;
+    Upload.Height = Texture->Height;
+    Upload.MipCount = Texture->MipCount;
+    Upload.GenerateMips = Texture->GenerateMips;
+    Upload.DecodeOnCPU = !Queue->FormatIsSupported[Texture->Format];
+
+    size_t DataSize = 0;
+    size_t DecodedSize = 0;
+    for (u32 MipIndex = 0;
+         MipIndex < Texture->MipCount;
+         ++MipIndex)
+    {
+        Upload.MipOffsets[MipIndex] = DataSize;
+        DataSize += Texture->MipSizes[MipIndex];
+        DecodedSize += TextureFormat_MipSize(TEXTURE_FORMAT_RGBA8, TextureMipDimension(Texture->Width, MipIndex),
+                                             TextureMipDimension(Texture->Height, MipIndex));
+    }
+    Upload.UploadSize = Upload.DecodeOnCPU ? DecodedSize : DataSize;
+
+    // NOTE: Kept compressed until it's uploaded even when it's decoded on the CPU, it's 4-8x smaller
+    Upload.Data = MemoryArena_PushBytesAligned(Queue->Arena, DataSize, ARENA_ALIGN_AVX);
+    for (u32 MipIndex = 0;
+         MipIndex < Texture->MipCount;
+         ++MipIndex)
+    {
+        MemoryCopy(Upload.Data + Upload.MipOffsets[MipIndex], Texture->Mips[MipIndex], Texture->MipSizes[MipIndex]);
+    }
+
+    StretchyArray_Push(&Queue->Uploads, Upload);
+    return Upload.TextureID;
+}
+
+void
+TextureUploadQueue_Cancel(texture_upload_queue *Queue, u32 TextureID)
+{
+    Assert(TextureID);
+
+    for (u32 UploadIndex = Queue->NextUploadIndex;
+         UploadIndex < Queue->Uploads.Count;
+         ++UploadIndex)
+    {
+        texture_upload *Upload = Queue->Uploads.D + UploadIndex;
+        if (Upload->TextureID == TextureID)
+        {
+            Upload->TextureID = 0;
+            return;
+        }
+    }
+}
+
+u32
+TextureUploadQueue_Pump(texture_upload_queue *Queue, size_t ByteBudget)
+{
+    u32 UploadCount = 0;
+    size_t BytesUploaded = 0;
+
+    while (Queue->NextUploadIndex < Queue->Uploads.Count && (UploadCount == 0 || BytesUploaded < ByteBudget))
+    {
+        texture_upload *Upload = Queue->Uploads.D + Queue->NextUploadIndex++;
+        if (!Upload->TextureID)
+        {
+            // NOTE: Released before it got uploaded
+            continue;
+        }
+
+        size_t Size = Upload->UploadSize;
+        size_t MipOffsets[COOKED_TEXTURE_MAX_MIPS];
+
+        // NOTE: Reallocating the storage orphans the last upload's, so mapping never waits for that transfer to
+        // finish. glTexImage2D then returns right away and the GPU pulls the pixels when it gets to it.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, Queue->PBO);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, Size, 0, GL_STREAM_DRAW);
+        void *Mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, Size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+        b32 UsePBO = false;
+        if (Mapped)
+        {
+            TextureUpload_WriteMips_(Upload, (u8 *) Mapped, MipOffsets);
+            // NOTE: False if the mapping got lost (e.g. a mode switch), the buffer contents are undefined then
+            UsePBO = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        if (UsePBO)
+        {
+            TextureUpload_SetImages_(Upload, 0, MipOffsets);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        else
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            temporary_memory ClientMemory = MemoryArena_BeginTemp(Queue->Arena);
+            u8 *Client = MemoryArena_PushBytesAligned(Queue->Arena, Size, ARENA_ALIGN_AVX);
+            TextureUpload_WriteMips_(Upload, Client, MipOffsets);
+            TextureUpload_SetImages_(Upload, Client, MipOffsets);
+            MemoryArena_EndTemp(ClientMemory);
+        }
+
+        UploadCount++;
+        BytesUploaded += Size;
+    }
+
+    if (Queue->NextUploadIndex > 0 && Queue->NextUploadIndex == Queue->Uploads.Count)
+    {
+        MemoryArena_Reset(Queue->Arena);
+        Queue->Uploads = StretchyArray<texture_upload>(Queue->Arena, 64);
+        Queue->NextUploadIndex = 0;
+    }
+
+    return UploadCount;
+}
+
 u32
 OpenGL_LoadFontAtlasTexture(u8 *ImageData, u32 Width, u32 Height, u32 Pitch, u32 BytesPerPixel)
 {
@@ -667,6 +955,12 @@ InitializeRenderUnit(render_unit *RenderUnit, vert_spec_type VertSpecType,
     PrepareVertexDataForRenderUnit(RenderUnit);
 
     RenderUnit->ShaderID = ShaderID;
+
+    RenderUnit->Uniforms.Projection = glGetUniformLocation(ShaderID, "Projection");
+    RenderUnit->Uniforms.View = glGetUniformLocation(ShaderID, "View");
+    RenderUnit->Uniforms.Model = glGetUniformLocation(ShaderID, "Model");
+    RenderUnit->Uniforms.ViewPosition = glGetUniformLocation(ShaderID, "ViewPosition");
+    RenderUnit->Uniforms.BoneTransforms = glGetUniformLocation(ShaderID, "BoneTransforms[0]");
 }
 
 void
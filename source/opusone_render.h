@@ -2,6 +2,8 @@
 #define OPUSONE_RENDER_H
 
 #include "opusone_common.h"
+#include "opusone_containers.h"
+#include "opusone_cooked_texture.h"
 // TODO: Maybe wrap GLenum for data types and usage, so can delay including glad until the source file
 #include <glad/glad.h>
 
@@ -48,6 +50,7 @@ struct entity;
 struct render_state_mesh
 {
     u32 MaterialID;
+    u32 InstanceCount;
     entity *EntityInstances[MAX_INSTANCES_PER_MESH];
 };
 
@@ -80,9 +83,21 @@ struct render_marker
     render_state_type StateT;
 };
 
+// NOTE: Locations of the uniforms that are set every frame. Looked up once when the render unit is initialized,
+// so the render loop never goes through uniform names. -1 if the shader doesn't use it (GL ignores those).
+struct render_unit_uniforms
+{
+    i32 Projection;
+    i32 View;
+    i32 Model;
+    i32 ViewPosition;
+    i32 BoneTransforms;
+};
+
 struct render_unit
 {
     u32 ShaderID;
+    render_unit_uniforms Uniforms;
 
     u32 VAO;
     u32 VBO;
@@ -110,6 +125,40 @@ struct render_unit
     render_unit *Next;
 };
 
+// NOTE: Textures are decoded on the job system and uploaded a few per frame, through a pixel buffer object so
+// copying the pixels doesn't wait on the GPU. A queued texture gets its ID right away, it has no storage and
+// samples as black (like a material without that texture) until it's uploaded. Pending pixels are kept in an
+// arena in game memory, so snapshots taken while uploads are pending still restore fine.
+//
+// Cooked textures (opusone_cooked_texture.h) bring their mip chain and upload compressed, formats the driver can't
+// sample are decoded to RGBA8 on the way into the pixel buffer.
+#define TEXTURE_UPLOAD_BYTES_PER_FRAME Megabytes(8)
+
+struct texture_upload
+{
+    u32 TextureID; // NOTE: 0 once cancelled
+    texture_format Format;
+    u32 Width;
+    u32 Height;
+    u32 MipCount;
+    b32 GenerateMips;
+    b32 DecodeOnCPU;
+
+    u8 *Data; // NOTE: All levels back to back, in the queue's arena
+    size_t MipOffsets[COOKED_TEXTURE_MAX_MIPS];
+    size_t UploadSize; // NOTE: What goes through the pixel buffer, the decoded size when DecodeOnCPU
+};
+
+struct texture_upload_queue
+{
+    memory_arena *Arena; // NOTE: Reset whenever the queue runs empty
+    stretchy_array<texture_upload> Uploads;
+    u32 NextUploadIndex;
+
+    u32 PBO;
+    b32 FormatIsSupported[TEXTURE_FORMAT_COUNT];
+};
+
 u32
 OpenGL_BuildShaderProgram(const char *VertexPath, const char *FragmentPath);
 
@@ -131,6 +180,12 @@ OpenGL_SetUniformMat3F(u32 ShaderID, const char *UniformName, f32 *Value, b32 Us
 inline b32
 OpenGL_SetUniformMat4F(u32 ShaderID, const char *UniformName, f32 *Value, b32 UseProgram);
 
+inline void
+OpenGL_SetUniformVec3FAt(i32 UniformLocation, f32 *Value);
+
+inline void
+OpenGL_SetUniformMat4FAt(i32 UniformLocation, f32 *Values, u32 Count);
+
 void
 OpenGL_PrepareVertexDataHelper(u32 VertexCount, u32 IndexCount,
                                size_t *AttribStrides, u8 *AttribComponentCounts,
@@ -147,6 +202,29 @@ OpenGL_SubVertexDataHelper(u32 StartingVertex, u32 VertexCount, u32 MaxVertexCou
 u32
 OpenGL_LoadTexture(u8 *ImageData, u32 Width, u32 Height, u32 Pitch, u32 BytesPerPixel);
 
+void
+TextureUploadQueue_Initialize(texture_upload_queue *Queue, memory_arena *Arena);
+
+// NOTE: Copies the texture data, the image or cooked texture can be freed right away
+u32
+TextureUploadQueue_Push(texture_upload_queue *Queue, texture_data *Texture);
+
+// NOTE: Drops the pending upload for TextureID, if there is one. Has to be called before the texture is deleted,
+// GL hands a deleted name out again and the upload would land in whatever texture got it.
+void
+TextureUploadQueue_Cancel(texture_upload_queue *Queue, u32 TextureID);
+
+inline b32
+TextureUploadQueue_IsEmpty(texture_upload_queue *Queue)
+{
+    b32 Result = (Queue->NextUploadIndex == Queue->Uploads.Count);
+    return Result;
+}
+
+// NOTE: Uploads until ByteBudget is used up, and at least one texture so a big one can't block the queue
+u32
+TextureUploadQueue_Pump(texture_upload_queue *Queue, size_t ByteBudget);
+
 u32
 OpenGL_LoadFontAtlasTexture(u8 *ImageData, u32 Width, u32 Height, u32 Pitch, u32 BytesPerPixel);
 
@@ -0,0 +1,103 @@
+#ifndef OPUSONE_STRING_ID_H
+#define OPUSONE_STRING_ID_H
+
+#include "opusone_common.h"
+#include "opusone_containers.h"
+
+#include <SDL2/SDL_atomic.h>
+
+// NOTE: Interned strings. Each distinct string is hashed and copied once (at load time), after that it's passed
+// around and compared as a 32-bit ID. ID 0 is the empty string, so zero-initialized IDs mean "no string".
+// Startup jobs import models in parallel, so the table is behind a spin lock (lookups are short, it's uncontended
+// the rest of the time).
+typedef u32 string_id;
+
+struct string_table
+{
+    memory_arena *Arena;
+    hash_map<const char *, string_id> IDsByString;
+    stretchy_array<const char *> Strings;
+
+    SDL_SpinLock Lock;
+};
+
+// NOTE: Lives in game memory, the game sets this on init
+global_variable string_table *GlobalStringTable;
+
+inline string_table *
+StringTable(memory_arena *Arena, u32 ExpectedCount)
+{
+    string_table *Table = MemoryArena_PushStruct(Arena, string_table);
+    *Table = {};
+
+    Table->Arena = Arena;
+    Table->IDsByString = HashMap<const char *, string_id>(Arena, ExpectedCount);
+    Table->Strings = StretchyArray<const char *>(Arena, ExpectedCount);
+    StretchyArray_Push(&Table->Strings, "");
+
+    return Table;
+}
+
+inline string_id
+StringID_Find(const char *String)
+{
+    Assert(GlobalStringTable);
+
+    SDL_AtomicLock(&GlobalStringTable->Lock);
+    string_id *Found = HashMap_Find(&GlobalStringTable->IDsByString, String);
+    string_id Result = Found ? *Found : 0;
+    SDL_AtomicUnlock(&GlobalStringTable->Lock);
+    return Result;
+}
+
+inline string_id
+StringID(const char *String)
+{
+    Assert(GlobalStringTable);
+    string_table *Table = GlobalStringTable;
+
+    if (String[0] == '\0')
+    {
+        return 0;
+    }
+
+    SDL_AtomicLock(&Table->Lock);
+
+    string_id *Found = HashMap_Find(&Table->IDsByString, String);
+    if (Found)
+    {
+        string_id Result = *Found;
+        SDL_AtomicUnlock(&Table->Lock);
+        return Result;
+    }
+
+    u32 Length = 0;
+    while (String[Length] != '\0')
+    {
+        ++Length;
+    }
+
+    char *Copy = (char *) MemoryArena_PushBytes(Table->Arena, Length + 1);
+    MemoryCopy(Copy, String, Length + 1);
+
+    string_id Result = Table->Strings.Count;
+    StretchyArray_Push(&Table->Strings, (const char *) Copy);
+    HashMap_Set(&Table->IDsByString, (const char *) Copy, Result);
+
+    SDL_AtomicUnlock(&Table->Lock);
+    return Result;
+}
+
+inline const char *
+StringID_GetString(string_id ID)
+{
+    Assert(GlobalStringTable);
+    // NOTE: Locked as well, a push can move the array while another thread looks a string up
+    SDL_AtomicLock(&GlobalStringTable->Lock);
+    Assert(ID < GlobalStringTable->Strings.Count);
+    const char *Result = GlobalStringTable->Strings.D[ID];
+    SDL_AtomicUnlock(&GlobalStringTable->Lock);
+    return Result;
+}
+
+#endif
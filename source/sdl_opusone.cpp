@@ -2,19 +2,110 @@
 #include <cstdio>
 
 #include <glad/glad.h>
-#include <sdl2/SDL.h>
-#include <sdl2/SDL_image.h>
-#include <sdl2/SDL_ttf.h>
+#include <SDL2/SDL.h>
 
 #include "opusone_common.h"
 #include "opusone_platform.h"
+#include "opusone_platform_services.cpp"
+
+// NOTE: Frame pacing. Every frame drops a fence after its swap, and before starting frame N the CPU waits on
+// the fence of frame N - FramesInFlight. Latency mode keeps one frame in flight (input is sampled right after
+// the GPU caught up, like a glFinish but without stalling on the frame that was just submitted), throughput
+// mode lets the CPU run up to FRAME_PACING_MAX_IN_FLIGHT frames ahead of the GPU.
+#define FRAME_PACING_MAX_IN_FLIGHT 3
+
+enum frame_pacing_mode
+{
+    FramePacing_Latency,
+    FramePacing_Throughput,
+    FramePacing_Count
+};
+
+struct frame_pacing
+{
+    frame_pacing_mode Mode;
+    u64 FrameIndex;
+    GLsync Fences[FRAME_PACING_MAX_IN_FLIGHT];
+};
+
+internal void
+FramePacing_WaitForFrameSlot(frame_pacing *Pacing);
 
 internal void
-UpdateInput(game_input *GameInput);
+FramePacing_EndFrame(frame_pacing *Pacing);
+
+internal const char *
+FramePacing_GetModeName(frame_pacing_mode Mode);
+
+// NOTE: FrameTime, DeltaTime and input event times are all seconds on the performance counter since startup, so
+// the game's sim step windows line up with the event times
+struct input_clock
+{
+    u64 Frequency;
+    u64 StartCounter;
+    u32 StartTicks;
+};
+
+internal input_clock
+InputClock();
+
+internal f64
+InputClock_GetTime(input_clock *Clock, u64 Counter);
+
+internal f64
+GetInputEventTime(input_clock *Clock, game_input *GameInput, u32 Ticks);
+
+// NOTE: F9 starts/stops recording with a snapshot, F10 loops the recording (see opusone_platform_replay.cpp).
+// -record/-playback record from launch or play back from launch instead, playback quits once it runs out.
+#define LOOP_REPLAY_PATH "loop.replay"
+
+// NOTE: F8 quicksaves game_memory, Shift+F8 loads it back (see opusone_platform_snapshot.cpp). With -rewind a
+// snapshot is also taken every REWIND_INTERVAL_FRAMES frames, each PageDown steps back to the previous one.
+#define REWIND_SNAPSHOT_COUNT 32
+#define REWIND_INTERVAL_FRAMES 30
+
+// NOTE: OPUSONE_HOT_RELOAD builds load the game from this module next to the executable and reload it whenever
+// it's rebuilt (./build.sh game), see opusone_platform_module.cpp
+#define GAME_MODULE_NAME "opusone_game.so"
+
+internal void
+TakeTimedSnapshot(platform_job_system *JobSystem, platform_snapshot *Out_Snapshot, platform_snapshot *Parent,
+                  const char *What);
+
+internal void
+RestoreTimedSnapshot(platform_job_system *JobSystem, platform_snapshot *Snapshot, const char *What);
 
 int
 main(int Argc, char *Argv[])
 {
+    const char *RecordPath = 0;
+    const char *PlaybackPath = 0;
+    b32 RewindEnabled = false;
+    
+    for (i32 ArgIndex = 1;
+         ArgIndex < Argc;
+         ++ArgIndex)
+    {
+        b32 HasValue = (ArgIndex + 1) < Argc;
+        
+        if (CompareStrings(Argv[ArgIndex], "-hugepages"))
+        {
+            GlobalUseHugePages = true;
+        }
+        else if (CompareStrings(Argv[ArgIndex], "-record") && HasValue)
+        {
+            RecordPath = Argv[++ArgIndex];
+        }
+        else if (CompareStrings(Argv[ArgIndex], "-playback") && HasValue)
+        {
+            PlaybackPath = Argv[++ArgIndex];
+        }
+        else if (CompareStrings(Argv[ArgIndex], "-rewind"))
+        {
+            RewindEnabled = true;
+        }
+    }
+    
     i32 SDLInitResult = SDL_Init(SDL_INIT_VIDEO);
     Assert(SDLInitResult >= 0);
     SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
@@ -37,17 +128,26 @@ main(int Argc, char *Argv[])
     printf("PLATFORM: Renderer: %s\n", glGetString(GL_RENDERER));
     printf("PLATFORM: Version: %s\n", glGetString(GL_VERSION));
 
-    i32 SDLImageFlags = IMG_INIT_JPG | IMG_INIT_PNG;
-    b32 IMGInitResult = IMG_Init(SDLImageFlags);
-    Assert(IMGInitResult & SDLImageFlags);
+    InitMediaLibraries();
 
-    i32 TTFInitResult = TTF_Init();
-    Assert(TTFInitResult != -1);
+    game_memory GameMemory = CreateGameMemory();
+    GameMemory.GetGLProcAddress = SDL_GL_GetProcAddress;
 
-    game_memory GameMemory = {};
-    GameMemory.StorageSize = Megabytes(64);
-    GameMemory.Storage = calloc(1, GameMemory.StorageSize);
-    Assert(GameMemory.Storage);
+#if OPUSONE_HOT_RELOAD
+    char GameModulePath[512];
+    char *BasePath = SDL_GetBasePath();
+    FormatString(GameModulePath, sizeof(GameModulePath), "%s%s", BasePath ? BasePath : "", GAME_MODULE_NAME);
+    SDL_free(BasePath);
+
+    game_module GameModule;
+    if (!GameModule_Open(&GameModule, GameModulePath))
+    {
+        return 1;
+    }
+    game_update_and_render *UpdateAndRender = GameModule.UpdateAndRender;
+#else
+    game_update_and_render *UpdateAndRender = GameUpdateAndRender;
+#endif
 
     game_input *GameInput = (game_input *) calloc(1, sizeof(game_input));
     Assert(GameInput);
@@ -58,18 +158,14 @@ main(int Argc, char *Argv[])
     glViewport(0, 0, GameInput->ScreenWidth, GameInput->ScreenHeight);
     printf("PLATFORM: Original Screen Resolution: %d x %d\n", GameInput->OriginalScreenWidth, GameInput->OriginalScreenHeight);
 
-    f32 ExpectedRefreshRates[] = { 60.0f, 164.386f, 30.0f }; // Hardcode from my display settings for now
-    u32 ExpectedRefreshRateCount = ArrayCount(ExpectedRefreshRates);
-    
-    u32 CurrentExpectedRefreshRate = 1;
-    GameInput->DeltaTime = 1.0f / ExpectedRefreshRates[CurrentExpectedRefreshRate];
-    printf("PLATFORM: Expected refresh rate: %0.3f fps [DT=%0.6f]\n",
-           ExpectedRefreshRates[CurrentExpectedRefreshRate], GameInput->DeltaTime);
+    input_clock Clock = InputClock();
+    u64 PerfCounterFrequency = Clock.Frequency;
+    u64 LastCounter = Clock.StartCounter;
 
-    u64 PerfCounterFrequency = SDL_GetPerformanceFrequency();
-    u64 LastCounter = SDL_GetPerformanceCounter();
-    f64 PrevFrameDeltaTimeSec = 0.0f;
-    f64 FPS = 0.0f;
+    frame_stats *FrameStats = GameMemory.FrameStats;
+    // NOTE: Setting the title isn't free, it's only refreshed this often
+    u64 TitleUpdateInterval = PerfCounterFrequency / 2;
+    u64 LastTitleUpdateCounter = LastCounter;
 
 #if 0
     i32 OldSwapInterval = SDL_GL_GetSwapInterval();
@@ -79,10 +175,132 @@ main(int Argc, char *Argv[])
            OldSwapInterval, SetSwapResult, NewSwapInterval);
 #endif
 
+    frame_pacing FramePacing = {};
+    FramePacing.Mode = FramePacing_Latency;
+    printf("PLATFORM: Frame pacing: %s\n", FramePacing_GetModeName(FramePacing.Mode));
+
+    // NOTE: Played back input goes to its own game_input, the live one keeps tracking the real keyboard
+    replay_state Replay = {};
+    game_input *PlaybackInput = (game_input *) calloc(1, sizeof(game_input));
+    Assert(PlaybackInput);
+    b32 ToggleRecording = false;
+    b32 TogglePlayback = false;
+
+    platform_snapshot QuickSave = {};
+    platform_snapshot RewindSnapshots[REWIND_SNAPSHOT_COUNT] = {};
+    u32 RewindNewest = 0;
+    u32 RewindCount = 0;
+    u64 FrameIndex = 0;
+    b32 WillQuickSave = false;
+    b32 WillQuickLoad = false;
+    b32 WillRewind = false;
+
+    if (RecordPath)
+    {
+        Replay_BeginRecording(&Replay, RecordPath, GameInput, &GameMemory, false);
+    }
+    else if (PlaybackPath && !Replay_BeginPlayback(&Replay, PlaybackPath, PlaybackInput, &GameMemory))
+    {
+        return 1;
+    }
+
     b32 ShouldQuit = false;
     while (!ShouldQuit)
     {
-        glFinish(); // TODO: Still need more research and experimentation to decide if I want to do this
+        FrameStats_BeginFrame(FrameStats, SDL_GetPerformanceCounter());
+        
+        FramePacing_WaitForFrameSlot(&FramePacing);
+
+        FrameStats_Mark(FrameStats, FrameStage_Update, SDL_GetPerformanceCounter());
+
+        // NOTE: Replay hotkeys from the last frame take effect between frames
+        if (ToggleRecording)
+        {
+            ToggleRecording = false;
+            if (Replay.Mode == ReplayMode_Recording)
+            {
+                Replay_EndRecording(&Replay);
+            }
+            else if (Replay.Mode == ReplayMode_None)
+            {
+                Replay_BeginRecording(&Replay, LOOP_REPLAY_PATH, GameInput, &GameMemory, true);
+            }
+        }
+        if (TogglePlayback)
+        {
+            TogglePlayback = false;
+            if (Replay.Mode == ReplayMode_Playback)
+            {
+                Replay_EndPlayback(&Replay);
+            }
+            else
+            {
+                if (Replay.Mode == ReplayMode_Recording)
+                {
+                    Replay_EndRecording(&Replay);
+                }
+                Replay_BeginPlayback(&Replay, LOOP_REPLAY_PATH, PlaybackInput, &GameMemory);
+            }
+        }
+
+        // NOTE: Same for snapshots. Restoring in the middle of a replay would throw it off, so that's refused.
+        if (WillQuickSave)
+        {
+            WillQuickSave = false;
+            platform_snapshot *Parent = RewindCount ? (RewindSnapshots + RewindNewest) : 0;
+            Snapshot_Release(GameMemory.JobSystem, &QuickSave);
+            TakeTimedSnapshot(GameMemory.JobSystem, &QuickSave, Parent, "Quicksave");
+        }
+        if ((WillQuickLoad || WillRewind) && Replay.Mode != ReplayMode_None)
+        {
+            printf("PLATFORM: Can't restore a snapshot while recording or playing back\n");
+        }
+        else if (WillQuickLoad)
+        {
+            if (QuickSave.IsValid)
+            {
+                RestoreTimedSnapshot(GameMemory.JobSystem, &QuickSave, "Quickload");
+            }
+        }
+        else if (WillRewind)
+        {
+            if (RewindCount)
+            {
+                RestoreTimedSnapshot(GameMemory.JobSystem, RewindSnapshots + RewindNewest, "Rewind");
+                Snapshot_Release(GameMemory.JobSystem, RewindSnapshots + RewindNewest);
+                RewindNewest = (RewindNewest + REWIND_SNAPSHOT_COUNT - 1) % REWIND_SNAPSHOT_COUNT;
+                RewindCount--;
+            }
+        }
+        // NOTE: Frame 0 hasn't run the game yet, a snapshot of it would be Storage before init and rewinding to it
+        // would run the whole init again on top of the live GL objects
+        else if (RewindEnabled && Replay.Mode == ReplayMode_None && FrameIndex > 0 && (FrameIndex % REWIND_INTERVAL_FRAMES) == 0)
+        {
+            platform_snapshot *Parent = RewindCount ? (RewindSnapshots + RewindNewest) : 0;
+            RewindNewest = (RewindNewest + 1) % REWIND_SNAPSHOT_COUNT;
+            if (RewindCount == REWIND_SNAPSHOT_COUNT)
+            {
+                Snapshot_Release(GameMemory.JobSystem, RewindSnapshots + RewindNewest);
+            }
+            else
+            {
+                RewindCount++;
+            }
+            Snapshot_Take(GameMemory.JobSystem, RewindSnapshots + RewindNewest, Parent);
+        }
+        WillQuickLoad = false;
+        WillRewind = false;
+        FrameIndex++;
+
+#if OPUSONE_HOT_RELOAD
+        if (GameModule_ReloadIfChanged(&GameModule))
+        {
+            UpdateAndRender = GameModule.UpdateAndRender;
+            GameMemory.ModuleReloaded = true;
+        }
+#endif
+
+        BeginInputFrame(GameInput);
         
         SDL_Event SDLEvent;
         while (SDL_PollEvent(&SDLEvent))
@@ -103,199 +321,260 @@ main(int Argc, char *Argv[])
                         printf("PLATFORM: Window resized. New resolution: %d x %d\n", GameInput->ScreenWidth, GameInput->ScreenHeight);
                     }
                 } break;
+                case SDL_KEYDOWN:
+                case SDL_KEYUP:
+                {
+                    if (SDLEvent.key.keysym.scancode < SDL_NUM_SCANCODES)
+                    {
+                        PushKeyEvent(GameInput, SDLEvent.key.keysym.scancode, (SDLEvent.type == SDL_KEYDOWN),
+                                     GetInputEventTime(&Clock, GameInput, SDLEvent.common.timestamp));
+                    }
+                } break;
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP:
+                {
+                    // NOTE: SDL_BUTTON_LEFT/MIDDLE/RIGHT are 1/2/3
+                    u32 MouseButtonIndex = (u32) SDLEvent.button.button - 1;
+                    if (MouseButtonIndex < MouseButton_Count)
+                    {
+                        PushMouseButtonEvent(GameInput, (mouse_button_type) MouseButtonIndex, (SDLEvent.type == SDL_MOUSEBUTTONDOWN),
+                                             GetInputEventTime(&Clock, GameInput, SDLEvent.common.timestamp));
+                    }
+                } break;
+                case SDL_MOUSEMOTION:
+                {
+                    PushMouseMotion(GameInput, SDLEvent.motion.x, SDLEvent.motion.y, SDLEvent.motion.xrel, SDLEvent.motion.yrel);
+                } break;
             }
         }
 
-        UpdateInput(GameInput);
+        // NOTE: Time since the previous frame started. The game steps its simulation at a fixed rate and
+        // catches up on this, so it doesn't need to match the refresh rate. Both come from the same counter
+        // sample, so the previous FrameTime plus DeltaTime is exactly this FrameTime.
+        u64 CurrentCounter = SDL_GetPerformanceCounter();
+        f64 PrevFrameTime = InputClock_GetTime(&Clock, LastCounter);
+        LastCounter = CurrentCounter;
+        GameInput->FrameTime = InputClock_GetTime(&Clock, CurrentCounter);
+        GameInput->DeltaTime = (f32) (GameInput->FrameTime - PrevFrameTime);
 
+        if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F8))
+        {
+            if (Platform_KeyIsDown(GameInput, SDL_SCANCODE_LSHIFT) || Platform_KeyIsDown(GameInput, SDL_SCANCODE_RSHIFT))
+            {
+                WillQuickLoad = true;
+            }
+            else
+            {
+                WillQuickSave = true;
+            }
+        }
+        if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_PAGEDOWN))
+        {
+            WillRewind = true;
+        }
+        if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F9))
+        {
+            ToggleRecording = true;
+        }
+        if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F10))
+        {
+            TogglePlayback = true;
+        }
         if (Platform_KeyJustPressed(GameInput, SDL_SCANCODE_F11))
         {
-            CurrentExpectedRefreshRate = (CurrentExpectedRefreshRate + 1) % ExpectedRefreshRateCount;
-            GameInput->DeltaTime = 1.0f / ExpectedRefreshRates[CurrentExpectedRefreshRate];
-            printf("PLATFORM: Expected refresh rate: %0.3f fps [DT=%0.6f]\n",
-                   ExpectedRefreshRates[CurrentExpectedRefreshRate], GameInput->DeltaTime);
+            FramePacing.Mode = (frame_pacing_mode) ((FramePacing.Mode + 1) % FramePacing_Count);
+            printf("PLATFORM: Frame pacing: %s\n", FramePacing_GetModeName(FramePacing.Mode));
+        }
+
+        game_input *FrameInput = GameInput;
+        if (Replay.Mode == ReplayMode_Recording)
+        {
+            Replay_RecordFrame(&Replay, GameInput);
+        }
+        else if (Replay.Mode == ReplayMode_Playback)
+        {
+            b32 HasFrame = (Replay_PlayFrame(&Replay, PlaybackInput) ||
+                            (Replay_LoopPlayback(&Replay, PlaybackInput, &GameMemory) &&
+                             Replay_PlayFrame(&Replay, PlaybackInput)));
+            if (HasFrame)
+            {
+                FrameInput = PlaybackInput;
+            }
+            else
+            {
+                Replay_EndPlayback(&Replay);
+                if (PlaybackPath)
+                {
+                    break;
+                }
+            }
         }
 
-        GameUpdateAndRender(GameInput, &GameMemory, &ShouldQuit);
+        UpdateAndRender(FrameInput, &GameMemory, &ShouldQuit);
 
+        FrameStats_Mark(FrameStats, FrameStage_Swap, SDL_GetPerformanceCounter());
         SDL_GL_SwapWindow(Window);
+        FramePacing_EndFrame(&FramePacing);
 
-        u64 CurrentCounter = SDL_GetPerformanceCounter();
-        u64 CounterElapsed = CurrentCounter - LastCounter;
-        LastCounter = CurrentCounter;
-        PrevFrameDeltaTimeSec = (f64) CounterElapsed / (f64) PerfCounterFrequency;
-        FPS = 1.0 / PrevFrameDeltaTimeSec;
+        u64 FrameEndCounter = SDL_GetPerformanceCounter();
+        FrameStats_EndFrame(FrameStats, FrameEndCounter);
 
-        char Title[256];
-        sprintf_s(Title, "Opus One [%0.3fFPS|%0.3fms]", FPS, PrevFrameDeltaTimeSec * 1000.0f);
-        SDL_SetWindowTitle(Window, Title);
+        if ((FrameEndCounter - LastTitleUpdateCounter) >= TitleUpdateInterval)
+        {
+            LastTitleUpdateCounter = FrameEndCounter;
+
+            f32 SortScratch[FRAME_STATS_COUNT];
+            frame_stats_summary Summary = FrameStats_Summarize(FrameStats, SortScratch);
+            
+            char Title[256];
+            FormatString(Title, sizeof(Title), "Opus One [p50 %0.2fms|p99 %0.2fms|max %0.2fms|%u hitches|%s]",
+                         Summary.P50Ms, Summary.P99Ms, Summary.MaxMs, Summary.HitchCount,
+                         FramePacing_GetModeName(FramePacing.Mode));
+            SDL_SetWindowTitle(Window, Title);
+        }
     }
 
-    SDL_Quit();
-    return 0;
-}
-
-internal void
-UpdateInput(game_input *GameInput)
-{
-    const u8 *SDLKeyboardState = SDL_GetKeyboardState(0);
-    for (u32 ScancodeIndex = 0;
-         ScancodeIndex < SDL_NUM_SCANCODES;
-         ++ScancodeIndex)
+    if (Replay.Mode == ReplayMode_Recording)
     {
-        GameInput->PreviousKeyStates_[ScancodeIndex] = GameInput->CurrentKeyStates_[ScancodeIndex];
-        GameInput->CurrentKeyStates_[ScancodeIndex] = (SDLKeyboardState[ScancodeIndex] != 0);
+        Replay_EndRecording(&Replay);
     }
-    
-    u32 SDLMouseButtonState = SDL_GetMouseState(&GameInput->MouseX, &GameInput->MouseY);
-    for (u32 MouseButtonIndex = 0;
-         MouseButtonIndex < MouseButton_Count;
-         ++MouseButtonIndex)
+
+    Snapshot_Release(GameMemory.JobSystem, &QuickSave);
+    for (u32 SnapshotIndex = 0;
+         SnapshotIndex < REWIND_SNAPSHOT_COUNT;
+         ++SnapshotIndex)
     {
-        GameInput->PreviousMouseButtonStates_[MouseButtonIndex] = GameInput->CurrentMouseButtonStates_[MouseButtonIndex];
-        GameInput->CurrentMouseButtonStates_[MouseButtonIndex] = (SDLMouseButtonState & SDL_BUTTON(MouseButtonIndex + 1));
+        Snapshot_Release(GameMemory.JobSystem, RewindSnapshots + SnapshotIndex);
     }
 
-    SDL_GetRelativeMouseState(&GameInput->MouseDeltaX, &GameInput->MouseDeltaY);
-}
+    if (WriteFrameStatsCSV("frame_stats.csv", FrameStats))
+    {
+        printf("PLATFORM: Wrote the last %u frame timings to frame_stats.csv\n", FrameStats_GetSampleCount(FrameStats));
+    }
 
-void
-Platform_SetRelativeMouse(b32 Enabled)
-{
-    i32 SDLResult = SDL_SetRelativeMouseMode((SDL_bool) Enabled);
-    Assert(SDLResult == 0);
+    JobSystem_Destroy(GameMemory.JobSystem);
+    
+    SDL_Quit();
+    return 0;
 }
 
-char *
-Platform_ReadFile(const char *FilePath)
+internal input_clock
+InputClock()
 {
-    FILE *File;
-    fopen_s(&File, FilePath, "rb");
-    // TODO: Handle errors opening files properly
-    Assert(File);
-    
-    fseek(File, 0, SEEK_END);
-    size_t FileSize = ftell(File);
-    Assert(FileSize > 0);
-    fseek(File, 0, SEEK_SET);
+    input_clock Result = {};
 
-    char *Result = (char *) malloc(FileSize + 1);
-    Assert(Result);
-    size_t ElementsRead = fread(Result, FileSize, 1, File);
-    Assert(ElementsRead == 1);
-    Result[FileSize] = '\0';
-
-    fclose(File);
+    Result.Frequency = SDL_GetPerformanceFrequency();
+    Result.StartTicks = SDL_GetTicks();
+    Result.StartCounter = SDL_GetPerformanceCounter();
 
     return Result;
 }
 
-void
-Platform_Free(void *Memory)
+internal f64
+InputClock_GetTime(input_clock *Clock, u64 Counter)
 {
-    free(Memory);
+    f64 Result = (f64) (Counter - Clock->StartCounter) / (f64) Clock->Frequency;
+    return Result;
 }
 
-platform_image
-Platform_LoadImage(const char *ImagePath)
+// NOTE: SDL event timestamps are SDL_GetTicks milliseconds, they're moved onto the counter clock through the tick
+// count sampled along with the start counter (both run off the same monotonic clock, they don't drift apart).
+// Events polled this frame happened after the previous one's FrameTime, so they're kept from landing before it
+// (tick rounding would otherwise put them in a sim step that already ran).
+internal f64
+GetInputEventTime(input_clock *Clock, game_input *GameInput, u32 Ticks)
 {
-    // TODO: JPG and PNG only for now, BMPs have to be handled separately
-    SDL_Surface *ImageSurface = IMG_Load(ImagePath);
-    // TODO: Handle errors opening images properly
-    Assert(ImageSurface);
-
-    platform_image Result = {};
-
-    Result.Width = (u32) ImageSurface->w;
-    Result.Height = (u32) ImageSurface->h;
-    Result.Pitch = (u32) ImageSurface->pitch;
-    Result.BytesPerPixel = (u32) ImageSurface->format->BytesPerPixel;
-    Result.ImageData = (u8 *) ImageSurface->pixels;
-    Result.PointerToFree_ = (void *) ImageSurface;
+    f64 Result = (f64) (i32) (Ticks - Clock->StartTicks) / 1000.0;
+    Result = Max(Result, GameInput->FrameTime);
+    return Result;
+}
 
+internal u32
+FramePacing_GetFramesInFlight(frame_pacing_mode Mode)
+{
+    u32 Result = (Mode == FramePacing_Latency) ? 1 : FRAME_PACING_MAX_IN_FLIGHT;
     return Result;
 }
 
-void
-Platform_FreeImage(platform_image *PlatformImage)
+internal const char *
+FramePacing_GetModeName(frame_pacing_mode Mode)
 {
-    SDL_FreeSurface((SDL_Surface *) PlatformImage->PointerToFree_);
-    PlatformImage->ImageData = 0;
-    PlatformImage->PointerToFree_ = 0;
+    const char *Result = (Mode == FramePacing_Latency) ? "Latency" : "Throughput";
+    return Result;
 }
 
-platform_font
-Platform_LoadFont(const char *FontPath, u32 PointSize)
+internal void
+FramePacing_WaitForFrameSlot(frame_pacing *Pacing)
 {
-    platform_font Result = {};
-    TTF_Font *Font = TTF_OpenFont(FontPath, PointSize);
-    Assert(Font);
+    u32 FramesInFlight = FramePacing_GetFramesInFlight(Pacing->Mode);
+    if (Pacing->FrameIndex < FramesInFlight)
+    {
+        return;
+    }
 
-    Result.Font_ = (void *) Font;
-    Result.Height = TTF_FontHeight(Font);
-    Result.PointSize = PointSize;
-    
-    return Result;
+    u32 SlotIndex = (u32) ((Pacing->FrameIndex - FramesInFlight) % FRAME_PACING_MAX_IN_FLIGHT);
+    GLsync Fence = Pacing->Fences[SlotIndex];
+    if (!Fence)
+    {
+        return;
+    }
+
+    // NOTE: The flush bit makes sure the fence actually gets to the GPU, or this could wait forever
+    for (;;)
+    {
+        GLenum WaitResult = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // NOTE: 1s in ns
+        if (WaitResult == GL_ALREADY_SIGNALED || WaitResult == GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        if (WaitResult == GL_WAIT_FAILED)
+        {
+            printf("PLATFORM: glClientWaitSync failed\n");
+            break;
+        }
+    }
 }
 
-void
-Platform_CloseFont(platform_font *PlatformFont)
+internal void
+FramePacing_EndFrame(frame_pacing *Pacing)
 {
-    TTF_CloseFont((TTF_Font  *) PlatformFont->Font_);
-    PlatformFont->Font_ = 0;
+    // NOTE: The slot holds the fence of FRAME_PACING_MAX_IN_FLIGHT frames ago, which has been waited on
+    // (or is older than the one that was)
+    u32 SlotIndex = (u32) (Pacing->FrameIndex % FRAME_PACING_MAX_IN_FLIGHT);
+    if (Pacing->Fences[SlotIndex])
+    {
+        glDeleteSync(Pacing->Fences[SlotIndex]);
+    }
+    Pacing->Fences[SlotIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    Pacing->FrameIndex++;
 }
 
 void
-Platform_GetGlyphMetrics(platform_font *PlatformFont, char Glyph,
-                        i32 *Out_MinX, i32 *Out_MaxX, i32 *Out_MinY, i32 *Out_MaxY, i32 *Out_Advance)
+Platform_SetRelativeMouse(b32 Enabled)
 {
-    Assert(PlatformFont);
-    Assert(PlatformFont->Font_);
-    Assert(Out_MinX);
-    Assert(Out_MaxX);
-    Assert(Out_MinY);
-    Assert(Out_MaxY);
-    Assert(Out_Advance);
-   
-    TTF_GlyphMetrics((TTF_Font *) PlatformFont->Font_, Glyph, Out_MinX, Out_MaxX, Out_MinY, Out_MaxY, Out_Advance);
+    i32 SDLResult = SDL_SetRelativeMouseMode((SDL_bool) Enabled);
+    Assert(SDLResult == 0);
 }
 
-platform_image
-Platform_RenderGlyph(platform_font *PlatformFont, char Glyph)
+internal void
+TakeTimedSnapshot(platform_job_system *JobSystem, platform_snapshot *Out_Snapshot, platform_snapshot *Parent,
+                  const char *What)
 {
-    Assert(PlatformFont);
-    Assert(PlatformFont->Font_);
-    TTF_Font *TTFFont = (TTF_Font *) PlatformFont->Font_;
-    
-    SDL_Surface *GlyphSurface = TTF_RenderGlyph_Blended(TTFFont, Glyph, SDL_Color { 255, 255, 255, 255 });
-
-    // TODO: Handle errors opening images properly
-    Assert(GlyphSurface);
-
-    platform_image Result {};
-
-    Result.Width = (u32) GlyphSurface->w;
-    Result.Height = (u32) GlyphSurface->h;
-    Result.Pitch = (u32) GlyphSurface->pitch;
-    Result.BytesPerPixel = (u32) GlyphSurface->format->BytesPerPixel;
-    Result.ImageData = (u8 *) GlyphSurface->pixels;
-    Result.PointerToFree_ = (void *) GlyphSurface;
+    u64 StartCounter = SDL_GetPerformanceCounter();
+    Snapshot_Take(JobSystem, Out_Snapshot, Parent);
+    f64 Ms = (f64) (SDL_GetPerformanceCounter() - StartCounter) * 1000.0 / (f64) SDL_GetPerformanceFrequency();
 
-    return Result;
+    printf("PLATFORM: %s took %0.2fms (%u pages, %u copied)\n", What, Ms, Out_Snapshot->PageCount,
+           Out_Snapshot->NewPageCount);
 }
 
-void
-Platform_SaveImageToDisk(const char *Path, platform_image *PlatformImage, u32 RMask, u32 GMask, u32 BMask, u32 AMask)
+internal void
+RestoreTimedSnapshot(platform_job_system *JobSystem, platform_snapshot *Snapshot, const char *What)
 {
-    SDL_Surface *Surface = SDL_CreateRGBSurfaceFrom((void *) PlatformImage->ImageData,
-                                                    PlatformImage->Width,
-                                                    PlatformImage->Height,
-                                                    PlatformImage->BytesPerPixel * 8,
-                                                    PlatformImage->Pitch,
-                                                    RMask, GMask, BMask, AMask);
-
-    i32 Result = SDL_SaveBMP(Surface, Path);
-    Assert(Result == 0);
-    
-    SDL_FreeSurface(Surface);
+    u64 StartCounter = SDL_GetPerformanceCounter();
+    Snapshot_Restore(JobSystem, Snapshot);
+    f64 Ms = (f64) (SDL_GetPerformanceCounter() - StartCounter) * 1000.0 / (f64) SDL_GetPerformanceFrequency();
+
+    printf("PLATFORM: %s took %0.2fms (%u pages)\n", What, Ms, Snapshot->PageCount);
 }